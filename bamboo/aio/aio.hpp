@@ -12,7 +12,7 @@ namespace aio {
  */
 class Aio : public AioIf {
  public:
-  Aio();
+  explicit Aio(const Topology& topology = Topology());
   virtual ~Aio();
 
   std::size_t GetIoSize() override;
@@ -1,11 +1,16 @@
 #pragma once
 
+#include <chrono>
 #include <memory>
 #include <vector>
 
 #include <boost/asio/signal_set.hpp>
+#include <boost/asio/steady_timer.hpp>
 
 #include <bamboo/define.hpp>
+#include <bamboo/aio/ioload.hpp>
+#include <bamboo/aio/mailbox.hpp>
+#include <bamboo/aio/topology.hpp>
 #include <bamboo/server/serverif.hpp>
 #include <bamboo/distributed/registry.hpp>
 
@@ -29,7 +34,9 @@ class AioIf {
    *
    * @brief aio会为每个服务分配一个io。
    *        单线程模式下，每个服务处于同一个io
-   *        多线程模式下，会有多个io，每个服务仅存在一个io上
+   *        多线程模式下，会有多个io，每个服务仅存在一个io上，分配给负载最小的io
+   *
+   * @see bamboo::aio::IoLoad
    *
    * @tparam SERVER 服务类，必须派生于 bamboo::server::ServerIf
    * @tparam ARGS 参数类型
@@ -49,10 +56,13 @@ class AioIf {
        * @note  AioIf is friend class of ServerIf, so can not use std::make_shared
        */
       ptr.reset(new SERVER(allocateio.first, name, allocateio.second, std::forward<ARGS>(args)...));
+      ptr->SetSchedulerEngine(topology_.schedulerEngine);
+      ptr->SetExecutor(CreateExecutor(allocateio.first));
     } catch (std::exception& e) {
       BB_ERROR_LOG("create server[%s] fail:%s", name.c_str(), e.what());
       return {};
     }
+    IoLoad::Of(allocateio.first).AddServer(1);
     servers_.push_back(std::dynamic_pointer_cast<bamboo::server::ServerIf>(ptr));
     return std::make_pair(ptr, allocateio.second);
   }
@@ -75,10 +85,13 @@ class AioIf {
        * @note  AioIf is friend class of ServerIf, so can not use std::make_shared
        */
       ptr.reset(new SERVER(allocateio, name, ioIndex, std::forward<ARGS>(args)...));
+      ptr->SetSchedulerEngine(topology_.schedulerEngine);
+      ptr->SetExecutor(CreateExecutor(allocateio));
     } catch (std::exception& e) {
       BB_ERROR_LOG("create server[%s] fail:%s", name.c_str(), e.what());
       return {};
     }
+    IoLoad::Of(allocateio).AddServer(1);
     servers_.push_back(std::dynamic_pointer_cast<bamboo::server::ServerIf>(ptr));
     return std::make_pair(ptr, ioIndex);
   }
@@ -95,6 +108,26 @@ class AioIf {
     }
   }
 
+  /**
+   * 在每个io上各创建一个服务
+   *
+   * @brief 配合 bamboo::net::ShardedAcceptor 使用时，每个服务监听同一个端口，
+   *        由内核把新链接分散到所有io上，一个端口就可以用上所有的核心
+   *
+   * @see CreateServerWithIndex
+   * @return 按io索引排列的服务列表
+   */
+  template<typename SERVER, typename... ARGS>
+  std::vector<std::shared_ptr<SERVER>> CreateShardedServer(std::string name, ARGS&& ... args) {
+    std::vector<std::shared_ptr<SERVER>> shards;
+    shards.reserve(GetIoSize());
+    for (std::size_t i = 0; i < GetIoSize(); ++i) {
+      auto ptr = CreateServerWithIndex<SERVER>(i, name, args...).first;
+      if (ptr) shards.push_back(ptr);
+    }
+    return shards;
+  }
+
   /**
    * 遍历所有服务，执行处理函数
    * @param handler 处理函数
@@ -127,12 +160,103 @@ class AioIf {
   /// 返回服务发现对象
   virtual std::shared_ptr<bamboo::distributed::Registry> GetRegistry() final;
 
+  /**
+   * 在指定的io上执行函数
+   *
+   * @brief 经过io之间的邮箱投递，不经过 io_context 内部的锁，一批消息只唤醒目标io一次。
+   *        同一个发送线程发往同一个io的消息按顺序执行
+   * @param ioIndex io索引
+   * @param handler 执行函数
+   * @return io索引无效或者邮箱已满时返回 false
+   */
+  virtual bool Post(std::size_t ioIndex, std::function<void()>&& handler) final;
+
+  /**
+   * 给服务发送消息，消息在服务所在的io上交给 SERVER::OnMessage 处理
+   *
+   * @tparam SERVER 服务类，需要有 OnMessage(MESSAGE) 接口
+   * @tparam MESSAGE 消息类型，需要可以复制。消息和目标服务的弱引用一起不超过
+   *                 bamboo::aio::Mailbox::Task::INLINE_SIZE 时投递过程不申请内存
+   * @param server 目标服务，处理前已经析构时丢弃消息
+   * @param message 消息
+   * @return 是否投递成功
+   */
+  template<typename SERVER, typename MESSAGE>
+  bool Send(const std::shared_ptr<SERVER>& server, MESSAGE&& message) {
+    static_assert(std::is_base_of<bamboo::server::ServerIf, SERVER>::value,
+                  "server must be base of bamboo::server::ServerIf");
+    if (!server || !mailbox_) return false;
+
+    std::weak_ptr<SERVER> weak = server;
+    typename std::decay<MESSAGE>::type data(std::forward<MESSAGE>(message));
+    return mailbox_->Post(server->GetIoIndex(), [weak, data]() mutable {
+      auto target = weak.lock();
+      if (!target) return;
+      if (!target->GetExecutor().HasStrand()) {
+        target->OnMessage(std::move(data));
+        return;
+      }
+      // 共享模式下邮箱回调和服务不在同一个 strand 上，转到服务的 strand 执行
+      boost::asio::dispatch(target->GetExecutor(), [target, data]() mutable {
+        target->OnMessage(std::move(data));
+      });
+    });
+  }
+
+  /**
+   * 把链接迁移到另一个io上的链接管理类
+   *
+   * @brief 在当前io上交出文件描述符和未处理的数据，经过邮箱在目标io上重新创建socket，
+   *        交给目标链接管理类，新链接保留原来的分组。原链接按关闭处理。
+   *        服务本身持有定时器、监听端口和业务状态，不能整体迁移，
+   *        需要迁移服务时在目标io上创建新的服务，再把链接迁移过去
+   * @note 必须在链接所在的执行器上调用，发送队列不为空时不能迁移。
+   *       可以在读处理函数中调用，处理函数返回后才交出，只迁移处理函数没有消耗的数据；
+   *       处理函数返回前又发送了数据时迁移失败，回调参数为 nullptr，链接留在原来的io上
+   * @param so 待迁移的链接
+   * @param ioIndex 目标io的索引
+   * @param target 目标链接管理类，必须属于目标io上的服务
+   * @param handler 迁移完成后在目标管理类的执行器上执行，参数为新的链接，失败时为 nullptr
+   * @return 是否开始迁移
+   */
+  virtual bool MoveSocket(const bamboo::net::SocketPtr& so, std::size_t ioIndex,
+                          const bamboo::net::ConnManagerPtr& target,
+                          std::function<void(bamboo::net::SocketPtr)>&& handler = nullptr) final;
+
+  /// 获取io的负载
+  virtual IoLoad& GetLoad(std::size_t index) final;
+
+  /**
+   * 负载最小的io
+   * @param first 参与比较的第一个io索引
+   * @param count 参与比较的io数量，0 为 first 之后所有的io
+   * @return io索引
+   */
+  virtual std::size_t LightestIo(std::size_t first = 0, std::size_t count = 0) final;
+
   /// 启动所有服务
   virtual void Start() final;
 
   /// 关闭所有服务
   virtual void Stop() final;
 
+  /**
+   * 分阶段关闭所有服务
+   *
+   * @brief 先停止服务发现的注册和所有服务的监听，已经建立的链接继续处理请求；
+   *        所有接入的链接都关闭或者超过 timeout 后，让所有链接发送完队列中的数据再关闭；
+   *        链接全部关闭或者再超过 flush 后调用 Stop 停止所有io。
+   *        可以在 SIGTERM 的处理函数中调用，滚动重启时客户端不会收到半截的回复
+   * @note 必须在主io上调用，重复调用会被忽略
+   * @param timeout 等待链接自然关闭的最长时间
+   * @param flush 发送剩余数据的最长时间
+   */
+  virtual void Drain(std::chrono::milliseconds timeout,
+                     std::chrono::milliseconds flush = std::chrono::milliseconds(1000)) final;
+
+  /// 是否正在排空
+  virtual bool IsDraining() const final { return drain_ != nullptr; }
+
   /// 获取io数量
   virtual std::size_t GetIoSize() = 0;
 
@@ -142,6 +266,9 @@ class AioIf {
   /// 获取主io
   virtual boost::asio::io_context& GetMasterIo() = 0;
 
+  /// io线程的布局，预留给工作线程的cpu从这里获取
+  virtual const Topology& GetTopology() const final { return topology_; }
+
  protected:
 
   /// 为服务分配io
@@ -153,8 +280,26 @@ class AioIf {
   /// io 暂停处理
   virtual void StopHandle() = 0;
 
+  /// 所有io创建后初始化邮箱
+  virtual void InitMailbox() final;
+
+  /// 为新服务创建执行器，默认直接在io上执行
+  virtual bamboo::concurrency::Executor CreateExecutor(boost::asio::io_context& io);
+
+  /// 排空状态检查的间隔
+  static const std::chrono::milliseconds DRAIN_INTERVAL;
+
+  struct DrainInfo;
+
+  /// 检查排空的进度，决定进入下一阶段还是继续等待
+  void DrainCheck();
+
   std::vector<bamboo::server::ServerPtr> servers_;
   std::shared_ptr<bamboo::distributed::Registry> registry_;
+  std::unique_ptr<Mailbox> mailbox_;
+  Topology topology_;
+  std::size_t rotate_{0}; /**< LightestIo 下一次开始比较的位置 */
+  std::shared_ptr<DrainInfo> drain_; /**< 排空的状态，没有排空时为空 */
 
   struct SignalInfo {
     boost::asio::signal_set signal;
@@ -0,0 +1,145 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/steady_timer.hpp>
+
+namespace bamboo {
+namespace aio {
+
+/**
+ * io的负载
+ *
+ * @brief 作为 io_context 的服务存在，每个io一份，随io一起销毁。
+ *        记录io上的服务数、链接数，以及探测定时器的延迟。
+ *        探测定时器每隔 PROBE_INTERVAL 触发一次，实际触发时间比预期晚的部分就是延迟，
+ *        io上排队的回调越多、回调执行越久，延迟越大。
+ *        经过 bamboo::concurrency::Executor 执行的回调会记录次数、耗时分布、排队数量，
+ *        超过慢回调阈值的按回调类型记录，回调类型带有定义它的函数名，可以定位到调用位置。
+ *        计时使用 TSC，每个回调只多两次读计数和几次原子加，可以在生产环境中常开
+ */
+class IoLoad final : public boost::asio::execution_context::service {
+ public:
+  /// 探测间隔
+  static const std::chrono::milliseconds PROBE_INTERVAL;
+
+  /// 估算负载时每个服务折算的延迟微秒数
+  static const uint64_t SERVER_COST = 1000;
+
+  /// 估算负载时每个链接折算的延迟微秒数
+  static const uint64_t CONNECTION_COST = 10;
+
+  /// 耗时分布的桶数，第0个桶为1微秒以内，第i个桶为 [2^(i-1), 2^i) 微秒，最后一个桶包含更长的
+  static const std::size_t BUCKETS = 20;
+
+  /// 最多记录的慢回调类型数
+  static const std::size_t MAX_SLOW_SITES = 64;
+
+  /// 慢回调的统计
+  struct SlowSite {
+    std::string site;   /**< 回调类型 */
+    uint64_t count{0};  /**< 次数 */
+    uint64_t total{0};  /**< 总耗时，纳秒 */
+    uint64_t max{0};    /**< 最大耗时，纳秒 */
+  };
+
+  /// 统计数据
+  struct Stats {
+    int64_t servers{0};
+    int64_t connections{0};
+    uint64_t lag{0};         /**< 探测延迟的滑动平均值，微秒 */
+    uint64_t maxLag{0};      /**< 最大探测延迟，微秒 */
+    uint64_t handlers{0};    /**< 执行的回调数 */
+    uint64_t handlerTime{0}; /**< 回调的总耗时，纳秒 */
+    int64_t queued{0};       /**< 已经提交还没开始执行的回调数 */
+    std::array<uint64_t, BUCKETS> histogram{{}}; /**< 回调耗时分布 */
+    std::vector<SlowSite> slow;              /**< 按最大耗时排序的慢回调 */
+  };
+
+  static boost::asio::execution_context::id id;
+
+  explicit IoLoad(boost::asio::execution_context& context);
+
+  /// 获取io的负载
+  static IoLoad& Of(boost::asio::io_context& io);
+
+  /// 开始探测，重复调用无效
+  void StartProbe(boost::asio::io_context& io);
+
+  /// 服务数
+  int64_t Servers() const { return servers_.load(std::memory_order_relaxed); }
+
+  /// 链接数
+  int64_t Connections() const { return connections_.load(std::memory_order_relaxed); }
+
+  /// 探测定时器延迟的滑动平均值，单位微秒
+  uint64_t Lag() const { return lag_.load(std::memory_order_relaxed); }
+
+  /// 负载估算值，延迟加上服务和链接折算的延迟，越小越空闲
+  uint64_t Score() const;
+
+  void AddServer(int64_t count) { servers_.fetch_add(count, std::memory_order_relaxed); }
+  void AddConnection(int64_t count) { connections_.fetch_add(count, std::memory_order_relaxed); }
+
+  /// 提交了一个回调
+  void Submit() { queued_.fetch_add(1, std::memory_order_relaxed); }
+
+  /// 回调开始执行
+  void Start() { queued_.fetch_sub(1, std::memory_order_relaxed); }
+
+  /**
+   * 记录一次回调的耗时
+   * @param ticks 耗时的 TSC 计数
+   * @param site 回调类型名，必须是 typeid().name() 这类静态存在的字符串
+   */
+  void Record(uint64_t ticks, const char* site);
+
+  /// 设置慢回调的阈值，单位微秒，默认10毫秒
+  void SetSlowThreshold(uint64_t microseconds);
+
+  /**
+   * 获取统计数据
+   * @param top 返回最慢的回调数量
+   */
+  Stats GetStats(std::size_t top = 10) const;
+
+  /// 清空回调统计和最大延迟
+  void ResetStats();
+
+ private:
+  void shutdown() override;
+  void Probe();
+
+  std::atomic<int64_t> servers_{0};
+  std::atomic<int64_t> connections_{0};
+  std::atomic<uint64_t> lag_{0};
+  std::atomic<uint64_t> maxLag_{0};
+  std::unique_ptr<boost::asio::steady_timer> timer_;
+  std::chrono::steady_clock::time_point expected_;
+
+  std::atomic<uint64_t> handlers_{0};
+  std::atomic<uint64_t> handlerTime_{0};
+  std::atomic<int64_t> queued_{0};
+  std::array<std::atomic<uint64_t>, BUCKETS> histogram_;
+  std::atomic<uint64_t> slowThreshold_{10 * 1000 * 1000};
+
+  struct SlowInfo {
+    uint64_t count{0};
+    uint64_t total{0};
+    uint64_t max{0};
+  };
+  /// 只有慢回调才会加锁
+  mutable std::mutex slowMutex_;
+  std::map<const char*, SlowInfo> slow_;
+};
+
+}
+}
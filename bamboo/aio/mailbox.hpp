@@ -0,0 +1,186 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/io_context_strand.hpp>
+#include <boost/asio/posix/stream_descriptor.hpp>
+
+#include <bamboo/concurrency/channel.hpp>
+#include <bamboo/concurrency/spscqueue.hpp>
+
+namespace bamboo {
+namespace aio {
+
+/**
+ * io之间的邮箱
+ *
+ * @brief 每一对io之间有一个单生产者单消费者队列，第一次发送时才创建。
+ *        非io线程发送的消息放到目标io的多生产者队列里。
+ *        每个io有一个 eventfd，一批消息只写一次 eventfd 唤醒目标io，目标io一次取完所有队列。
+ *        发送和接收都不会经过 io_context 内部的锁
+ */
+class Mailbox final {
+ public:
+  /**
+   * 消息处理函数
+   *
+   * @brief 只能移动的函数对象，不超过 INLINE_SIZE 的函数对象直接存放在内部，不申请内存
+   */
+  class Task final {
+   public:
+    static const std::size_t INLINE_SIZE = 48;
+
+    Task() {}
+
+    template <typename FUNCTION,
+              typename = typename std::enable_if<!std::is_same<typename std::decay<FUNCTION>::type, Task>::value>::type>
+    Task(FUNCTION&& function) {
+      using Type = typename std::decay<FUNCTION>::type;
+      Init<Type>(std::forward<FUNCTION>(function),
+                 std::integral_constant<bool, sizeof(Type) <= INLINE_SIZE && alignof(Type) <= alignof(Storage)>());
+    }
+
+    Task(Task&& other) { MoveFrom(other); }
+
+    Task& operator=(Task&& other) {
+      if (this != &other) {
+        Reset();
+        MoveFrom(other);
+      }
+      return *this;
+    }
+
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+
+    ~Task() { Reset(); }
+
+    void operator()() { ops_->invoke(&storage_); }
+
+    explicit operator bool() const { return ops_ != nullptr; }
+
+   private:
+    using Storage = typename std::aligned_storage<INLINE_SIZE, alignof(std::max_align_t)>::type;
+
+    struct Ops {
+      void (*invoke)(Storage*);
+      void (*move)(Storage* from, Storage* to);
+      void (*destroy)(Storage*);
+    };
+
+    template <typename TYPE>
+    static const Ops* InlineOps() {
+      static const Ops ops{
+          [](Storage* s) { (*reinterpret_cast<TYPE*>(s))(); },
+          [](Storage* from, Storage* to) {
+            new (to) TYPE(std::move(*reinterpret_cast<TYPE*>(from)));
+            reinterpret_cast<TYPE*>(from)->~TYPE();
+          },
+          [](Storage* s) { reinterpret_cast<TYPE*>(s)->~TYPE(); }};
+      return &ops;
+    }
+
+    template <typename TYPE>
+    static const Ops* HeapOps() {
+      static const Ops ops{
+          [](Storage* s) { (**reinterpret_cast<TYPE**>(s))(); },
+          [](Storage* from, Storage* to) { *reinterpret_cast<TYPE**>(to) = *reinterpret_cast<TYPE**>(from); },
+          [](Storage* s) { delete *reinterpret_cast<TYPE**>(s); }};
+      return &ops;
+    }
+
+    template <typename TYPE, typename FUNCTION>
+    void Init(FUNCTION&& function, std::true_type) {
+      new (&storage_) TYPE(std::forward<FUNCTION>(function));
+      ops_ = InlineOps<TYPE>();
+    }
+
+    template <typename TYPE, typename FUNCTION>
+    void Init(FUNCTION&& function, std::false_type) {
+      *reinterpret_cast<TYPE**>(&storage_) = new TYPE(std::forward<FUNCTION>(function));
+      ops_ = HeapOps<TYPE>();
+    }
+
+    void MoveFrom(Task& other) {
+      ops_ = other.ops_;
+      if (ops_) ops_->move(&other.storage_, &storage_);
+      other.ops_ = nullptr;
+    }
+
+    void Reset() {
+      if (ops_) ops_->destroy(&storage_);
+      ops_ = nullptr;
+    }
+
+    Storage storage_;
+    const Ops* ops_{nullptr};
+  };
+
+  /// 非io线程的索引
+  static const std::size_t NPOS = static_cast<std::size_t>(-1);
+
+  /**
+   * 构造函数
+   * @param ios 按索引排列的io
+   * @param capacity 每个队列的容量
+   */
+  Mailbox(std::vector<boost::asio::io_context*> ios, std::size_t capacity = 1024);
+  ~Mailbox();
+
+  Mailbox(const Mailbox&) = delete;
+  Mailbox& operator=(const Mailbox&) = delete;
+
+  /**
+   * 发送消息，消息会在目标io上执行
+   * @param to 目标io的索引
+   * @param task 消息处理函数
+   * @return 目标io的索引无效或者队列满时返回 false
+   */
+  bool Post(std::size_t to, Task&& task);
+
+  /// 停止接收消息，未处理的消息会被丢弃
+  void Stop();
+
+  /**
+   * 标记当前线程运行的io，由io线程在运行前调用
+   * @param index io索引
+   */
+  void Bind(std::size_t index);
+
+  /// 当前线程运行的io索引，不是这个邮箱的io线程时返回 NPOS
+  std::size_t Current() const;
+
+ private:
+  using Queue = bamboo::concurrency::SpscQueue<Task>;
+
+  struct Box {
+    Box(boost::asio::io_context& io, std::size_t ios, std::size_t capacity);
+
+    boost::asio::posix::stream_descriptor event;
+    boost::asio::io_context::strand strand;      /**< 多个线程运行同一个io时，保证只有一个线程在取消息 */
+    std::array<char, 8> buffer;
+    std::atomic<bool> scheduled{false};
+    std::unique_ptr<std::atomic<Queue*>[]> from; /**< 来自每个io的队列 */
+    bamboo::concurrency::Channel<Task> shared;   /**< 来自非io线程的队列 */
+  };
+
+  void DoRead(std::size_t index);
+  void Wake(std::size_t index);
+  /// 取出目标io的所有消息，返回是否还有剩余
+  bool Drain(std::size_t index);
+
+  std::vector<std::unique_ptr<Box>> boxes_;
+  std::size_t capacity_;
+  std::atomic<bool> running_{true};
+};
+
+}
+}
@@ -11,14 +11,16 @@ namespace aio {
 /**
  * 多线程模式Aio
  *
- * @brief 基于CPU核心数量创建线程，并且分配同等数量的io。
- *        极端情况下，CPU核心数量为1时，退化成单线程模式
+ * @brief 默认基于CPU核心数量创建线程，并且分配同等数量的io，至少为2个。
+ *        可以通过 bamboo::aio::Topology 指定io数量和每个io线程绑定的cpu，
+ *        主io运行在调用 Start 的线程上，同样按配置绑定
+ *        新服务分配到负载最小的io上，负载相同时轮流分配
  *
  * @see bamboo::aio::AioIf
  */
 class MultiAio : public AioIf {
  public:
-  MultiAio();
+  explicit MultiAio(const Topology& topology = Topology());
   virtual ~MultiAio();
 
   std::size_t GetIoSize() override;
@@ -35,7 +37,6 @@ class MultiAio : public AioIf {
   using guard_t = boost::asio::executor_work_guard<boost::asio::io_context::executor_type>;
   std::vector<std::unique_ptr<guard_t>> guards_;
   std::vector<std::thread> threads_;
-  std::size_t index_{0};
 };
 
 }
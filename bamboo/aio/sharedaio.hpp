@@ -0,0 +1,52 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include <bamboo/aio/aioif.hpp>
+
+namespace bamboo {
+namespace aio {
+
+/**
+ * 共享模式Aio
+ *
+ * @brief 少量的io由一组线程共同运行，每个io上有多个线程，
+ *        一个服务上的流量过大时，同一个io的其他线程可以分担，适合服务之间负载不均衡的场景。
+ *        每个服务有独占的 strand，服务的回调仍然串行执行，和单线程语义相同。
+ *        默认线程数为cpu核数，io数为线程数的1/4，至少为1个；
+ *        另有一个只由调用 Start 的线程运行的主io，服务发现、信号和全局调度器都在主io上
+ *
+ * @note 同一个服务的回调串行，不同服务的回调可能并发，跨服务访问需要使用 AioIf::Send
+ *
+ * @see bamboo::aio::AioIf
+ */
+class SharedAio : public AioIf {
+ public:
+  explicit SharedAio(const Topology& topology = Topology());
+  virtual ~SharedAio();
+
+  std::size_t GetIoSize() override;
+  boost::asio::io_context& GetIo(std::size_t index) override;
+  boost::asio::io_context& GetMasterIo() override;
+
+  /// 运行共享io的线程数
+  std::size_t GetThreadSize() const;
+
+ protected:
+  std::pair<boost::asio::io_context&, std::size_t> AllocateIo() override;
+  void IoRun() override;
+  void StopHandle() override;
+  bamboo::concurrency::Executor CreateExecutor(boost::asio::io_context& io) override;
+
+ private:
+  /// 最后一个是主io
+  std::vector<std::unique_ptr<boost::asio::io_context>> ios_;
+  using guard_t = boost::asio::executor_work_guard<boost::asio::io_context::executor_type>;
+  std::vector<std::unique_ptr<guard_t>> guards_;
+  std::vector<std::thread> threads_;
+  std::size_t threadSize_{0};
+};
+
+}
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <boost/asio/io_context.hpp>
+
+#include <bamboo/schedule/scheduler.hpp>
+
+namespace bamboo {
+namespace aio {
+
+/**
+ * io线程的布局
+ *
+ * @brief 决定io的数量、每个io线程绑定的cpu、给 TaskPool/AsyncRun 预留的cpu，
+ *        以及io线程是否在本地NUMA节点上预先准备缓冲区，服务和全局调度器使用的实现。
+ *        默认值和没有配置时的行为相同：cpu核数个io，不绑定cpu
+ */
+struct Topology {
+  std::size_t ioSize{0};                /**< io数量，0 为cpu核数，多线程模式下至少为2；共享模式下为共享io的数量 */
+  std::size_t threadSize{0};            /**< 共享模式下运行共享io的线程数，0 为cpu核数 */
+  std::vector<std::vector<int>> ioCpus; /**< 按io索引排列的cpu集合，没有配置或者为空的io不绑定 */
+  std::vector<int> workerCpus;          /**< 预留给工作线程的cpu，传给 TaskPool/AsyncRun 使用 */
+  bool numaLocal{false};                /**< io线程绑定cpu后使用本地节点的内存策略，并预热缓冲池 */
+  std::size_t prefillBytes{0};          /**< numaLocal 时每个io线程预先申请的缓冲区字节数 */
+  std::vector<std::size_t> pollBudget;  /**< 按io索引排列的忙轮询微秒数，没有配置或者为0的io直接阻塞等待 */
+  bamboo::schedule::Scheduler::Engine schedulerEngine{bamboo::schedule::Scheduler::Engine::TIMER}; /**< 服务和 env 的调度器实现，大量超时时使用 WHEEL */
+
+  /**
+   * 每个io独占一个cpu，剩余的cpu预留给工作线程
+   * @param ioSize io数量，0 为进程允许使用的cpu数量
+   * @param first 第一个io绑定的cpu在允许使用的cpu列表里的序号
+   */
+  static Topology Pinned(std::size_t ioSize, int first = 0);
+
+  /**
+   * 解析配置
+   * @param ios 每个io的cpu列表，用 ';' 分隔，如 "0;1;2-3"，io数量为列表的数量
+   * @param workers 工作线程的cpu列表，如 "4-7"
+   */
+  static Topology Parse(const std::string& ios, const std::string& workers);
+
+  /// 在当前线程上应用第 index 个io的配置，由io线程在运行前调用
+  void Apply(std::size_t index) const;
+
+  /**
+   * 在当前线程上运行第 index 个io，直到io停止
+   *
+   * @brief 配置了忙轮询时，没有就绪的回调也不立即进入内核等待，
+   *        先在预算时间内反复 poll，预算用完仍然空闲才阻塞等待下一个回调。
+   *        省掉了线程睡眠和唤醒的开销，代价是空闲时占满一个cpu，适合绑定了cpu的低延迟io
+   */
+  void Run(boost::asio::io_context& io, std::size_t index) const;
+};
+
+}
+}
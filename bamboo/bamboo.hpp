@@ -7,18 +7,26 @@
 
 #include <bamboo/aio/aioif.hpp>
 #include <bamboo/aio/aio.hpp>
+#include <bamboo/aio/mailbox.hpp>
+#include <bamboo/aio/topology.hpp>
 
 #include <bamboo/net/acceptorif.hpp>
 #include <bamboo/net/connectorif.hpp>
 #include <bamboo/net/connmanagerif.hpp>
 #include <bamboo/net/simpleconnmanager.hpp>
 #include <bamboo/net/simpleacceptor.hpp>
+#include <bamboo/net/shardedacceptor.hpp>
 #include <bamboo/net/simpleconnector.hpp>
+#include <bamboo/net/connectionpool.hpp>
 #include <bamboo/net/socketif.hpp>
 #include <bamboo/net/socket.hpp>
 
 #include <bamboo/protocol/protocolif.hpp>
 #include <bamboo/protocol/echoprotocol.hpp>
+#include <bamboo/protocol/lengthfieldprotocol.hpp>
+#include <bamboo/protocol/rpcprotocol.hpp>
+#include <bamboo/protocol/httpprotocol.hpp>
+#include <bamboo/protocol/websocketprotocol.hpp>
 #include <bamboo/protocol/messageif.hpp>
 
 #include <bamboo/server/serverif.hpp>
@@ -26,13 +34,16 @@
 #include <bamboo/server/console.hpp>
 
 #include <bamboo/schedule/scheduler.hpp>
+#include <bamboo/schedule/timingwheel.hpp>
 
 #include <bamboo/concurrency/channel.hpp>
+#include <bamboo/concurrency/spscqueue.hpp>
 #include <bamboo/concurrency/taskpool.hpp>
 #include <bamboo/concurrency/asyncrun.hpp>
 
 #include <bamboo/utility/defer.hpp>
 #include <bamboo/utility/timemeasure.hpp>
 #include <bamboo/utility/singleton.hpp>
+#include <bamboo/utility/affinity.hpp>
 
 #include <bamboo/distributed/registry.hpp>
\ No newline at end of file
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
 
 namespace bamboo {
@@ -16,6 +17,19 @@ class BufferIf {
   virtual char* Data() = 0;
   virtual std::size_t Free() = 0;
   virtual void Skip(std::size_t size, SkipType type = SkipType::READ) = 0;
+
+  /// 可写区域的起始地址，长度为 Free()
+  virtual char* Tail() = 0;
+
+  /**
+   * 准备尾部的连续可写空间
+   *
+   * @brief 尾部空间不足 size 时，把未读数据移到缓冲区头部(可增长的缓冲区会扩容)，
+   *        只在空间不足时才移动数据，不会每次读写都产生拷贝
+   * @param size 需要的长度
+   * @return 准备后尾部连续可写的长度，即 Free()
+   */
+  virtual std::size_t Prepare(std::size_t size) = 0;
 };
 
 }
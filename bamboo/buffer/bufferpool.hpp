@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace bamboo {
+namespace buffer {
+
+/**
+ * 按大小分级的内存块缓冲池
+ *
+ * @brief 每个线程一个实例，io线程上的socket从所在线程的缓冲池申请和归还内存，不需要加锁。
+ *        内存块按 2 的幂分级，从 MIN_BLOCK 到 MAX_BLOCK，超出范围的直接从堆上申请。
+ *        同时提供一块线程共享的临时内存，用于空闲链接的读取
+ */
+class BufferPool final {
+ public:
+  /// 最小的内存块
+  static const std::size_t MIN_BLOCK = 1024;
+
+  /// 最大的可缓存内存块
+  static const std::size_t MAX_BLOCK = 1024 * 512;
+
+  /// 线程共享临时内存的大小
+  static const std::size_t SCRATCH_SIZE = 1024 * 64;
+
+  BufferPool();
+  ~BufferPool();
+
+  BufferPool(const BufferPool&) = delete;
+  BufferPool& operator=(const BufferPool&) = delete;
+
+  /// 获取当前线程的缓冲池
+  static BufferPool& Local();
+
+  /**
+   * 申请内存块
+   * @param size 需要的长度，返回时修改为实际内存块的长度
+   * @return 内存块
+   */
+  char* Allocate(std::size_t& size);
+
+  /**
+   * 归还内存块
+   * @param block 内存块
+   * @param size Allocate 返回的内存块长度
+   */
+  void Free(char* block, std::size_t size);
+
+  /**
+   * 线程共享的临时内存
+   *
+   * @note 只在当前的回调内有效，不能跨异步操作持有
+   */
+  char* Scratch();
+
+  /**
+   * 预先申请内存块放入缓存，并写入每一页
+   *
+   * @brief 在绑定了cpu的线程上调用时，按照首次访问分配的策略，内存页会落在当前线程所在的NUMA节点
+   * @param size 内存块长度
+   * @param bytes 预先申请的总字节数，受每一级的缓存上限限制
+   */
+  void Prefill(std::size_t size, std::size_t bytes);
+
+  /// 设置每一级最多缓存的字节数
+  void SetCacheLimit(std::size_t bytes);
+
+  /// 当前缓存着的字节数
+  std::size_t CachedBytes() const;
+
+ private:
+  static std::size_t ClassIndex(std::size_t size);
+
+  std::vector<std::vector<char*>> free_;
+  std::unique_ptr<char[]> scratch_;
+  std::size_t cacheLimit_{1024 * 1024};
+  std::size_t cached_{0};
+};
+
+}
+}
@@ -21,11 +21,12 @@ class DynamicBuffer : public BufferIf {
   char* Data() override;
   std::size_t Free() override;
   void Skip(std::size_t size, SkipType type = SkipType::READ) override;
+  std::size_t Prepare(std::size_t size) override;
+  char* Tail() override;
+  char* Head();
 
  private:
   void Grow(std::size_t need);
-  char* Head();
-  char* Tail();
   std::unique_ptr<char[]> buffer_;
   std::size_t head_{0};
   std::size_t tail_{0};
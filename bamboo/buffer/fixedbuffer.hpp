@@ -1,6 +1,7 @@
 #pragma once
 
 #include <array>
+#include <cstring>
 
 #include <bamboo/buffer/bufferif.hpp>
 
@@ -15,7 +16,7 @@ class FixedBuffer : public BufferIf {
 
   std::size_t Write(const char* data, std::size_t size) override {
     std::size_t write = size;
-    if (Free() < write) write = Free();
+    if (Prepare(write) < write) write = Free();
     if (write < 1) return 0;
 
     std::memcpy(Tail(), data, write);
@@ -61,11 +62,21 @@ class FixedBuffer : public BufferIf {
     }
   }
 
+  std::size_t Prepare(std::size_t size) override {
+    if (Free() < size && head_ > 0) {
+      std::size_t used = Size();
+      std::memmove(buffer_.data(), Head(), used);
+      head_ = 0;
+      tail_ = used;
+    }
+    return Free();
+  }
+
   char* Head() {
     return &(buffer_.data()[head_]);
   }
 
-  char* Tail() {
+  char* Tail() override {
     return &(buffer_.data()[tail_]);
   }
 
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <bamboo/buffer/bufferif.hpp>
+
+namespace bamboo {
+namespace buffer {
+
+/**
+ * 从 BufferPool 申请内存的动态缓冲区
+ *
+ * @brief 初始不占用内存，写入时按需从当前线程的缓冲池申请，
+ *        数据读空后立即把内存归还给缓冲池
+ */
+class PooledBuffer : public BufferIf {
+ public:
+  PooledBuffer();
+  virtual ~PooledBuffer();
+
+  PooledBuffer(const PooledBuffer&) = delete;
+  PooledBuffer& operator=(const PooledBuffer&) = delete;
+
+  std::size_t Write(const char* data, std::size_t size) override;
+  std::size_t Read(char* data, std::size_t size, bool skip = true) override;
+  std::size_t Size() override;
+  std::size_t Capacity() override;
+  char* Data() override;
+  std::size_t Free() override;
+  void Skip(std::size_t size, SkipType type = SkipType::READ) override;
+  std::size_t Prepare(std::size_t size) override;
+  char* Tail() override;
+
+  /// 归还内存给缓冲池，丢弃所有数据
+  void Release();
+
+  char* Head();
+
+ private:
+  char* buffer_{nullptr};
+  std::size_t head_{0};
+  std::size_t tail_{0};
+  std::size_t capacity_{0};
+};
+
+}
+}
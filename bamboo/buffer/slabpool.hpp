@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace bamboo {
+namespace buffer {
+
+/**
+ * 发送数据用的内存板缓冲池
+ *
+ * @brief 每个线程一个实例。消息直接编码到当前内存板的空闲位置，多条消息共用一块内存板，
+ *        发送队列通过共享指针持有整块内存板，全部发送完后内存板回到缓冲池重新使用。
+ *        稳定状态下编码和入队都不申请内存
+ *
+ * @note 一条还没发送完的消息会让整块内存板无法重用，发送很慢的链接会多占用一些内存板
+ */
+class SlabPool final {
+ public:
+  /// 内存板的大小
+  static const std::size_t SLAB_SIZE = 1024 * 64;
+
+  /// 可以放进内存板的最大消息，更大的消息单独申请内存
+  static const std::size_t MAX_MESSAGE = SLAB_SIZE / 4;
+
+  /// 每个线程最多保留的内存板数量
+  static const std::size_t MAX_SLABS = 64;
+
+  SlabPool();
+  ~SlabPool();
+
+  SlabPool(const SlabPool&) = delete;
+  SlabPool& operator=(const SlabPool&) = delete;
+
+  /// 获取当前线程的缓冲池
+  static SlabPool& Local();
+
+  /**
+   * 预留一段写入空间
+   * @param size 需要的长度
+   * @param holder 输出内存板的共享指针，在数据发送完之前必须持有
+   * @return 写入位置，消息太大或者内存板已经用完时返回 nullptr
+   */
+  char* Reserve(std::size_t size, std::shared_ptr<const void>& holder);
+
+  /// 当前保留的内存板数量
+  std::size_t SlabCount() const;
+
+ private:
+  struct Slab {
+    std::unique_ptr<char[]> data;
+    std::size_t used{0};
+  };
+
+  /// 找一块没有被发送队列持有的内存板，没有时新建
+  bool NextSlab();
+
+  std::vector<std::shared_ptr<Slab>> slabs_;
+  /// 当前写入的内存板
+  std::size_t current_{0};
+};
+
+}
+}
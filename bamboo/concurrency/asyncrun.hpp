@@ -1,82 +1,143 @@
 #pragma once
 
-#include <list>
-#include <future>
+#include <atomic>
+#include <chrono>
 #include <memory>
 #include <functional>
 
 #include <boost/asio/io_context.hpp>
-#include <boost/asio/local/stream_protocol.hpp>
+#include <boost/asio/post.hpp>
+
+#include <bamboo/log/log.hpp>
+#include <bamboo/concurrency/taskpool.hpp>
 
 namespace bamboo {
 namespace concurrency {
 
+/**
+ * 异步执行
+ *
+ * @brief 任务在固定数量的工作线程上执行，执行完成后把回调 post 回创建时的io执行。
+ *        可以限制排队中的任务数量，超过时 Run 直接返回 false
+ */
 class AsyncRun final {
  public:
-  AsyncRun(boost::asio::io_context& io);
+  /// 统计数据，时间单位为纳秒
+  struct Stats {
+    uint64_t submitted{0}; /**< 提交的任务数 */
+    uint64_t rejected{0};  /**< 因为队列满被拒绝的任务数 */
+    uint64_t completed{0}; /**< 回调执行完的任务数 */
+    uint64_t failed{0};    /**< 执行时抛出异常的任务数 */
+    uint64_t pending{0};   /**< 还未完成的任务数 */
+    uint64_t queueTime{0}; /**< 排队等待的总时间 */
+    uint64_t runTime{0};   /**< 执行的总时间 */
+    uint64_t totalTime{0}; /**< 从提交到回调执行完的总时间 */
+    uint64_t maxTotalTime{0}; /**< 从提交到回调执行完的最大时间 */
+  };
+
+  /**
+   * 构造函数
+   * @param io 执行回调的io
+   * @param threads 工作线程数量，0 为cpu核数
+   * @param maxPending 最多未完成的任务数，0 为不限制
+   * @param cpus 工作线程绑定的cpu集合，为空时不绑定
+   */
+  AsyncRun(boost::asio::io_context& io, std::size_t threads = 0, std::size_t maxPending = 0,
+           std::vector<int> cpus = std::vector<int>());
   ~AsyncRun();
 
+  /**
+   * 执行任务
+   * @param call 在工作线程上执行的任务
+   * @param cb 在io上执行的回调，参数为任务的返回值
+   * @return 队列已满时返回 false，任务和回调都不会执行
+   */
   template <typename RETURN>
-  void Run(std::function<RETURN()>&& call, std::function<void(RETURN)>&& cb) {
-    auto f = std::async(std::launch::async, std::move(call));
-    auto future = std::make_shared<std::future<RETURN>>(std::move(f));
-    auto callcb = std::make_shared<std::function<void(RETURN)>>(std::move(cb));
-
-    std::unique_ptr<AsyncInfo> info(new AsyncInfo);
-    info->checker = [future]() -> bool {
-      return future->wait_for(std::chrono::seconds(0)) == std::future_status::ready;
-    };
-
-    info->callback = [callcb, future]() {
-      (*callcb)(future->get());
-    };
+  bool Run(std::function<RETURN()>&& call, std::function<void(RETURN)>&& cb) {
+    if (!Acquire()) return false;
 
-    sendLock_.lock();
-    sendList_.push_back(std::move(info));
-    sendLock_.unlock();
+    auto state = state_;
+    auto callptr = std::make_shared<std::function<RETURN()>>(std::move(call));
+    auto callcb = std::make_shared<std::function<void(RETURN)>>(std::move(cb));
+    auto& io = io_;
+    auto submit = Clock::now();
+
+    pool_->Add([state, callptr, callcb, submit, &io]() {
+      auto begin = Clock::now();
+      std::shared_ptr<RETURN> result;
+      try {
+        result = std::make_shared<RETURN>((*callptr)());
+      } catch (std::exception& e) {
+        BB_ERROR_LOG("async run fail:%s", e.what());
+        state->Fail();
+        return;
+      } catch (...) {
+        BB_ERROR_LOG("async run fail: unknown exception");
+        state->Fail();
+        return;
+      }
+      auto end = Clock::now();
+
+      boost::asio::post(io, [state, callcb, result, submit, begin, end]() {
+        // 回调抛出异常时也要完成计数，否则 pending 一直占着队列位置
+        struct Finish {
+          State& state;
+          Clock::time_point submit, begin, end;
+          ~Finish() { state.Complete(submit, begin, end); }
+        } finish{*state, submit, begin, end};
+        (*callcb)(std::move(*result));
+      });
+    });
+    return true;
   };
 
   template <typename RETURN>
-  void Run(RETURN(*call)(), void(*cb)(RETURN)) {
-    Run(std::function<RETURN()>(call), std::function<void(RETURN)>(cb));
+  bool Run(RETURN(*call)(), void(*cb)(RETURN)) {
+    return Run(std::function<RETURN()>(call), std::function<void(RETURN)>(cb));
   }
 
   template <typename RETURN>
-  void Run(std::function<RETURN()>&& call, void(*cb)(RETURN)) {
-    Run(std::move(call), std::function<void(RETURN)>(cb));
+  bool Run(std::function<RETURN()>&& call, void(*cb)(RETURN)) {
+    return Run(std::move(call), std::function<void(RETURN)>(cb));
   }
 
   template <typename RETURN>
-  void Run(RETURN(*call)(), std::function<void(RETURN)>&& cb) {
-    Run(std::function<RETURN()>(call), std::move(cb));
+  bool Run(RETURN(*call)(), std::function<void(RETURN)>&& cb) {
+    return Run(std::function<RETURN()>(call), std::move(cb));
   }
 
+  /// 统计数据
+  Stats GetStats() const;
+
  private:
-  struct AsyncInfo {
-    std::function<bool()> checker;
-    std::function<void()> callback;
+  using Clock = std::chrono::steady_clock;
+
+  /**
+   * 计数器，任务和回调都持有一份，AsyncRun 析构后还在io里的回调仍然可以安全的执行
+   */
+  struct State {
+    std::atomic<uint64_t> submitted{0};
+    std::atomic<uint64_t> rejected{0};
+    std::atomic<uint64_t> completed{0};
+    std::atomic<uint64_t> failed{0};
+    std::atomic<uint64_t> pending{0};
+    std::atomic<uint64_t> queueTime{0};
+    std::atomic<uint64_t> runTime{0};
+    std::atomic<uint64_t> totalTime{0};
+    std::atomic<uint64_t> maxTotalTime{0};
+
+    void Fail();
+    void Complete(Clock::time_point submit, Clock::time_point begin, Clock::time_point end);
   };
 
-  void MasterThread();
-  void HandleDone();
-  void DoRead();
-
-  using AsyncInfoPtr = std::unique_ptr<AsyncInfo>;
+  /// 占用一个队列位置
+  bool Acquire();
 
-  std::atomic_bool isRunning_{true};
-  std::thread masterThread_;
-  boost::asio::local::stream_protocol::socket sender_;
-  boost::asio::local::stream_protocol::socket receiver_;
-  std::array<char, 4> buffer_;
-
-  std::list<AsyncInfoPtr> sendList_;
-  std::mutex sendLock_;
-  std::list<AsyncInfoPtr> checkList_;
-
-  std::unique_ptr<std::list<AsyncInfoPtr>> pendingDoneList_;
-  std::unique_ptr<std::list<AsyncInfoPtr>> doneList_;
-  std::mutex doneLock_;
+  boost::asio::io_context& io_;
+  std::size_t maxPending_;
+  std::shared_ptr<State> state_;
+  std::unique_ptr<TaskPool> pool_;
 };
 
 }
-}
\ No newline at end of file
+}
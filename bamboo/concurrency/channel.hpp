@@ -1,57 +1,369 @@
 #pragma once
 
-#include <list>
-#include <thread>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
 #include <mutex>
+#include <vector>
+
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/post.hpp>
 
 namespace bamboo {
 namespace concurrency {
 
+/**
+ * 有界多生产者多消费者通道
+ *
+ * @brief 基于环形数组的无锁队列，每个槽位带一个序号，生产者和消费者各自用 CAS 抢占位置，
+ *        读写位置分别独占缓存行。队列满或者空时 Try 系列直接返回，阻塞系列在条件变量上等待，
+ *        只有存在等待者时才会加锁唤醒，没有等待者时收发都不加锁。
+ *        AsyncPop 在指定的io上异步接收，适合io线程消费，不需要轮询
+ *
+ * @tparam TYPE 数据类型，需要可以默认构造和移动赋值
+ */
 template <typename TYPE>
 class Channel final {
  public:
-  Channel() {}
+  /// 异步接收的回调
+  using Handler = std::function<void(TYPE)>;
+
+  /**
+   * 构造函数
+   * @param capacity 容量，向上取整为2的幂，至少为2
+   */
+  explicit Channel(std::size_t capacity = 1024) {
+    std::size_t size = 2;
+    while (size < capacity) size <<= 1;
+    mask_ = size - 1;
+    cells_.reset(new Cell[size]);
+    for (std::size_t i = 0; i < size; ++i) {
+      cells_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+  }
+
   ~Channel() {}
 
-  bool Empty() {
-    std::lock_guard<std::mutex> l(lock_);
-    return list_.empty();
+  Channel(const Channel&) = delete;
+  Channel& operator=(const Channel&) = delete;
+
+  /// 容量
+  std::size_t Capacity() const { return mask_ + 1; }
+
+  /// 数据数量，并发时为近似值
+  std::size_t Size() const {
+    std::size_t tail = enqueuePos_.load(std::memory_order_acquire);
+    std::size_t head = dequeuePos_.load(std::memory_order_acquire);
+    return tail > head ? tail - head : 0;
+  }
+
+  /// 是否为空，并发时为近似值
+  bool Empty() const { return Size() == 0; }
+
+  /**
+   * 尝试发送，队列满时返回 false，数据不会被移走
+   */
+  bool TryPush(const TYPE& value) {
+    if (!Enqueue(value)) return false;
+    NotifyPush();
+    return true;
   }
 
-  void Push(const TYPE& type) {
-    std::lock_guard<std::mutex> l(lock_);
-    list_.push_back(type);
+  bool TryPush(TYPE&& value) {
+    if (!Enqueue(std::move(value))) return false;
+    NotifyPush();
+    return true;
   }
 
-  void Push(TYPE&& type) {
-    std::lock_guard<std::mutex> l(lock_);
-    list_.push_back(std::move(type));
+  /// 发送，队列满时阻塞等待
+  void Push(const TYPE& value) {
+    TYPE copy(value);
+    Push(std::move(copy));
   }
 
-  std::size_t Size() {
-    std::lock_guard<std::mutex> l(lock_);
-    return list_.size();
+  void Push(TYPE&& value) {
+    while (!TryPush(std::move(value))) {
+      WaitNotFull(nullptr);
+    }
   }
 
-  bool TryPop(TYPE& type) {
-    std::lock_guard<std::mutex> l(lock_);
+  /**
+   * 发送，队列满时最多等待指定时间
+   * @return 是否发送成功
+   */
+  template <typename REP, typename PERIOD>
+  bool PushFor(TYPE&& value, const std::chrono::duration<REP, PERIOD>& timeout) {
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+    while (!TryPush(std::move(value))) {
+      if (!WaitNotFull(&deadline)) return TryPush(std::move(value));
+    }
+    return true;
+  }
 
-    if (list_.empty()) return false;
+  /**
+   * 批量发送，队列满时停止
+   * @return 发送的数量
+   */
+  template <typename ITERATOR>
+  std::size_t TryPushBatch(ITERATOR first, ITERATOR last) {
+    std::size_t count = 0;
+    for (; first != last; ++first) {
+      if (!Enqueue(*first)) break;
+      count += 1;
+    }
+    // 整批只唤醒一次
+    if (count > 0) NotifyPush();
+    return count;
+  }
 
-    type = std::move(list_.front());
-    list_.pop_front();
+  /**
+   * 尝试接收，队列空时返回 false
+   */
+  bool TryPop(TYPE& value) {
+    if (!Dequeue(value)) return false;
+    NotifyPop();
     return true;
   }
 
-  void Pop(TYPE& type) {
-    while (!TryPop(type)) {
-      std::this_thread::yield();
+  /// 接收，队列空时阻塞等待
+  void Pop(TYPE& value) {
+    while (!TryPop(value)) {
+      WaitNotEmpty(nullptr);
     }
   }
 
+  /**
+   * 接收，队列空时最多等待指定时间
+   * @return 是否接收成功
+   */
+  template <typename REP, typename PERIOD>
+  bool PopFor(TYPE& value, const std::chrono::duration<REP, PERIOD>& timeout) {
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+    while (!TryPop(value)) {
+      if (!WaitNotEmpty(&deadline)) return TryPop(value);
+    }
+    return true;
+  }
+
+  /**
+   * 批量接收，追加到 values 末尾
+   * @param max 最多接收的数量
+   * @return 接收的数量
+   */
+  std::size_t TryPopBatch(std::vector<TYPE>& values, std::size_t max) {
+    std::size_t count = 0;
+    TYPE value;
+    while (count < max && Dequeue(value)) {
+      values.push_back(std::move(value));
+      count += 1;
+    }
+    if (count > 0) NotifyPop();
+    return count;
+  }
+
+  /**
+   * 批量接收，队列空时阻塞等待，至少接收一个
+   * @see TryPopBatch
+   */
+  std::size_t PopBatch(std::vector<TYPE>& values, std::size_t max) {
+    if (max == 0) return 0;
+    std::size_t count;
+    while ((count = TryPopBatch(values, max)) == 0) {
+      WaitNotEmpty(nullptr);
+    }
+    return count;
+  }
+
+  /**
+   * 异步接收
+   *
+   * @brief 有数据时回调会 post 到 io 上执行。每次调用只接收一个数据，持续接收需要在回调中再次调用。
+   *        回调执行前通道不能析构
+   * @param io 执行回调的io
+   * @param handler 回调函数
+   */
+  void AsyncPop(boost::asio::io_context& io, Handler&& handler) {
+    TYPE value;
+    if (TryPop(value)) {
+      Deliver(io, std::make_shared<Handler>(std::move(handler)), std::move(value));
+      return;
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      asyncList_.push_back(AsyncWaiter{&io, std::make_shared<Handler>(std::move(handler))});
+      asyncWaiters_.fetch_add(1);
+    }
+    // 登记之后再检查一次，避免登记前刚好有数据进来
+    DispatchAsync();
+  }
+
  private:
-  std::list<TYPE> list_;
-  std::mutex lock_;
+  struct Cell {
+    std::atomic<std::size_t> sequence;
+    TYPE data;
+  };
+
+  struct AsyncWaiter {
+    boost::asio::io_context* io;
+    std::shared_ptr<Handler> handler;
+  };
+
+  template <typename VALUE>
+  bool Enqueue(VALUE&& value) {
+    Cell* cell;
+    std::size_t pos = enqueuePos_.load(std::memory_order_relaxed);
+    while (true) {
+      cell = &cells_[pos & mask_];
+      std::size_t sequence = cell->sequence.load(std::memory_order_acquire);
+      intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+      if (diff == 0) {
+        if (enqueuePos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+      } else if (diff < 0) {
+        return false;
+      } else {
+        pos = enqueuePos_.load(std::memory_order_relaxed);
+      }
+    }
+
+    cell->data = std::forward<VALUE>(value);
+    cell->sequence.store(pos + 1, std::memory_order_release);
+    return true;
+  }
+
+  bool Dequeue(TYPE& value) {
+    Cell* cell;
+    std::size_t pos = dequeuePos_.load(std::memory_order_relaxed);
+    while (true) {
+      cell = &cells_[pos & mask_];
+      std::size_t sequence = cell->sequence.load(std::memory_order_acquire);
+      intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos + 1);
+      if (diff == 0) {
+        if (dequeuePos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+      } else if (diff < 0) {
+        return false;
+      } else {
+        pos = dequeuePos_.load(std::memory_order_relaxed);
+      }
+    }
+
+    value = std::move(cell->data);
+    cell->sequence.store(pos + mask_ + 1, std::memory_order_release);
+    return true;
+  }
+
+  /**
+   * 等待的一方先登记再检查队列，唤醒的一方先修改队列再检查登记，
+   * 两边都有全屏障，至少有一方能看到对方
+   */
+  void NotifyPush() {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (asyncWaiters_.load(std::memory_order_relaxed) > 0) DispatchAsync();
+    if (popWaiters_.load(std::memory_order_relaxed) > 0) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      notEmpty_.notify_all();
+    }
+  }
+
+  void NotifyPop() {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (pushWaiters_.load(std::memory_order_relaxed) > 0) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      notFull_.notify_all();
+    }
+  }
+
+  bool Full() const {
+    std::size_t pos = enqueuePos_.load(std::memory_order_relaxed);
+    std::size_t sequence = cells_[pos & mask_].sequence.load(std::memory_order_acquire);
+    return static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos) < 0;
+  }
+
+  bool HasData() const {
+    std::size_t pos = dequeuePos_.load(std::memory_order_relaxed);
+    std::size_t sequence = cells_[pos & mask_].sequence.load(std::memory_order_acquire);
+    return static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos + 1) >= 0;
+  }
+
+  /// 等待队列不满，超时返回 false
+  bool WaitNotFull(const std::chrono::steady_clock::time_point* deadline) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    pushWaiters_.fetch_add(1);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    bool ready = true;
+    if (deadline) {
+      ready = notFull_.wait_until(lock, *deadline, [this]() { return !Full(); });
+    } else {
+      notFull_.wait(lock, [this]() { return !Full(); });
+    }
+    pushWaiters_.fetch_sub(1);
+    return ready;
+  }
+
+  /// 等待队列有数据，超时返回 false
+  bool WaitNotEmpty(const std::chrono::steady_clock::time_point* deadline) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    popWaiters_.fetch_add(1);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    bool ready = true;
+    if (deadline) {
+      ready = notEmpty_.wait_until(lock, *deadline, [this]() { return HasData(); });
+    } else {
+      notEmpty_.wait(lock, [this]() { return HasData(); });
+    }
+    popWaiters_.fetch_sub(1);
+    return ready;
+  }
+
+  /// 把队列中的数据分给异步等待者
+  void DispatchAsync() {
+    std::size_t popped = 0;
+    std::vector<std::pair<AsyncWaiter, TYPE>> ready;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      while (!asyncList_.empty()) {
+        TYPE value;
+        if (!Dequeue(value)) break;
+        ready.emplace_back(std::move(asyncList_.front()), std::move(value));
+        asyncList_.pop_front();
+        asyncWaiters_.fetch_sub(1);
+        popped += 1;
+      }
+    }
+
+    for (auto& item : ready) {
+      Deliver(*item.first.io, item.first.handler, std::move(item.second));
+    }
+    if (popped > 0) NotifyPop();
+  }
+
+  static void Deliver(boost::asio::io_context& io, std::shared_ptr<Handler> handler, TYPE&& value) {
+    auto data = std::make_shared<TYPE>(std::move(value));
+    boost::asio::post(io, [handler, data]() {
+      (*handler)(std::move(*data));
+    });
+  }
+
+  std::unique_ptr<Cell[]> cells_;
+  std::size_t mask_{0};
+
+  char padding0_[64];
+  std::atomic<std::size_t> enqueuePos_{0};
+  char padding1_[64];
+  std::atomic<std::size_t> dequeuePos_{0};
+  char padding2_[64];
+
+  std::atomic<std::size_t> pushWaiters_{0};
+  std::atomic<std::size_t> popWaiters_{0};
+  std::atomic<std::size_t> asyncWaiters_{0};
+  std::mutex mutex_;
+  std::condition_variable notFull_;
+  std::condition_variable notEmpty_;
+  std::deque<AsyncWaiter> asyncList_;
 };
 
 }
@@ -0,0 +1,120 @@
+#pragma once
+
+#include <memory>
+#include <typeinfo>
+#include <utility>
+
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/io_context_strand.hpp>
+
+#include <bamboo/aio/ioload.hpp>
+#include <bamboo/utility/tsc.hpp>
+
+namespace bamboo {
+namespace concurrency {
+
+/**
+ * 服务的执行器
+ *
+ * @brief 服务上所有的异步回调都绑定到这个执行器。
+ *        没有 strand 时直接交给io执行，和不绑定时的行为相同；
+ *        有 strand 时回调经过 strand 串行执行，多个线程运行同一个io时，
+ *        同一个服务的回调仍然不会并发，服务内部不需要加锁。
+ *        经过执行器的回调都会记录到io的 bamboo::aio::IoLoad 上
+ */
+class Executor {
+ public:
+  /// 无效的执行器，只用于占位
+  Executor() {}
+
+  /// 直接在io上执行
+  explicit Executor(boost::asio::io_context& io) : io_(&io), load_(&bamboo::aio::IoLoad::Of(io)) {}
+
+  /// 创建一个新的 strand，回调在这个 strand 上串行执行
+  static Executor Strand(boost::asio::io_context& io) {
+    Executor executor(io);
+    executor.strand_ = std::make_shared<boost::asio::io_context::strand>(io);
+    return executor;
+  }
+
+  /// 是否有效
+  explicit operator bool() const { return io_ != nullptr; }
+
+  /// 是否经过 strand 执行
+  bool HasStrand() const { return strand_ != nullptr; }
+
+  /// 执行的io
+  boost::asio::io_context& context() const noexcept { return *io_; }
+
+  void on_work_started() const noexcept { io_->get_executor().on_work_started(); }
+
+  void on_work_finished() const noexcept { io_->get_executor().on_work_finished(); }
+
+  template <typename FUNCTION, typename ALLOCATOR>
+  void dispatch(FUNCTION&& function, const ALLOCATOR& allocator) const {
+    load_->Submit();
+    Timed<typename std::decay<FUNCTION>::type> timed{std::forward<FUNCTION>(function), load_};
+    if (strand_) {
+      strand_->dispatch(std::move(timed), allocator);
+    } else {
+      io_->get_executor().dispatch(std::move(timed), allocator);
+    }
+  }
+
+  template <typename FUNCTION, typename ALLOCATOR>
+  void post(FUNCTION&& function, const ALLOCATOR& allocator) const {
+    load_->Submit();
+    Timed<typename std::decay<FUNCTION>::type> timed{std::forward<FUNCTION>(function), load_};
+    if (strand_) {
+      strand_->post(std::move(timed), allocator);
+    } else {
+      io_->get_executor().post(std::move(timed), allocator);
+    }
+  }
+
+  template <typename FUNCTION, typename ALLOCATOR>
+  void defer(FUNCTION&& function, const ALLOCATOR& allocator) const {
+    load_->Submit();
+    Timed<typename std::decay<FUNCTION>::type> timed{std::forward<FUNCTION>(function), load_};
+    if (strand_) {
+      strand_->defer(std::move(timed), allocator);
+    } else {
+      io_->get_executor().defer(std::move(timed), allocator);
+    }
+  }
+
+  /// 当前线程是否正在这个执行器上运行
+  bool running_in_this_thread() const noexcept {
+    return strand_ ? strand_->running_in_this_thread() : io_->get_executor().running_in_this_thread();
+  }
+
+  friend bool operator==(const Executor& a, const Executor& b) noexcept {
+    return a.io_ == b.io_ && a.strand_ == b.strand_;
+  }
+
+  friend bool operator!=(const Executor& a, const Executor& b) noexcept {
+    return !(a == b);
+  }
+
+ private:
+  /// 记录回调排队和执行耗时的包装
+  template <typename FUNCTION>
+  struct Timed {
+    FUNCTION function;
+    bamboo::aio::IoLoad* load;
+
+    void operator()() {
+      load->Start();
+      uint64_t begin = bamboo::utility::Ticks();
+      function();
+      load->Record(bamboo::utility::Ticks() - begin, typeid(FUNCTION).name());
+    }
+  };
+
+  boost::asio::io_context* io_{nullptr};
+  bamboo::aio::IoLoad* load_{nullptr};
+  std::shared_ptr<boost::asio::io_context::strand> strand_;
+};
+
+}
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+
+namespace bamboo {
+namespace concurrency {
+
+/**
+ * 有界单生产者单消费者队列
+ *
+ * @brief 只能有一个线程发送、一个线程接收，收发都不加锁也不用 CAS。
+ *        读写位置各自独占缓存行，并缓存对方的位置，只有看起来满或者空的时候才去读对方的原子变量
+ *
+ * @tparam TYPE 数据类型，需要可以默认构造和移动赋值
+ */
+template <typename TYPE>
+class SpscQueue final {
+ public:
+  /**
+   * 构造函数
+   * @param capacity 容量，向上取整为2的幂，至少为2
+   */
+  explicit SpscQueue(std::size_t capacity) {
+    std::size_t size = 2;
+    while (size < capacity) size <<= 1;
+    mask_ = size - 1;
+    cells_.reset(new TYPE[size]);
+  }
+
+  ~SpscQueue() {}
+
+  SpscQueue(const SpscQueue&) = delete;
+  SpscQueue& operator=(const SpscQueue&) = delete;
+
+  /// 容量
+  std::size_t Capacity() const { return mask_ + 1; }
+
+  /**
+   * 发送，只能在生产者线程调用
+   * @return 队列满时返回 false，数据不会被移走
+   */
+  bool TryPush(TYPE&& value) {
+    std::size_t tail = tail_.load(std::memory_order_relaxed);
+    if (tail - headCache_ > mask_) {
+      headCache_ = head_.load(std::memory_order_acquire);
+      if (tail - headCache_ > mask_) return false;
+    }
+    cells_[tail & mask_] = std::move(value);
+    tail_.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  /**
+   * 接收，只能在消费者线程调用
+   * @return 队列空时返回 false
+   */
+  bool TryPop(TYPE& value) {
+    std::size_t head = head_.load(std::memory_order_relaxed);
+    if (head == tailCache_) {
+      tailCache_ = tail_.load(std::memory_order_acquire);
+      if (head == tailCache_) return false;
+    }
+    value = std::move(cells_[head & mask_]);
+    head_.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  /// 是否为空，并发时为近似值
+  bool Empty() const {
+    return head_.load(std::memory_order_acquire) == tail_.load(std::memory_order_acquire);
+  }
+
+ private:
+  std::unique_ptr<TYPE[]> cells_;
+  std::size_t mask_{0};
+
+  char padding0_[64];
+  std::atomic<std::size_t> tail_{0};
+  std::size_t headCache_{0}; /**< 生产者缓存的读位置 */
+  char padding1_[64];
+  std::atomic<std::size_t> head_{0};
+  std::size_t tailCache_{0}; /**< 消费者缓存的写位置 */
+  char padding2_[64];
+};
+
+}
+}
@@ -1,31 +1,71 @@
 #pragma once
 
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
 #include <thread>
-#include <list>
 #include <vector>
 
 namespace bamboo {
 namespace concurrency {
 
+/**
+ * 任务池
+ *
+ * @brief 每个工作线程有自己的任务队列。工作线程里提交的任务放到自己的队列尾部并优先执行，
+ *        其他线程提交的任务轮流分配给各个工作线程；自己的队列为空时从其他线程的队列头部窃取任务，
+ *        都没有任务时休眠，直到有新任务提交。析构时会执行完所有已提交的任务
+ */
 class TaskPool final {
  public:
+  /// 使用cpu核数个工作线程
   TaskPool();
-  TaskPool(std::size_t size);
+
+  /**
+   * 构造函数
+   * @param size 工作线程数量，至少为1
+   * @param cpus 工作线程绑定的cpu集合，为空时不绑定，可以使用 bamboo::aio::Topology::workerCpus
+   */
+  TaskPool(std::size_t size, std::vector<int> cpus = std::vector<int>());
   ~TaskPool();
 
   using Handler = std::function<void()>;
+
+  /**
+   * 提交任务，可以在任务中调用
+   * @param handle 任务
+   */
   void Add(Handler&& handle);
 
+  /// 工作线程数量
+  std::size_t Size() const { return workers_.size(); }
+
  private:
-  void TaskMain();
+  /// 工作线程的任务队列，独占缓存行，避免相邻队列的锁互相干扰
+  struct Worker {
+    std::deque<Handler> tasks;
+    std::mutex mutex;
+    char padding[64];
+  };
 
-  std::list<Handler> list_;
-  std::mutex mutex_;
-  std::condition_variable cond_;
+  void TaskMain(std::size_t index, std::vector<int> cpus);
+  /// 从自己的队列尾部取任务
+  bool Pop(std::size_t index, Handler& h);
+  /// 从其他队列的头部窃取任务
+  bool Steal(std::size_t index, Handler& h);
+
+  std::vector<std::unique_ptr<Worker>> workers_;
   std::vector<std::thread> threads_;
-  std::atomic_bool isRunning_{true};
+  std::atomic<std::size_t> next_{0};     /**< 外部提交时轮流选择的队列 */
+  std::atomic<std::size_t> pending_{0};  /**< 队列中的任务数 */
+  std::atomic<std::size_t> idle_{0};     /**< 休眠中的工作线程数 */
+  std::mutex parkMutex_;
+  std::condition_variable parkCond_;
+  bool isRunning_{true};
 };
 
 }
 }
-
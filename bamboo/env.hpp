@@ -9,15 +9,27 @@ namespace env {
 /// Aio 模式
 enum class ThreadMode {
   SINGLE, /**< 单线程模式 */
-  MULTIPLE /**< 多线程模式 */
+  MULTIPLE, /**< 多线程模式 */
+  SHARED /**< 共享模式，多个线程运行少量的io，服务使用独占的 strand */
 };
 
-/// 初始化aio模式
-void Init(ThreadMode mode = ThreadMode::SINGLE);
+/**
+ * 初始化aio模式
+ * @param mode 线程模式
+ * @param topology io线程的布局，单线程模式只使用第0个io的配置；全局调度器使用其中的调度器实现
+ */
+void Init(ThreadMode mode = ThreadMode::SINGLE, const bamboo::aio::Topology& topology = bamboo::aio::Topology());
 
 /// 获取aio
 bamboo::aio::AioPtr GetIo();
 
+/**
+ * io使用的事件后端
+ *
+ * @brief 由 asio 的编译选项决定，默认为 "epoll"
+ */
+const char* Backend();
+
 /**
  * 获取调度器
  *
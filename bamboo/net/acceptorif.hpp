@@ -53,6 +53,7 @@ class AcceptorIf {
 
     auto ptr = std::make_shared<CONNMANGER>(std::forward<ARGS>(args)...);
     connManager_ = std::dynamic_pointer_cast<ConnManagerIf>(ptr);
+    connManager_->SetExecutor(executor_);
     return ptr;
   }
 
@@ -68,13 +69,37 @@ class AcceptorIf {
   /// 获取链接管理类
   virtual ConnManagerPtr GetConnManager() final;
 
+  /// 实际监听的地址，端口为 0 时可以得到系统分配的端口
+  virtual boost::asio::ip::tcp::endpoint GetLocalEndpoint() const final;
+
+  /// 监听端口是否实际开启了 SO_REUSEPORT
+  virtual bool IsReusePort() const final;
+
  protected:
   /// 构造函数，只能被server类创建
   AcceptorIf(boost::asio::io_context& io);
 
+  /**
+   * 监听端口是否开启 SO_REUSEPORT
+   *
+   * @note 开启后，多个监听助手可以绑定到同一个地址，由内核在它们之间分配新链接
+   */
+  virtual bool ReusePort();
+
+  /**
+   * 在监听端口上开启 SO_REUSEPORT
+   *
+   * @note 系统不支持时返回 false，按普通方式监听：第一个监听助手独占端口，之后绑定同一个端口的会失败
+   * @return 是否开启成功
+   */
+  virtual bool EnableReusePort(boost::asio::ip::tcp::acceptor& acceptor);
+
   ConnManagerPtr connManager_;
   std::unique_ptr<boost::asio::ip::tcp::acceptor> acceptor_;
   boost::asio::io_context& io_;
+  /// 所属服务的执行器，监听和新链接的回调都在上面执行
+  bamboo::concurrency::Executor executor_;
+  bool reusePort_{false};
 };
 
 using AcceptorPtr = std::shared_ptr<AcceptorIf>;
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <vector>
+
+#include <bamboo/net/connectorif.hpp>
+
+namespace bamboo {
+namespace net {
+
+/**
+ * 到同一个地址的连接池
+ *
+ * @brief 通过 ConnectorIf::KeepConnect 维持固定数量的链接，断开后按策略自动重连。
+ *        业务层通过 Begin/End 记录每个链接上的在途请求，Select 返回在途请求最少的链接
+ */
+class ConnectionPool final : public std::enable_shared_from_this<ConnectionPool> {
+ public:
+  /**
+   * 构造函数
+   * @param connector 连接助手类，链接由它的链接管理类管理
+   * @param address 地址
+   * @param port 端口
+   * @param size 链接数量
+   * @param policy 重连策略
+   */
+  ConnectionPool(ConnectorPtr connector, std::string address, uint16_t port, std::size_t size,
+                 ConnectorIf::ReconnectPolicy policy = ConnectorIf::ReconnectPolicy());
+  ~ConnectionPool();
+
+  /// 开始建立链接
+  void Start();
+
+  /// 停止重连，不会关闭已经建立的链接
+  void Stop();
+
+  /**
+   * 选择在途请求最少的可用链接
+   * @return socket 或 nullptr(没有可用链接)
+   */
+  SocketPtr Select();
+
+  /// 在链接上开始一个请求
+  void Begin(const SocketPtr& so);
+
+  /// 链接上的一个请求完成
+  void End(const SocketPtr& so);
+
+  /// 当前可用的链接数量
+  std::size_t GetAliveSize();
+
+ private:
+  struct Slot {
+    SocketPtr socket;
+    std::size_t inflight{0};
+    ConnectorIf::KeepId keep{0};
+  };
+
+  Slot* Find(const SocketPtr& so);
+
+  ConnectorPtr connector_;
+  std::string address_;
+  uint16_t port_{0};
+  ConnectorIf::ReconnectPolicy policy_;
+  std::vector<Slot> slots_;
+};
+
+using ConnectionPoolPtr = std::shared_ptr<ConnectionPool>;
+
+}
+}
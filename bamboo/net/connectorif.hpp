@@ -1,8 +1,13 @@
 #pragma once
 
+#include <map>
+#include <random>
+#include <set>
+
 #include <bamboo/define.hpp>
 #include <bamboo/net/connmanagerif.hpp>
 #include <bamboo/net/socket.hpp>
+#include <bamboo/schedule/scheduler.hpp>
 
 namespace bamboo {
 
@@ -18,8 +23,12 @@ namespace net {
 class ConnectorIf {
  public:
 
-  /// 默认的析构函数
-  virtual ~ConnectorIf() {}
+  /**
+   * 析构函数
+   *
+   * @note 取消还没有完成的异步连接，回调不再执行；所属服务的调度器可能已经析构，计时器留给调度器自己清理
+   */
+  virtual ~ConnectorIf();
 
   friend class bamboo::server::ServerIf;
 
@@ -38,17 +47,77 @@ class ConnectorIf {
 
     auto ptr = std::make_shared<CONNMANGER>(std::forward<ARGS>(args)...);
     connManager_ = std::dynamic_pointer_cast<ConnManagerIf>(ptr);
+    connManager_->SetExecutor(executor_);
     return ptr;
   }
 
   /**
    * 连接到特定地址的socket
+   *
+   * @note 解析和连接都是阻塞的，会卡住所在io上的其他链接，io运行后建议使用 AsyncConnect
    * @param address 地址
    * @param port 端口
    * @return 连接成功后的socket 或 nullptr
    */
   virtual SocketPtr Connect(std::string address, uint16_t port) final;
 
+  /// 异步连接的回调函数类型，失败时 socket 为 nullptr
+  using ConnectHandler = std::function<void(const boost::system::error_code&, SocketPtr)>;
+
+  /**
+   * 异步连接到特定地址
+   * @param address 地址
+   * @param port 端口
+   * @param handler 连接完成的回调函数，在服务的io上执行
+   * @param timeout 超时毫秒数，由服务的调度器计时，0 表示不限时
+   */
+  virtual void AsyncConnect(std::string address, uint16_t port, ConnectHandler&& handler, std::time_t timeout = 0) final;
+
+  /**
+   * 重连策略
+   *
+   * @brief 第n次重连的延迟为 min(initialDelay * multiplier^n, maxDelay)，
+   *        再在 ±jitter 的比例内随机抖动，避免大量链接同时重连
+   */
+  struct ReconnectPolicy {
+    std::time_t initialDelay{100}; /**< 首次重连的延迟毫秒数 */
+    std::time_t maxDelay{30000}; /**< 最大的重连延迟毫秒数 */
+    double multiplier{2.0}; /**< 每次失败后延迟的倍数 */
+    double jitter{0.2}; /**< 随机抖动的比例 */
+    std::time_t timeout{5000}; /**< 每次连接的超时毫秒数 */
+
+    /**
+     * 计算重连延迟
+     * @param attempt 已经连续失败的次数
+     * @param random [-1, 1] 之间的随机数，按 jitter 缩放后作为抖动
+     * @return 延迟毫秒数
+     */
+    std::time_t Delay(std::size_t attempt, double random) const;
+  };
+
+  /// 保持连接的Id类型
+  using KeepId = uint64_t;
+
+  /**
+   * 保持到特定地址的连接，连接失败或断开后按策略自动重连
+   * @param address 地址
+   * @param port 端口
+   * @param policy 重连策略
+   * @param handler 每次连接成功后的回调函数
+   * @return 保持连接的Id，用于 StopKeepConnect
+   */
+  virtual KeepId KeepConnect(std::string address, uint16_t port, ReconnectPolicy policy,
+                             std::function<void(SocketPtr)>&& handler) final;
+
+  /**
+   * 停止保持连接，不会关闭已经建立的链接，之后链接关闭时也不再重连
+   * @param id KeepConnect 返回的Id
+   */
+  virtual void StopKeepConnect(KeepId id) final;
+
+  /// 停止所有的保持连接，并取消还没有完成的异步连接，它们的回调收到 operation_aborted；服务关闭时调用
+  virtual void Stop();
+
   /**
    * 设置管理类
    *
@@ -65,9 +134,39 @@ class ConnectorIf {
   /// 构造函数，只能被server类创建
   ConnectorIf(boost::asio::io_context& io);
 
+  /// 服务的调度器，用于连接超时和重连延迟
+  bamboo::schedule::Scheduler* scheduler_{nullptr};
+
+  /// 所属服务的执行器，解析和连接的回调都在上面执行
+  bamboo::concurrency::Executor executor_;
+
  private:
+  struct KeepInfo {
+    ConnectorIf* owner{nullptr}; /**< 停止后置空，链接上的关闭回调据此判断是否还要重连 */
+    KeepId id{0};
+    std::string address;
+    uint16_t port{0};
+    ReconnectPolicy policy;
+    std::function<void(SocketPtr)> handler;
+    std::size_t attempt{0};
+    bamboo::schedule::Scheduler::ID timer{0};
+  };
+
+  /// 一次异步连接的上下文
+  struct ConnectContext;
+
+  void FinishConnect(const std::shared_ptr<ConnectContext>& ctx, const boost::system::error_code& ec);
+  void DoKeepConnect(KeepId id);
+  void ScheduleReconnect(KeepId id);
+
   ConnManagerPtr connManager_;
   boost::asio::io_context& io_;
+  std::map<KeepId, std::shared_ptr<KeepInfo>> keeps_;
+  std::set<std::shared_ptr<ConnectContext>> connecting_;
+  /// 析构时释放，解析、连接和调度器的回调通过弱引用判断连接助手是否还在
+  std::shared_ptr<bool> alive_{std::make_shared<bool>(true)};
+  KeepId keepId_{0};
+  std::minstd_rand random_{std::random_device()()};
 };
 
 typedef std::shared_ptr<ConnectorIf> ConnectorPtr;
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <vector>
+
 #include <bamboo/define.hpp>
 
 #include <bamboo/protocol/protocolif.hpp>
@@ -30,7 +32,7 @@ class ConnManagerIf {
    * 链接删除的处理
    * @param socket 链接Id
    */
-  virtual void OnDelete(uint32_t socket) = 0;
+  virtual void OnDelete(uint64_t socket) = 0;
 
   /**
    * 往socket发送数据
@@ -38,7 +40,67 @@ class ConnManagerIf {
    * @param data 待发送的数据
    * @param size 数据长度
    */
-  virtual void WriteData(uint32_t socket, const char* data, std::size_t size) = 0;
+  virtual void WriteData(uint64_t socket, const char* data, std::size_t size) = 0;
+
+  /**
+   * 根据链接id获取socket
+   * @param socket 链接id
+   * @return socket对象，链接不存在时为 nullptr
+   */
+  virtual SocketPtr GetSocket(uint64_t socket) = 0;
+
+  /// 当前的链接数量
+  virtual std::size_t GetSocketSize() = 0;
+
+  /**
+   * 遍历所有链接
+   *
+   * @note 处理函数中可以关闭当前遍历到的链接
+   * @param handler 处理函数
+   */
+  virtual void ForeachSocket(std::function<void(SocketPtr&)>&& handler) = 0;
+
+  /**
+   * 广播数据给所有链接
+   *
+   * @note 所有链接共用同一份数据，只在各自的发送队列上增加一个引用，已经关闭的链接跳过
+   * @param payload 待发送的数据
+   * @return 发送的链接数量
+   */
+  virtual std::size_t Broadcast(const ConstBufferPtr& payload) final;
+
+  /**
+   * 广播数据给某个分组的链接
+   * @param group 分组，见 SocketIf::SetGroup
+   * @param payload 待发送的数据
+   * @return 发送的链接数量
+   */
+  virtual std::size_t Broadcast(uint32_t group, const ConstBufferPtr& payload) final;
+
+  /// 广播过滤函数类型，返回 true 的链接才会发送
+  using SocketFilter = std::function<bool(const SocketPtr&)>;
+
+  /**
+   * 广播数据给满足条件的链接
+   * @param payload 待发送的数据
+   * @param filter 过滤函数
+   * @return 发送的链接数量
+   */
+  virtual std::size_t Broadcast(const ConstBufferPtr& payload, SocketFilter&& filter) final;
+
+  /**
+   * 发送数据给指定的多个链接
+   * @param sockets 链接id列表，不存在或者已经关闭的链接会被忽略
+   * @param payload 待发送的数据
+   * @return 发送的链接数量
+   */
+  virtual std::size_t Multicast(const std::vector<uint64_t>& sockets, const ConstBufferPtr& payload) final;
+
+  /**
+   * 所有链接发送完队列中的数据后关闭
+   * @see SocketIf::CloseAfterFlush
+   */
+  virtual void CloseAfterFlush() final;
 
   /// 链接数据可读的回调函数类型
   using ReadHandler = std::function<std::size_t(SocketPtr, const char*, std::size_t)>;
@@ -95,11 +157,65 @@ class ConnManagerIf {
   /// 获取链接删除的回调函数
   virtual DeleteHandler& GetDeleteHandler() final;
 
+  /**
+   * 设置所有链接默认的发送队列高低水位
+   *
+   * @note 只对之后建立的链接生效
+   * @see SocketIf::SetWriteWatermark
+   */
+  virtual void SetWriteWatermark(std::size_t high, std::size_t low, bool pauseRead = false) final;
+
+  /**
+   * 设置所有链接的 SO_BUSY_POLL，内核在收包时忙轮询网卡队列的微秒数
+   *
+   * @note 只对之后建立的链接生效，一般配合 bamboo::aio::Topology::pollBudget 使用。
+   *       超过系统默认值时需要 CAP_NET_ADMIN 权限，设置失败只记录日志
+   * @param microseconds 忙轮询的微秒数，0 为不设置
+   */
+  virtual void SetBusyPoll(uint32_t microseconds) final;
+
+  /// 链接水位变化的回调函数类型，参数为 true 表示超过高水位，false 表示回落到低水位
+  using WatermarkHandler = std::function<void(SocketPtr, bool)>;
+
+  /// 设置链接水位变化的回调函数
+  virtual void SetWatermarkHandler(WatermarkHandler&& handle) final;
+
+  /// 获取链接水位变化的回调函数
+  virtual WatermarkHandler& GetWatermarkHandler() final;
+
+  /**
+   * 设置新链接的执行器，由监听助手和连接助手设置为所属服务的执行器
+   *
+   * @note 只对之后建立的链接生效
+   */
+  virtual void SetExecutor(const bamboo::concurrency::Executor& executor) final;
+
+  /// 获取新链接的执行器，没有设置时无效
+  virtual const bamboo::concurrency::Executor& GetExecutor() final;
+
+  /**
+   * 接收从其他io迁移过来的链接
+   * @param socket 在本管理类所在io上重新创建的socket
+   * @param unread 原链接还未处理的数据，会先交给读处理函数
+   * @return 新的链接
+   */
+  virtual SocketPtr Adopt(boost::asio::ip::tcp::socket&& socket, const std::string& unread) final;
+
+ protected:
+  /// 把管理类上的默认设置应用到新链接上，由派生类在 OnConnect 中调用
+  virtual void InitSocket(const SocketPtr& so) final;
+
  private:
   ReadHandler reader_;
   DeleteHandler deleter_;
   ConnectHandler connector_;
+  WatermarkHandler watermarker_;
+  std::size_t highWatermark_{0};
+  std::size_t lowWatermark_{0};
+  bool pauseReadOnHigh_{false};
+  uint32_t busyPoll_{0};
   bamboo::protocol::ProtocolPtr protocol_;
+  bamboo::concurrency::Executor executor_;
 };
 
 using ConnManagerPtr = std::shared_ptr<ConnManagerIf>;
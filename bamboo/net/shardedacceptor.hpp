@@ -0,0 +1,30 @@
+#pragma once
+
+#include <bamboo/net/simpleacceptor.hpp>
+
+namespace bamboo {
+namespace net {
+
+/**
+ * 分片监听助手类
+ *
+ * @brief 以 SO_REUSEPORT 方式监听，同一个端口可以在每个io上各创建一个，
+ *        由内核把新链接分配到各个io上，每个分片把链接交给自己io上的链接管理类。
+ *        一般配合 bamboo::aio::AioIf::CreateShardedServer 使用
+ *
+ * @note 系统不支持 SO_REUSEPORT 时退化为普通监听，只有第一个分片能绑定端口，
+ *       之后的分片创建失败，可以通过 IsReusePort 确认
+ *
+ * @see bamboo::net::SimpleAcceptor
+ */
+class ShardedAcceptor : public SimpleAcceptor {
+ public:
+  using SimpleAcceptor::SimpleAcceptor;
+  virtual ~ShardedAcceptor() {}
+
+ protected:
+  bool ReusePort() override { return true; }
+};
+
+}
+}
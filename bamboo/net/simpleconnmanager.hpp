@@ -4,6 +4,7 @@
 
 #include <bamboo/net/connmanagerif.hpp>
 #include <bamboo/net/socket.hpp>
+#include <bamboo/utility/slotmap.hpp>
 
 namespace bamboo {
 namespace net {
@@ -20,11 +21,14 @@ class SimpleConnManager : public ConnManagerIf,
   virtual ~SimpleConnManager();
 
   SocketPtr OnConnect(boost::asio::ip::tcp::socket&& socket) override;
-  void OnDelete(uint32_t socket) override;
-  void WriteData(uint32_t socket, const char* data, std::size_t size) override;
+  void OnDelete(uint64_t socket) override;
+  void WriteData(uint64_t socket, const char* data, std::size_t size) override;
+  SocketPtr GetSocket(uint64_t socket) override;
+  std::size_t GetSocketSize() override;
+  void ForeachSocket(std::function<void(SocketPtr&)>&& handler) override;
 
  private:
-  std::map<uint32_t, SocketPtr> sockets_;
+  bamboo::utility::SlotMap<SocketPtr> sockets_;
 };
 
 }
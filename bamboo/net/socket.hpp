@@ -1,9 +1,10 @@
 #pragma once
 
-#include <list>
+#include <array>
 #include <bamboo/define.hpp>
 #include <bamboo/net/socketif.hpp>
-#include <bamboo/buffer/fixedbuffer.hpp>
+#include <bamboo/buffer/pooledbuffer.hpp>
+#include <bamboo/utility/ringqueue.hpp>
 
 namespace bamboo {
 namespace net {
@@ -23,13 +24,58 @@ class Socket : public SocketIf,
   void WriteData(const char* data, std::size_t size) override;
   void WriteData(bamboo::protocol::MessageIf* message) override;
   void WriteData(std::unique_ptr<std::string>&& buffer) override;
+  void WriteData(ConstBufferPtr buffer) override;
   void Close() override;
+  void CloseAfterFlush() override;
+  std::size_t GetWriteQueueSize() override;
+  bool Release(ReleaseHandler&& handler) override;
+  void Feed(const char* data, std::size_t size) override;
 
  private:
+  /// 缓存未处理数据的上限，超过则认为对端异常
+  static const std::size_t MAX_READ_BUFFER = 1024 * 512;
+
+  /// 有未处理数据时，每次至少预留的读取空间
+  static const std::size_t READ_CHUNK = 1024 * 4;
+
+  /// 单次 writev 最多合并的数据块数量
+  static const std::size_t MAX_WRITE_BUFFERS = 64;
+
+  /// 发送队列中的一块数据，holder 负责在发送完之前保持数据有效
+  struct WriteItem {
+    std::shared_ptr<const void> holder;
+    const char* data;
+    std::size_t size;
+  };
+
+  void ReadScratch();
+  void HandleRead(const char* data, std::size_t size);
+  /// 交出文件描述符，unread 为读处理函数没有消耗的数据，返回是否已经交出
+  bool DoRelease(const char* unread, std::size_t size);
+  void PushWrite(std::shared_ptr<const void> holder, const char* data, std::size_t size);
   void DoWriteData();
+  void ConsumeWrite(std::size_t size);
 
-  bamboo::buffer::FixedBuffer<1024*512> buffer_;
-  std::list<std::shared_ptr<std::string>> list_;
+  /// 只在有不完整的数据等待处理时才持有内存
+  bamboo::buffer::PooledBuffer buffer_;
+  bamboo::utility::RingQueue<WriteItem> list_;
+  /// list_ 第一块数据已经发送的长度
+  std::size_t offset_{0};
+  bool writing_{false};
+  bool closed_{false};
+  /// 发送完队列后关闭，不再处理读到的数据
+  bool flushClose_{false};
+  /// 未发送的字节数
+  std::size_t queued_{0};
+  /// 是否处于高水位
+  bool overHigh_{false};
+  /// 是否因高水位暂停了读取
+  bool readPaused_{false};
+  /// 是否正在执行读处理函数
+  bool reading_{false};
+  /// 读处理函数中请求的交出，处理函数返回后执行
+  ReleaseHandler releaser_;
+  std::array<boost::asio::const_buffer, MAX_WRITE_BUFFERS> writeBuffers_;
 };
 
 }
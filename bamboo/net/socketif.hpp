@@ -1,12 +1,19 @@
 #pragma once
 
+#include <vector>
+
 #include <bamboo/define.hpp>
+#include <bamboo/concurrency/executor.hpp>
+#include <bamboo/aio/ioload.hpp>
 
 #include <bamboo/protocol/messageif.hpp>
 
 namespace bamboo {
 namespace net {
 
+/// 只读数据块的共享指针，同一块数据可以同时挂在多个socket的发送队列上
+using ConstBufferPtr = std::shared_ptr<const std::string>;
+
 /**
  * socket基类
  */
@@ -23,10 +30,45 @@ class SocketIf : public boost::asio::ip::tcp::socket {
   using boost::asio::ip::tcp::socket::basic_stream_socket;
 
   /// 设置id
-  virtual void SetId(uint32_t id) final;
+  virtual void SetId(uint64_t id) final;
 
   /// 获取id
-  virtual uint32_t GetId() final ;
+  virtual uint64_t GetId() final ;
+
+  /// 设置分组，用于广播时过滤
+  virtual void SetGroup(uint32_t group) final;
+
+  /// 获取分组，默认为0
+  virtual uint32_t GetGroup() final;
+
+  /// 设置异步回调的执行器，由链接管理类设置为所属服务的执行器
+  virtual void SetExecutor(const bamboo::concurrency::Executor& executor) final;
+
+  /// 获取异步回调的执行器，没有设置时直接在socket所在的io上执行
+  virtual const bamboo::concurrency::Executor& GetExecutor() final;
+
+  /// 交出文件描述符后的回调类型，参数为文件描述符和还未处理的数据，文件描述符为 -1 时没有交出
+  using ReleaseHandler = std::function<void(native_handle_type, std::string&)>;
+
+  /**
+   * 交出底层的文件描述符，用于把链接迁移到另一个io
+   *
+   * @brief 发送队列为空时才能交出。交出后未完成的异步操作会被取消，
+   *        链接按关闭处理，从原来的链接管理类中移除，但不会关闭文件描述符
+   * @note 必须在链接所在的执行器上调用。在读处理函数中调用时，等处理函数返回后才交出，
+   *       未处理的数据只包含处理函数没有消耗的部分；处理函数返回前又发送了数据或者关闭了链接时，
+   *       回调的文件描述符为 -1，链接保持原样
+   * @param handler 交出后的回调，不在读处理函数中时立即执行
+   * @return 是否开始交出，返回 false 时不会执行回调
+   */
+  virtual bool Release(ReleaseHandler&& handler) = 0;
+
+  /**
+   * 把数据当作从对端收到的数据交给读处理函数，用于迁移后补上未处理的数据
+   * @param data 数据
+   * @param size 长度
+   */
+  virtual void Feed(const char* data, std::size_t size) = 0;
 
   /// 数据可读处理函数
   virtual void ReadData() = 0;
@@ -44,6 +86,14 @@ class SocketIf : public boost::asio::ip::tcp::socket {
    */
   virtual void WriteData(std::unique_ptr<std::string>&& buffer) = 0;
 
+  /**
+   * 发送数据，不拷贝
+   *
+   * @note 数据在发送完之前由引用计数保持，调用方在此期间不能修改它
+   * @param buffer 待发送数据的共享指针
+   */
+  virtual void WriteData(ConstBufferPtr buffer) = 0;
+
   /**
    * 发送数据
    * @param message 待发送消息
@@ -53,6 +103,35 @@ class SocketIf : public boost::asio::ip::tcp::socket {
   /// 关闭处理
   virtual void Close() = 0;
 
+  /**
+   * 发送完队列中的数据后再关闭
+   *
+   * @brief 调用后不再处理新读到的数据，发送队列为空时立即关闭，用于停服时不丢弃已经产生的回复
+   */
+  virtual void CloseAfterFlush() = 0;
+
+  /// 发送队列中还未发送的字节数
+  virtual std::size_t GetWriteQueueSize() = 0;
+
+  /**
+   * 设置发送队列的高低水位
+   *
+   * @brief 未发送的数据达到高水位时触发水位回调(true)，回落到低水位时再触发一次(false)
+   * @param high 高水位，0 表示不检查
+   * @param low 低水位
+   * @param pauseRead 超过高水位时是否暂停读取，直到回落到低水位
+   */
+  virtual void SetWriteWatermark(std::size_t high, std::size_t low, bool pauseRead = false) final;
+
+  /// 水位回调函数类型，参数为 true 表示超过高水位，false 表示回落到低水位
+  using WatermarkHandler = std::function<void(bool)>;
+
+  /// 设置水位回调函数
+  virtual void SetWatermarkHandler(WatermarkHandler&& handle) final;
+
+  /// 获取水位回调函数
+  virtual WatermarkHandler& GetWatermarkHandler() final;
+
   /// 数据可读回调函数类型
   using ReadHandler = std::function<std::size_t(const char*, std::size_t)>;
 
@@ -71,10 +150,32 @@ class SocketIf : public boost::asio::ip::tcp::socket {
   /// 获取关闭回调函数
   virtual CloseHandler& GetCloseHandler() final;
 
+  /**
+   * 添加额外的关闭回调函数
+   *
+   * @note 关闭回调函数由链接管理类占用，其他需要感知链接关闭的模块(如重连)通过这里添加，
+   *       在关闭回调函数之后依次调用
+   */
+  virtual void AddCloseListener(CloseHandler&& handle) final;
+
+  /// 获取额外的关闭回调函数
+  virtual std::vector<CloseHandler>& GetCloseListeners() final;
+
+ protected:
+  std::size_t highWatermark_{0};
+  std::size_t lowWatermark_{0};
+  bool pauseReadOnHigh_{false};
+
  private:
-  uint32_t id_{0};
+  uint64_t id_{0};
+  uint32_t group_{0};
+  bamboo::concurrency::Executor executor_;
+  /// 所在io的负载，用于统计链接数
+  bamboo::aio::IoLoad* load_{nullptr};
   ReadHandler reader_;
   CloseHandler closer_;
+  std::vector<CloseHandler> listeners_;
+  WatermarkHandler watermarker_;
 };
 
 using SocketPtr = std::shared_ptr<SocketIf>;
@@ -0,0 +1,186 @@
+#pragma once
+
+#include <deque>
+#include <unordered_map>
+#include <vector>
+
+#include <boost/utility/string_view.hpp>
+
+#include <bamboo/define.hpp>
+#include <bamboo/protocol/protocolif.hpp>
+
+namespace bamboo {
+namespace protocol {
+
+class HttpProtocol;
+
+/**
+ * http 请求
+ *
+ * @brief 所有字段都直接指向socket的读缓冲区，不拷贝数据，只在处理函数中有效，
+ *        需要保存时由业务层自己复制
+ */
+struct HttpRequest {
+  /// 请求头
+  struct Header {
+    boost::string_view name;
+    boost::string_view value;
+  };
+
+  boost::string_view method;
+  boost::string_view target; /**< 完整的请求目标，包含查询参数 */
+  boost::string_view path;   /**< 不包含查询参数的路径 */
+  boost::string_view query;  /**< ? 之后的查询参数 */
+  int minorVersion{1};       /**< HTTP/1.x 的 x */
+  std::vector<Header> headers;
+  boost::string_view body;
+  bool keepAlive{true};
+
+  /**
+   * 查找请求头，名称不区分大小写
+   * @return 请求头的值，不存在时为空
+   */
+  boost::string_view Get(boost::string_view name) const;
+
+  /**
+   * 逗号分隔的请求头中是否包含某一项，如 Connection: keep-alive, Upgrade
+   * @param name 请求头名称，同名的请求头都会检查
+   * @param token 查找的项，不区分大小写
+   */
+  bool HasToken(boost::string_view name, boost::string_view token) const;
+};
+
+/**
+ * http 回复
+ *
+ * @brief 同一个链接上流水线的多个请求按请求的顺序回复。回复对象可以保存下来异步完成，
+ *        排在前面的回复完成前，后面回复的数据先缓存起来。
+ *        Send 一次发送完整的回复；WriteChunk 使用 chunked 编码分多次发送，最后调用 End 结束
+ */
+class HttpResponse : public std::enable_shared_from_this<HttpResponse> {
+ public:
+  /// 设置状态码，reason 为空时使用标准的描述
+  void SetStatus(int status, const char* reason = nullptr);
+
+  /// 添加回复头，Content-Length、Transfer-Encoding、Connection 由协议生成
+  void AddHeader(const std::string& name, const std::string& value);
+
+  /// 发送完整的回复
+  void Send(const char* data, std::size_t size);
+
+  /// 发送完整的回复
+  void Send(const std::string& body) { Send(body.data(), body.size()); }
+
+  /// 发送一段 chunked 编码的内容，第一次调用时发送回复头
+  void WriteChunk(const char* data, std::size_t size);
+
+  /// 结束 chunked 回复
+  void End();
+
+  /// 回复是否已经完成
+  bool Finished() const { return finished_; }
+
+  /// 回复完成后是否关闭链接
+  bool KeepAlive() const { return keepAlive_; }
+
+  /// 让回复完成后关闭链接
+  void SetClose() { keepAlive_ = false; }
+
+ private:
+  friend class HttpProtocol;
+
+  struct Connection;
+
+  HttpResponse(std::weak_ptr<Connection> connection, bool keepAlive, bool head, int minorVersion);
+
+  /**
+   * 生成状态行和回复头
+   * @param out 输出位置
+   * @param length 内容长度，chunked 时不使用
+   */
+  void WriteHead(std::string& out, std::size_t length);
+
+  /// 输出数据，排在前面的回复完成前先缓存
+  void Output(std::unique_ptr<std::string>&& data);
+
+  void Finish();
+
+  std::weak_ptr<Connection> connection_;
+  std::string headers_;   /**< 业务层添加的回复头 */
+  std::string pending_;   /**< 轮到这个回复之前缓存的数据 */
+  int status_{200};
+  const char* reason_{nullptr};
+  bool keepAlive_;
+  bool headOnly_;         /**< HEAD 请求，不发送内容 */
+  int minorVersion_;
+  bool headSent_{false};
+  bool chunked_{false};
+  bool finished_{false};
+};
+
+using HttpResponsePtr = std::shared_ptr<HttpResponse>;
+
+/**
+ * http/1.1 服务端协议
+ *
+ * @brief 直接在socket的读缓冲区上增量解析，请求头不完整时留在读缓冲区里等待更多数据，
+ *        一次读回调中的多个流水线请求依次处理。支持 keep-alive，HTTP/1.0 默认关闭链接。
+ *        处理函数在链接所属服务的执行器上运行
+ *
+ * @note 请求内容只支持 Content-Length，chunked 编码的请求回复 501 后关闭链接
+ * @see bamboo::protocol::ProtocolIf
+ */
+class HttpProtocol : public bamboo::protocol::ProtocolIf {
+ public:
+  /// 处理函数类型
+  using Handler = std::function<void(bamboo::net::SocketPtr, const HttpRequest&, HttpResponsePtr)>;
+
+  /// 请求头的最大长度
+  static const std::size_t MAX_HEADER = 1024 * 8;
+
+  /// 一个链接上等待回复的最大请求数量，超过后回复 503 并关闭链接
+  static const std::size_t MAX_PIPELINE = 256;
+
+  HttpProtocol();
+  virtual ~HttpProtocol();
+
+  std::size_t ReceiveData(bamboo::net::SocketPtr so, const char* data, std::size_t size) override;
+
+  void OnConnect(bamboo::net::SocketPtr so) override;
+
+  void OnClose(bamboo::net::SocketPtr so) override;
+
+  /**
+   * 注册路径的处理函数
+   * @param path 完整匹配的路径，不包含查询参数
+   * @param handler 处理函数
+   */
+  virtual void Handle(const std::string& path, Handler&& handler) final;
+
+  /// 设置没有匹配到路径时的处理函数，默认回复 404
+  virtual void SetDefaultHandler(Handler&& handler) final;
+
+  /// 设置请求内容的最大长度，超过时回复 413 后关闭链接，不能超过socket的读缓冲区上限
+  virtual void SetMaxBody(std::size_t size) final;
+
+  /**
+   * 解析一个请求
+   * @param maxBody 请求内容的最大长度
+   * @return 请求的总长度，0 为数据不足，-1 为格式错误，其他负数为对应的错误状态码
+   */
+  static long Parse(const char* data, std::size_t size, HttpRequest& request, std::size_t maxBody);
+
+ private:
+  /// 回复错误并关闭链接
+  void Reject(const std::shared_ptr<HttpResponse::Connection>& connection, int status);
+
+  std::unordered_map<std::string, Handler> handlers_;
+  Handler default_;
+  std::size_t maxBody_{1024 * 256};
+  std::unordered_map<uint64_t, std::shared_ptr<HttpResponse::Connection>> connections_;
+  /// 复用的请求对象，避免每个请求都申请请求头列表
+  HttpRequest request_;
+};
+
+}
+}
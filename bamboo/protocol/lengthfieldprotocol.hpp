@@ -0,0 +1,106 @@
+#pragma once
+
+#include <vector>
+
+#include <bamboo/define.hpp>
+#include <bamboo/protocol/protocolif.hpp>
+
+namespace bamboo {
+namespace protocol {
+
+/**
+ * 长度字段分帧协议
+ *
+ * @brief 每帧由长度头和内容组成，长度头可以是固定字节数的整数，也可以是 varint。
+ *        一次读回调中所有完整的帧一起交给处理函数，帧直接指向socket的读缓冲区，不拷贝数据；
+ *        不完整的部分留在socket的读缓冲区中，等下次数据到达后再解析
+ *
+ * @note 不完整的帧需要放得下socket的读缓冲区，maxFrame 不能超过 bamboo::net::Socket 的读缓冲区上限
+ * @see bamboo::protocol::ProtocolIf
+ */
+class LengthFieldProtocol : public bamboo::protocol::ProtocolIf {
+ public:
+  /// 长度头的编码方式
+  enum class LengthType {
+    FIXED,  /**< 固定字节数的无符号整数 */
+    VARINT, /**< 每字节7位、低位在前的变长整数，和 protobuf 的 varint 相同 */
+  };
+
+  /// 固定长度头的字节序
+  enum class ByteOrder {
+    BIG,
+    LITTLE,
+  };
+
+  /// 分帧配置
+  struct Option {
+    LengthType type{LengthType::FIXED};
+    std::size_t fieldSize{4};             /**< 固定长度头的字节数，只能是 1、2、4、8 */
+    ByteOrder order{ByteOrder::BIG};      /**< 固定长度头的字节序 */
+    std::size_t maxFrame{256 * 1024};     /**< 单帧内容的最大长度，超过时关闭链接 */
+    bool includeHeader{false};            /**< 长度字段的值是否包含长度头本身 */
+  };
+
+  /// 一帧的内容，不包含长度头，只在处理函数中有效
+  struct Frame {
+    const char* data;
+    std::size_t size;
+  };
+
+  /// 帧处理函数类型，一次传入本次读到的所有完整帧
+  using FrameHandler = std::function<void(bamboo::net::SocketPtr, const std::vector<Frame>&)>;
+
+  /// 使用默认配置：4字节大端长度头
+  LengthFieldProtocol();
+
+  explicit LengthFieldProtocol(const Option& option);
+
+  virtual ~LengthFieldProtocol();
+
+  std::size_t ReceiveData(bamboo::net::SocketPtr so, const char* data, std::size_t size) override;
+
+  /// 设置帧处理函数
+  virtual void SetFrameHandler(FrameHandler&& handler) final;
+
+  /// 获取配置
+  virtual const Option& GetOption() const final;
+
+  /**
+   * 编码长度头
+   * @param size 帧内容的长度
+   * @param out 输出位置，至少 MAX_HEADER 字节
+   * @return 长度头的字节数
+   */
+  virtual std::size_t EncodeHeader(std::size_t size, char* out) const final;
+
+  /**
+   * 生成带长度头的一帧
+   * @param data 帧内容
+   * @param size 内容长度
+   * @return 编码后的数据
+   */
+  virtual std::unique_ptr<std::string> Encode(const char* data, std::size_t size) const final;
+
+  /// 给链接发送一帧
+  virtual void Send(const bamboo::net::SocketPtr& so, const char* data, std::size_t size) const final;
+
+  /// 长度头的最大字节数
+  static const std::size_t MAX_HEADER = 10;
+
+ private:
+  /**
+   * 解析长度头
+   * @param length 输出帧内容的长度
+   * @param header 输出长度头的字节数
+   * @return 1 为解析成功，0 为数据不足，-1 为格式错误
+   */
+  int DecodeHeader(const char* data, std::size_t size, uint64_t& length, std::size_t& header) const;
+
+  Option option_;
+  FrameHandler handler_;
+  /// 复用的帧列表，避免每次读回调都申请内存
+  std::vector<Frame> frames_;
+};
+
+}
+}
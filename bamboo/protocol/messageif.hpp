@@ -1,22 +1,53 @@
 #pragma once
 
 #include <memory>
+#include <string>
+
+#include <bamboo/define.hpp>
 
 namespace bamboo {
 namespace protocol {
 
 /**
  * 消息基类
+ *
+ * @brief 实现 EncodedSize 和 SerializeTo 的消息在发送时直接编码到线程的内存板上，
+ *        不需要为每条消息申请内存；只实现 Build 的消息每次生成一个新的字符串
+ *
+ * @note 子类必须实现两种方式之一，都没有实现时默认的 Build 会断言失败
+ *
+ * @see bamboo::buffer::SlabPool
  */
 class MessageIf {
  public:
+  virtual ~MessageIf() {}
 
   /**
    * 生成数据对象
-   * @return 二进制数据的共享指针对象
+   *
+   * @note 默认通过 EncodedSize 和 SerializeTo 生成，没有实现直接编码的子类必须重写
+   * @return 二进制数据
+   */
+  virtual std::unique_ptr<std::string> Build() {
+    std::size_t size = EncodedSize();
+    BB_ASSERT(size > 0);
+    std::unique_ptr<std::string> buffer(new std::string(size, '\0'));
+    if (size > 0) SerializeTo(&(*buffer)[0]);
+    return buffer;
+  }
+
+  /**
+   * 编码后的长度
+   * @return 0 表示不支持直接编码，发送时使用 Build
    */
-  virtual std::unique_ptr<std::string> Build() = 0;
+  virtual std::size_t EncodedSize() const { return 0; }
+
+  /**
+   * 编码到指定的内存
+   * @param out 写入位置，长度为 EncodedSize 的返回值
+   */
+  virtual void SerializeTo(char* out) const {}
 };
 
 }
-}
\ No newline at end of file
+}
@@ -27,6 +27,18 @@ class ProtocolIf {
    */
   virtual std::size_t ReceiveData(bamboo::net::SocketPtr socket, const char* data, std::size_t size) = 0;
 
+  /**
+   * 新链接建立，链接管理类在开始读数据前调用，默认不处理
+   * @param socket 新链接
+   */
+  virtual void OnConnect(bamboo::net::SocketPtr socket);
+
+  /**
+   * 链接关闭，默认不处理
+   * @param socket 关闭的链接
+   */
+  virtual void OnClose(bamboo::net::SocketPtr socket);
+
 };
 
 using ProtocolPtr = std::shared_ptr<ProtocolIf>;
@@ -0,0 +1,154 @@
+#pragma once
+
+#include <chrono>
+#include <unordered_map>
+#include <unordered_set>
+
+#include <bamboo/define.hpp>
+#include <bamboo/net/connectionpool.hpp>
+#include <bamboo/protocol/lengthfieldprotocol.hpp>
+#include <bamboo/schedule/scheduler.hpp>
+
+namespace bamboo {
+namespace protocol {
+
+/**
+ * 多路复用的rpc协议
+ *
+ * @brief 基于 LengthFieldProtocol 分帧，每个请求带有请求id，同一个链接上可以同时有任意多个请求，
+ *        回复可以乱序返回，按请求id找到对应的回调。同一个协议对象既可以作为服务端注册方法，
+ *        也可以作为客户端发起调用，链接两端可以互相调用。
+ *        请求和回复的内容是不透明的二进制数据，业务层可以放入 protobuf 等任意序列化格式。
+ *
+ *        请求帧：[类型 1][请求id 8][超时毫秒 4][方法名长度 1][方法名][内容]
+ *        回复帧：[类型 1][请求id 8][状态 1][内容]
+ *        整数都是大端
+ *
+ * @note 所有接口都必须在链接所属服务的执行器上调用，超时由构造时传入的调度器计时
+ * @see bamboo::protocol::LengthFieldProtocol
+ */
+class RpcProtocol : public bamboo::protocol::ProtocolIf,
+                    public std::enable_shared_from_this<RpcProtocol> {
+ public:
+  /// 调用结果
+  enum class Status : uint8_t {
+    OK = 0,        /**< 成功 */
+    NO_METHOD = 1, /**< 服务端没有注册这个方法 */
+    FAILED = 2,    /**< 服务端处理失败，内容为错误信息 */
+    TIMEOUT = 3,   /**< 超过调用的超时时间没有收到回复 */
+    CLOSED = 4,    /**< 收到回复前链接已经关闭 */
+  };
+
+  /// 服务端收到的请求，内容只在方法处理函数中有效
+  struct Request {
+    uint64_t id;
+    const char* method;
+    std::size_t methodSize;
+    const char* data;
+    std::size_t size;
+    /// 客户端的超时时间点，客户端不限时为 time_point::max()
+    std::chrono::steady_clock::time_point deadline;
+
+    /// 是否已经超过客户端的超时时间，超时后的回复会被丢弃
+    bool Expired() const { return std::chrono::steady_clock::now() >= deadline; }
+  };
+
+  /**
+   * 回复函数类型，可以保存下来在之后异步回复，只有第一次调用有效。
+   * 链接已经关闭或者请求已经超时时不发送
+   */
+  using Reply = std::function<void(Status, const char*, std::size_t)>;
+
+  /// 方法处理函数类型
+  using MethodHandler = std::function<void(bamboo::net::SocketPtr, const Request&, Reply)>;
+
+  /// 调用结果的回调函数类型，内容只在回调中有效
+  using ResponseHandler = std::function<void(Status, const char*, std::size_t)>;
+
+  /**
+   * 构造函数
+   * @param scheduler 计算调用超时的调度器，一般为所属服务的调度器
+   * @param option 分帧配置
+   */
+  explicit RpcProtocol(bamboo::schedule::Scheduler& scheduler,
+                       const LengthFieldProtocol::Option& option = LengthFieldProtocol::Option());
+
+  virtual ~RpcProtocol();
+
+  std::size_t ReceiveData(bamboo::net::SocketPtr so, const char* data, std::size_t size) override;
+
+  void OnClose(bamboo::net::SocketPtr so) override;
+
+  /**
+   * 注册方法
+   * @param method 方法名，不超过255字节
+   * @param handler 处理函数
+   */
+  virtual void Register(const std::string& method, MethodHandler&& handler) final;
+
+  /**
+   * 发起调用，不需要等待上一个调用返回
+   * @param so 链接，必须属于创建了这个协议的链接管理类
+   * @param method 方法名
+   * @param data 请求内容
+   * @param size 内容长度
+   * @param handler 结果回调，每个调用只回调一次
+   * @param timeout 超时毫秒数，0 表示不限时
+   * @return 是否发出请求，失败时不会回调
+   */
+  virtual bool Call(const bamboo::net::SocketPtr& so, const std::string& method, const char* data, std::size_t size,
+                    ResponseHandler&& handler, std::time_t timeout = 0) final;
+
+  /**
+   * 在连接池中选择在途请求最少的链接发起调用
+   *
+   * @brief 配合服务发现使用时，为每个发现的服务地址创建一个 bamboo::net::ConnectionPool，
+   *        连接池的链接管理类通过 CreateProtocol 创建这个协议，所有连接池共用它发起调用
+   * @see Call
+   */
+  virtual bool Call(const bamboo::net::ConnectionPoolPtr& pool, const std::string& method, const char* data,
+                    std::size_t size, ResponseHandler&& handler, std::time_t timeout = 0) final;
+
+  /// 等待回复的调用数量
+  virtual std::size_t GetPendingSize() const final;
+
+ private:
+  enum class Type : uint8_t {
+    REQUEST = 1,
+    RESPONSE = 2,
+  };
+
+  static const std::size_t REQUEST_HEAD = 1 + 8 + 4 + 1;
+  static const std::size_t RESPONSE_HEAD = 1 + 8 + 1;
+
+  struct Pending {
+    uint64_t socket{0};
+    ResponseHandler handler;
+    bamboo::schedule::Scheduler::ID timer{0};
+  };
+
+  void HandleFrames(const bamboo::net::SocketPtr& so, const std::vector<LengthFieldProtocol::Frame>& frames);
+  void HandleRequest(const bamboo::net::SocketPtr& so, const char* data, std::size_t size);
+  void HandleResponse(const bamboo::net::SocketPtr& so, const char* data, std::size_t size);
+
+  /// 调用结束，从等待列表中移除并回调
+  void Finish(uint64_t id, Status status, const char* data, std::size_t size);
+
+  /// 组装一帧并发送，head 为帧内容的固定头部
+  void Send(const bamboo::net::SocketPtr& so, const char* head, std::size_t headSize,
+            const char* data, std::size_t size);
+
+  /// 发送回复
+  void Respond(const bamboo::net::SocketPtr& so, uint64_t id, Status status, const char* data, std::size_t size);
+
+  bamboo::schedule::Scheduler& scheduler_;
+  LengthFieldProtocol framer_;
+  std::unordered_map<std::string, MethodHandler> methods_;
+  std::unordered_map<uint64_t, Pending> pending_;
+  /// 每个链接上等待回复的请求id，链接关闭时一起失败
+  std::unordered_map<uint64_t, std::unordered_set<uint64_t>> inflight_;
+  uint64_t nextId_{0};
+};
+
+}
+}
@@ -0,0 +1,198 @@
+#pragma once
+
+#include <unordered_map>
+
+#include <bamboo/define.hpp>
+#include <bamboo/net/connmanagerif.hpp>
+#include <bamboo/protocol/httpprotocol.hpp>
+
+namespace boost {
+namespace beast {
+namespace zlib {
+class deflate_stream;
+}
+}
+}
+
+namespace bamboo {
+namespace protocol {
+
+/**
+ * websocket 服务端协议
+ *
+ * @brief 链接建立后先按 http 解析升级请求，握手成功后在socket的读缓冲区上增量解析帧，
+ *        不完整的帧留在读缓冲区里等待更多数据。分片的消息合并后再交给处理函数，
+ *        ping 自动回复 pong，收到 close 后回复 close 并在发送完后关闭链接。
+ *        支持 permessage-deflate 扩展，服务端固定使用 server_no_context_takeover，
+ *        每条消息独立压缩，同一份压缩后的帧可以广播给所有协商了压缩的链接
+ *
+ * @note 单帧需要放得下socket的读缓冲区，maxMessage 不能超过 bamboo::net::Socket 的读缓冲区上限。
+ *       协议的所有接口都要在链接所属服务的执行器上调用
+ * @see bamboo::protocol::ProtocolIf
+ */
+class WebSocketProtocol : public bamboo::protocol::ProtocolIf {
+ public:
+  /// 帧类型
+  enum class Opcode : uint8_t {
+    CONTINUATION = 0x0,
+    TEXT = 0x1,
+    BINARY = 0x2,
+    CLOSE = 0x8,
+    PING = 0x9,
+    PONG = 0xa,
+  };
+
+  /// 协议配置
+  struct Option {
+    std::string path;                   /**< 只接受这个路径的升级请求，为空时不检查 */
+    std::size_t maxMessage{256 * 1024}; /**< 单条消息的最大长度，压缩的消息按解压后计算，超过时关闭链接 */
+    bool deflate{true};                 /**< 是否接受 permessage-deflate */
+    std::size_t deflateThreshold{256};  /**< 小于这个长度的消息不压缩 */
+    int deflateLevel{6};                /**< 压缩等级 */
+    int windowBits{15};                 /**< 服务端压缩的窗口大小，9 到 15 */
+  };
+
+  /// 升级请求的处理函数类型，返回 false 时拒绝握手
+  using AcceptHandler = std::function<bool(bamboo::net::SocketPtr, const HttpRequest&)>;
+
+  /// 消息处理函数类型，opcode 为 TEXT 或 BINARY，数据只在处理函数中有效
+  using MessageHandler = std::function<void(bamboo::net::SocketPtr, Opcode, const char*, std::size_t)>;
+
+  /// 握手成功后的链接关闭时的处理函数类型，code 为关闭码，没有收到 close 时为 1006
+  using CloseHandler = std::function<void(bamboo::net::SocketPtr, uint16_t)>;
+
+  /// 最长的帧头
+  static const std::size_t MAX_HEADER = 14;
+
+  WebSocketProtocol();
+
+  explicit WebSocketProtocol(const Option& option);
+
+  virtual ~WebSocketProtocol();
+
+  std::size_t ReceiveData(bamboo::net::SocketPtr so, const char* data, std::size_t size) override;
+
+  void OnConnect(bamboo::net::SocketPtr so) override;
+
+  void OnClose(bamboo::net::SocketPtr so) override;
+
+  /// 设置升级请求的处理函数，不设置时接受所有请求
+  virtual void SetAcceptHandler(AcceptHandler&& handler) final;
+
+  /// 设置消息处理函数
+  virtual void SetMessageHandler(MessageHandler&& handler) final;
+
+  /// 设置关闭处理函数
+  virtual void SetCloseHandler(CloseHandler&& handler) final;
+
+  /// 获取配置
+  virtual const Option& GetOption() const final;
+
+  /**
+   * 发送一条消息
+   * @param so 已经握手成功的链接
+   * @param opcode 帧类型
+   * @param data 消息内容
+   * @param size 消息长度
+   * @return 链接不是握手成功的状态时返回 false
+   */
+  virtual bool Send(bamboo::net::SocketPtr so, Opcode opcode, const char* data, std::size_t size) final;
+
+  /**
+   * 发送 close 后关闭链接
+   * @param so 链接
+   * @param code 关闭码
+   * @param reason 关闭原因，不超过123字节
+   */
+  virtual void Close(bamboo::net::SocketPtr so, uint16_t code = 1000, const std::string& reason = "") final;
+
+  /**
+   * 广播一条消息给管理类下握手成功的链接
+   *
+   * @brief 消息只编码一次，没有压缩和压缩的帧各一份，所有链接共用
+   * @param manager 链接管理类，必须是创建这个协议的管理类
+   * @param opcode 帧类型
+   * @param data 消息内容
+   * @param size 消息长度
+   * @param filter 过滤函数，为空时发给所有链接
+   * @return 发送的链接数量
+   */
+  virtual std::size_t Broadcast(bamboo::net::ConnManagerIf& manager, Opcode opcode, const char* data,
+                                std::size_t size, bamboo::net::ConnManagerIf::SocketFilter&& filter = nullptr) final;
+
+  /**
+   * 编码一个服务端发送的完整帧
+   * @param opcode 帧类型
+   * @param data 消息内容
+   * @param size 消息长度
+   * @param compress 是否使用 permessage-deflate 压缩，只对 TEXT 和 BINARY 有效
+   * @return 编码后的帧
+   */
+  virtual bamboo::net::ConstBufferPtr Encode(Opcode opcode, const char* data, std::size_t size, bool compress) final;
+
+  /// 链接是否已经握手成功
+  virtual bool IsOpen(const bamboo::net::SocketPtr& so) const final;
+
+  /// 握手成功的链接数量
+  virtual std::size_t GetOpenSize() const final;
+
+  /**
+   * 计算握手回复中的 Sec-WebSocket-Accept
+   * @param key 请求中的 Sec-WebSocket-Key
+   */
+  static std::string AcceptKey(boost::string_view key);
+
+  /**
+   * 掩码异或，可以原地处理
+   * @param dst 输出位置
+   * @param src 输入数据
+   * @param size 长度
+   * @param key 4字节掩码
+   * @param offset 数据在整个帧内容中的偏移，用于对齐掩码
+   */
+  static void Unmask(char* dst, const char* src, std::size_t size, const char* key, std::size_t offset = 0);
+
+ private:
+  struct Connection;
+  using ConnectionPtr = std::shared_ptr<Connection>;
+
+  /// 处理升级请求，返回消耗的长度
+  std::size_t Handshake(const bamboo::net::SocketPtr& so, Connection& connection, const char* data, std::size_t size);
+
+  /// 拒绝升级请求并关闭链接
+  void Reject(const bamboo::net::SocketPtr& so, int status, const char* extra = "");
+
+  /// 解析帧，返回消耗的长度
+  std::size_t ReadFrames(const bamboo::net::SocketPtr& so, Connection& connection, const char* data, std::size_t size);
+
+  /// 收到完整的消息
+  bool Deliver(const bamboo::net::SocketPtr& so, Connection& connection);
+
+  /// 协议错误，发送 close 后关闭链接
+  void Fail(const bamboo::net::SocketPtr& so, Connection& connection, uint16_t code);
+
+  /// 生成帧，compress 时内容已经压缩过
+  void EncodeTo(std::string& out, Opcode opcode, const char* data, std::size_t size, bool compressed) const;
+
+  /// 压缩一条消息
+  void Deflate(const char* data, std::size_t size, std::string& out);
+
+  /// 在某个链接上是否需要压缩这条消息
+  bool ShouldCompress(const Connection& connection, Opcode opcode, std::size_t size) const;
+
+  Option option_;
+  AcceptHandler acceptor_;
+  MessageHandler messenger_;
+  CloseHandler closer_;
+  std::unordered_map<uint64_t, ConnectionPtr> connections_;
+  std::size_t openSize_{0};
+  /// 所有链接共用的压缩流，每条消息前重置
+  std::unique_ptr<boost::beast::zlib::deflate_stream> deflater_;
+  /// 复用的请求对象
+  HttpRequest request_;
+  /// 复用的压缩缓冲区
+  std::string deflated_;
+};
+
+}
+}
@@ -1,19 +1,37 @@
 #pragma once
 
 #include <map>
+#include <memory>
 #include <functional>
 #include <bamboo/define.hpp>
+#include <bamboo/concurrency/executor.hpp>
+#include <bamboo/schedule/timingwheel.hpp>
 
 namespace bamboo {
 namespace schedule {
 
 /**
  * 调度器
+ *
+ * @brief 支持两种实现：
+ *        TIMER 每个调度单独使用一个 steady_timer，适合数量少、精度要求高的调度；
+ *        WHEEL 所有调度放在分层时间轮上，只用一个 steady_timer 驱动，精度为1毫秒，
+ *        插入和取消都是 O(1)，适合大量的链接超时、请求超时
  */
 class Scheduler final : public std::enable_shared_from_this<Scheduler> {
  public:
-  /// 默认的构造函数
-  Scheduler(boost::asio::io_context&);
+  /// 调度器实现
+  enum class Engine {
+    TIMER, /**< 每个调度一个定时器 */
+    WHEEL, /**< 分层时间轮 */
+  };
+
+  /**
+   * 构造函数
+   * @param io io
+   * @param engine 调度器实现
+   */
+  Scheduler(boost::asio::io_context& io, Engine engine = Engine::TIMER);
 
   /// 默认的析构函数
   virtual ~Scheduler();
@@ -40,13 +58,26 @@ class Scheduler final : public std::enable_shared_from_this<Scheduler> {
    */
   ID Heartbeat(Handler&& handler, std::time_t millisecond);
 
-  /// 取消调度
+  /// 取消调度，可以在回调函数中调用
   void Cancel(ID id);
 
+  /// 调度器实现
+  Engine GetEngine() const { return engine_; }
+
+  /// 调度数量
+  std::size_t Size() const;
+
+  /**
+   * 设置回调的执行器，服务使用 strand 时由服务设置，
+   * 之后注册的调度和服务的其他回调串行执行
+   */
+  void SetExecutor(const bamboo::concurrency::Executor& executor);
+
  private:
   /// 生成新ID
   ID GenId();
   boost::asio::io_context& io_;
+  bamboo::concurrency::Executor executor_;
 
   struct ScheduleInfo {
     bool isCycle{false};
@@ -62,6 +93,18 @@ class Scheduler final : public std::enable_shared_from_this<Scheduler> {
 
   std::map<uint64_t, std::shared_ptr<ScheduleInfo>> maps_;
   ID id_{0};
+
+  /// 时间轮启动后经过的毫秒数
+  uint64_t Elapsed() const;
+  /// 按时间轮上最近的刻度设置定时器
+  void ArmWheel();
+  void HandleWheel(const boost::system::error_code& ec);
+
+  Engine engine_;
+  std::unique_ptr<TimingWheel> wheel_;
+  std::unique_ptr<boost::asio::steady_timer> tick_;
+  std::chrono::steady_clock::time_point start_;
+  uint64_t armed_{0}; /**< 定时器设置的刻度，0 为未设置 */
 };
 
 }
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace bamboo {
+namespace schedule {
+
+/**
+ * 分层时间轮
+ *
+ * @brief 4层，每层256个槽位，第0层每个槽位为1个刻度，上一层的槽位是下一层的一整圈。
+ *        插入和取消都是 O(1)，节点放在连续的节点池里复用，不会为每个定时器单独申请内存。
+ *        时间轮本身不计时，由调用方通过 Advance 推进刻度
+ */
+class TimingWheel final {
+ public:
+  /// 定时器Id，0为无效Id
+  using ID = uint64_t;
+
+  /// 回调类型
+  using Handler = std::function<void()>;
+
+  TimingWheel();
+  ~TimingWheel();
+
+  TimingWheel(const TimingWheel&) = delete;
+  TimingWheel& operator=(const TimingWheel&) = delete;
+
+  /**
+   * 添加定时器
+   * @param handler 回调函数
+   * @param delay 延迟的刻度数，至少为1
+   * @param interval 循环的刻度数，0 表示只执行一次
+   * @return 定时器Id
+   */
+  ID Add(Handler&& handler, uint64_t delay, uint64_t interval = 0);
+
+  /**
+   * 取消定时器，可以在回调函数中调用
+   * @param id 定时器Id
+   * @return 定时器是否存在
+   */
+  bool Cancel(ID id);
+
+  /**
+   * 推进刻度，执行到期的定时器
+   * @param ticks 推进的刻度数
+   * @return 执行的回调数量
+   */
+  std::size_t Advance(uint64_t ticks);
+
+  /// 距离下一个需要处理的刻度数(有到期的槽位或者需要降级上层节点)，时间轮为空时返回0
+  uint64_t NextTick() const;
+
+  /// 当前的刻度
+  uint64_t Now() const { return current_; }
+
+  /// 定时器数量
+  std::size_t Size() const { return size_; }
+
+ private:
+  static const std::size_t LEVELS = 4;
+  static const std::size_t SLOT_BITS = 8;
+  static const std::size_t SLOTS = 1 << SLOT_BITS;
+  static const uint32_t NIL = 0xFFFFFFFF;
+
+  /// 节点所在链表：时间轮槽位，正在执行的链表，或者空闲
+  enum class Place : uint8_t { WHEEL, FIRING, FREE };
+
+  struct Node {
+    Handler handler;
+    uint64_t expire{0};
+    uint64_t interval{0};
+    uint32_t generation{1};
+    uint32_t prev{NIL};
+    uint32_t next{NIL};
+    uint16_t slot{0};
+    Place place{Place::FREE};
+    bool running{false};
+    bool cancelled{false};
+  };
+
+  uint32_t AllocNode();
+  void FreeNode(uint32_t index);
+  void Insert(uint32_t index);
+  void Unlink(uint32_t index);
+  void PushFront(uint32_t& head, uint32_t index);
+  void Cascade(std::size_t level);
+  std::size_t Fire(uint32_t& list);
+  uint32_t& Head(const Node& node);
+  void Mark(std::size_t slot, bool occupied);
+
+  std::array<std::array<uint32_t, SLOTS>, LEVELS> wheels_;
+  std::array<uint64_t, SLOTS / 64> occupied_; /**< 第0层槽位的占用位图 */
+  std::vector<Node> nodes_;
+  uint32_t free_{NIL};
+  uint32_t firing_{NIL};
+  uint64_t current_{0};
+  std::size_t size_{0};
+};
+
+}
+}
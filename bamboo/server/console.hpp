@@ -36,7 +36,7 @@ class Console : public ServerIf {
 
   /**
    * 注册命令
-   * @param cmd 命令，help 和 log 为默认命令，就算注册了也不会生效
+   * @param cmd 命令，help、log 和 io 为默认命令，就算注册了也不会生效
    * @param handler 命令处理函数
    * @param help 帮助信息
    */
@@ -51,6 +51,7 @@ class Console : public ServerIf {
   virtual std::size_t readData(bamboo::net::SocketPtr, const char*, std::size_t) final;
   virtual std::string Cmd_Help(std::vector<std::string>& args) final;
   virtual std::string Cmd_Log(std::vector<std::string>& args) final;
+  virtual std::string Cmd_Io(std::vector<std::string>& args) final;
 
   struct CmdInfo {
     std::string cmd;
@@ -61,6 +62,7 @@ class Console : public ServerIf {
 
   CmdInfo logCmd_;
   CmdInfo helpCmd_;
+  CmdInfo ioCmd_;
 
   std::string address_;
   uint16_t port_{0};
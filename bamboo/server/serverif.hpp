@@ -35,6 +35,23 @@ class ServerIf {
   /// 服务关闭函数
   virtual void Stop() final;
 
+  /**
+   * 开始停服排空
+   *
+   * @brief 关闭监听和保持连接，已经建立的链接继续处理，之后调用 DrainHandle
+   * @see bamboo::aio::AioIf::Drain
+   */
+  virtual void Drain() final;
+
+  /// 监听助手接入的链接数量
+  virtual std::size_t GetAcceptedSize() final;
+
+  /// 所有链接的数量，包括链接助手建立的链接
+  virtual std::size_t GetConnectionSize() final;
+
+  /// 所有链接发送完队列中的数据后关闭
+  virtual void CloseAfterFlush() final;
+
   /// 服务所处的io索引
   virtual std::size_t GetIoIndex() const final;
 
@@ -61,6 +78,7 @@ class ServerIf {
     std::shared_ptr<ACCEPTOR> ptr;
     try {
       ptr.reset(new ACCEPTOR(io_, std::forward<ARGS>(args)...));
+      ptr->executor_ = executor_;
       ptr->SetAddress(std::move(address), port);
     } catch (std::exception& e) {
       BB_ERROR_LOG("CreateAcceptor fail:%s", e.what());
@@ -87,6 +105,8 @@ class ServerIf {
     std::shared_ptr<CONNECTOR> ptr;
     try {
       ptr.reset(new CONNECTOR(io_, std::forward<ARGS>(args)...));
+      ptr->scheduler_ = scheduler_.get();
+      ptr->executor_ = executor_;
     } catch (std::exception& e) {
       BB_ERROR_LOG("CreateConnector fail:%s", e.what());
       return nullptr;
@@ -100,6 +120,14 @@ class ServerIf {
   /// 获取调度管理类
   virtual bamboo::schedule::Scheduler& GetScheduler() final;
 
+  /**
+   * 获取服务的执行器
+   *
+   * @brief 监听、链接、调度的回调都在这个执行器上执行。
+   *        共享模式下带有服务独占的 strand，其他模式下直接在io上执行
+   */
+  virtual const bamboo::concurrency::Executor& GetExecutor() const final;
+
   /// 根据索引返回监听助手类
   virtual bamboo::net::AcceptorPtr GetAcceptor(uint32_t index = 0) final;
 
@@ -121,12 +149,25 @@ class ServerIf {
   /// 关闭的处理函数
   virtual void StopHandle() = 0;
 
+  /// 开始排空的处理函数，可以在这里通知客户端迁移，默认不处理
+  virtual void DrainHandle();
+
  private:
+  /// 由 AioIf 在创建后、启动前设置
+  void SetExecutor(const bamboo::concurrency::Executor& executor);
+
+  /**
+   * 由 AioIf 在创建后、设置执行器前切换调度器实现
+   * @note 构造函数中已经注册了调度或者创建了连接助手时保留原来的调度器
+   */
+  void SetSchedulerEngine(bamboo::schedule::Scheduler::Engine engine);
+
   std::string name_;
   boost::asio::io_context& io_;
   std::vector<bamboo::net::AcceptorPtr> acceptors_;
   std::vector<bamboo::net::ConnectorPtr> connectors_;
   std::unique_ptr<bamboo::schedule::Scheduler> scheduler_;
+  bamboo::concurrency::Executor executor_;
   const std::size_t ioIndex_{0};
 };
 
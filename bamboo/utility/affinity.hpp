@@ -0,0 +1,49 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace bamboo {
+namespace utility {
+
+/**
+ * 进程允许使用的cpu
+ *
+ * @note 来自 sched_getaffinity，容器和 taskset 下编号不一定从 0 开始，也不一定连续
+ * @return 从小到大的cpu编号，获取失败时为所有在线的cpu
+ */
+std::vector<int> AllowedCpus();
+
+/// 进程允许使用的cpu数量
+std::size_t CpuCount();
+
+/**
+ * 解析cpu列表
+ * @param list 格式和 taskset -c 相同，如 "0-3,8,10-11"
+ * @return cpu编号，格式错误的部分会被忽略
+ */
+std::vector<int> ParseCpuList(const std::string& list);
+
+/**
+ * 把当前线程绑定到cpu集合上
+ * @param cpus cpu编号，为空时不做处理
+ * @return 是否绑定成功
+ */
+bool BindCpus(const std::vector<int>& cpus);
+
+/**
+ * cpu所在的NUMA节点
+ * @return 节点编号，无法获取时返回 -1
+ */
+int CpuNode(int cpu);
+
+/**
+ * 当前线程的内存从所在的NUMA节点分配
+ *
+ * @note 和默认策略相同，用于覆盖进程继承来的交错或者绑定策略
+ * @return 是否设置成功
+ */
+bool LocalMemoryPolicy();
+
+}
+}
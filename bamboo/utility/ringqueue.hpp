@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+namespace bamboo {
+namespace utility {
+
+/**
+ * 单线程使用的环形队列
+ *
+ * @brief 只在末尾添加、在头部移除，容量不够时翻倍，之后不再申请内存。
+ *        std::deque 在头尾推进时会不断申请和释放内部的分段，稳定状态下也有内存申请
+ *
+ * @tparam TYPE 数据类型，需要可以默认构造和移动赋值
+ */
+template <typename TYPE>
+class RingQueue final {
+ public:
+  RingQueue() {}
+
+  RingQueue(const RingQueue&) = delete;
+  RingQueue& operator=(const RingQueue&) = delete;
+
+  bool empty() const { return size_ == 0; }
+
+  std::size_t size() const { return size_; }
+
+  /// 队头开始的第 index 个元素
+  TYPE& operator[](std::size_t index) { return cells_[(head_ + index) & mask_]; }
+
+  TYPE& front() { return cells_[head_]; }
+
+  TYPE& back() { return cells_[(head_ + size_ - 1) & mask_]; }
+
+  void push_back(TYPE&& value) {
+    if (size_ == Capacity()) Grow();
+    cells_[(head_ + size_) & mask_] = std::move(value);
+    ++size_;
+  }
+
+  /// 移除队头，元素被重置为默认值，及时释放持有的资源
+  void pop_front() {
+    cells_[head_] = TYPE();
+    head_ = (head_ + 1) & mask_;
+    --size_;
+  }
+
+  void clear() {
+    while (!empty()) pop_front();
+  }
+
+ private:
+  std::size_t Capacity() const { return cells_ ? mask_ + 1 : 0; }
+
+  void Grow() {
+    std::size_t capacity = cells_ ? (mask_ + 1) * 2 : 16;
+    std::unique_ptr<TYPE[]> cells(new TYPE[capacity]);
+    for (std::size_t i = 0; i < size_; ++i) {
+      cells[i] = std::move((*this)[i]);
+    }
+    cells_ = std::move(cells);
+    mask_ = capacity - 1;
+    head_ = 0;
+  }
+
+  std::unique_ptr<TYPE[]> cells_;
+  std::size_t mask_{0};
+  std::size_t head_{0};
+  std::size_t size_{0};
+};
+
+}
+}
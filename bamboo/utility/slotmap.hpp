@@ -0,0 +1,131 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace bamboo {
+namespace utility {
+
+/**
+ * 槽位表
+ *
+ * @brief 数据连续存放，查找、插入、删除都是 O(1)。
+ *        ID 由槽位索引(低32位)和代数(高32位)组成，槽位每次释放后代数加一，
+ *        旧的 ID 不会再指向新的数据；代数用完的槽位不再复用，所以 ID 永不重复
+ *
+ * @tparam T 数据类型
+ */
+template <typename T>
+class SlotMap final {
+ public:
+  /// ID 类型，0 为无效 ID
+  using ID = uint64_t;
+
+  using iterator = typename std::vector<T>::iterator;
+
+  SlotMap() {}
+  ~SlotMap() {}
+
+  /**
+   * 插入数据
+   * @param value 数据
+   * @return 数据的 ID
+   */
+  ID Insert(T value) {
+    uint32_t slot;
+    if (freeHead_ != NONE) {
+      slot = freeHead_;
+      freeHead_ = slots_[slot].index;
+    } else {
+      slot = static_cast<uint32_t>(slots_.size());
+      slots_.push_back(Slot{1, 0});
+    }
+
+    slots_[slot].index = static_cast<uint32_t>(values_.size());
+    values_.push_back(std::move(value));
+    owners_.push_back(slot);
+    return (static_cast<ID>(slots_[slot].generation) << 32) | slot;
+  }
+
+  /**
+   * 查找数据
+   * @param id 数据的 ID
+   * @return 数据的指针，不存在时为 nullptr。插入新数据后指针可能失效
+   */
+  T* Find(ID id) {
+    uint32_t slot = static_cast<uint32_t>(id);
+    if (!Alive(id)) return nullptr;
+    return &values_[slots_[slot].index];
+  }
+
+  /**
+   * 删除数据
+   *
+   * @note 最后一个数据会被移到删除的位置上
+   * @param id 数据的 ID
+   * @return 是否删除成功
+   */
+  bool Erase(ID id) {
+    if (!Alive(id)) return false;
+
+    uint32_t slot = static_cast<uint32_t>(id);
+    uint32_t index = slots_[slot].index;
+    uint32_t last = static_cast<uint32_t>(values_.size() - 1);
+    if (index != last) {
+      values_[index] = std::move(values_[last]);
+      owners_[index] = owners_[last];
+      slots_[owners_[index]].index = index;
+    }
+    values_.pop_back();
+    owners_.pop_back();
+
+    auto& info = slots_[slot];
+    if (info.generation == MAX_GENERATION) {
+      // 代数用完，槽位作废
+      info.index = NONE;
+      return true;
+    }
+    info.generation += 1;
+    info.index = freeHead_;
+    freeHead_ = slot;
+    return true;
+  }
+
+  /// 数据数量
+  std::size_t Size() const { return values_.size(); }
+
+  /// 是否为空
+  bool Empty() const { return values_.empty(); }
+
+  /// 按存放顺序遍历数据
+  iterator begin() { return values_.begin(); }
+  iterator end() { return values_.end(); }
+
+  /// 按存放顺序访问数据
+  T& operator[](std::size_t index) { return values_[index]; }
+
+ private:
+  static const uint32_t NONE = 0xFFFFFFFF;
+  static const uint32_t MAX_GENERATION = 0xFFFFFFFF;
+
+  struct Slot {
+    uint32_t generation;
+    uint32_t index; /**< 使用中为数据的索引，空闲时为下一个空闲槽位 */
+  };
+
+  bool Alive(ID id) const {
+    uint32_t slot = static_cast<uint32_t>(id);
+    uint32_t generation = static_cast<uint32_t>(id >> 32);
+    if (slot >= slots_.size()) return false;
+    const auto& info = slots_[slot];
+    return info.generation == generation && info.index < owners_.size() && owners_[info.index] == slot;
+  }
+
+  std::vector<Slot> slots_;
+  std::vector<T> values_;
+  std::vector<uint32_t> owners_;
+  uint32_t freeHead_{NONE};
+};
+
+}
+}
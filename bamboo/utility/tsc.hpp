@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstdint>
+#include <chrono>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+namespace bamboo {
+namespace utility {
+
+/**
+ * 读取时间戳计数器
+ *
+ * @brief x86 上直接读取 TSC，只需要几纳秒，不进入内核；其他平台退化为 steady_clock 的纳秒数。
+ *        计数只能用于计算时间差，通过 TicksToNanoseconds 转换为纳秒
+ */
+inline uint64_t Ticks() {
+#if defined(__x86_64__) || defined(__i386__)
+  return __rdtsc();
+#else
+  return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+}
+
+/// 每纳秒的计数，第一次调用时和 steady_clock 对比校准
+double TicksPerNanosecond();
+
+/// 把计数差转换为纳秒
+inline uint64_t TicksToNanoseconds(uint64_t ticks) {
+  return static_cast<uint64_t>(static_cast<double>(ticks) / TicksPerNanosecond());
+}
+
+}
+}
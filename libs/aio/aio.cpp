@@ -3,9 +3,15 @@
 namespace bamboo {
 namespace aio {
 
-Aio::Aio(): guard_(boost::asio::make_work_guard(io_)) {}
+Aio::Aio(const Topology& topology): guard_(boost::asio::make_work_guard(io_)) {
+  topology_ = topology;
+  InitMailbox();
+}
 
-Aio::~Aio() { Stop(); }
+Aio::~Aio() {
+  Stop();
+  mailbox_.reset();
+}
 
 std::pair<boost::asio::io_context&, std::size_t> Aio::AllocateIo() {
   return std::make_pair(std::ref(io_), 0);
@@ -20,9 +26,11 @@ boost::asio::io_context& Aio::GetMasterIo() {
 }
 
 void Aio::IoRun() {
+  topology_.Apply(0);
+  mailbox_->Bind(0);
   for (;;) {
     try {
-      io_.run();
+      topology_.Run(io_, 0);
       break;
     } catch (std::exception& e) {
       BB_ERROR_LOG("catch exception:%s", e.what());
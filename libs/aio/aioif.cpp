@@ -1,8 +1,27 @@
 #include "bamboo/aio/aioif.hpp"
 
+#include <unistd.h>
+
+#include <atomic>
+
 namespace bamboo {
 namespace aio {
 
+const std::chrono::milliseconds AioIf::DRAIN_INTERVAL(20);
+
+struct AioIf::DrainInfo {
+  explicit DrainInfo(boost::asio::io_context& io, std::size_t size) : timer(io), counts(size) {
+    for (auto& count : counts) count.store(SIZE_MAX);
+  }
+
+  boost::asio::steady_timer timer;
+  std::chrono::steady_clock::time_point deadline;
+  std::chrono::milliseconds flush{0};
+  bool flushing{false};
+  /// 按服务排列的链接数，由服务在自己的执行器上更新，SIZE_MAX 为还没有上报
+  std::vector<std::atomic<std::size_t>> counts;
+};
+
 AioIf::AioIf() {}
 
 AioIf::~AioIf() {}
@@ -24,11 +43,20 @@ void AioIf::Start() {
     registry_->Register();
     registry_->StartWatch();
   }
+
+  for (std::size_t i = 0; i < GetIoSize(); ++i) {
+    IoLoad::Of(GetIo(i)).StartProbe(GetIo(i));
+  }
   IoRun();
 }
 
 void AioIf::Stop() {
+  if (drain_) {
+    drain_->timer.cancel();
+    drain_.reset();
+  }
   if (registry_) registry_->Stop();
+  if (mailbox_) mailbox_->Stop();
 
   for (auto& server : servers_) {
     server->Stop();
@@ -37,6 +65,171 @@ void AioIf::Stop() {
   StopHandle();
 }
 
+void AioIf::Drain(std::chrono::milliseconds timeout, std::chrono::milliseconds flush) {
+  if (drain_) return;
+
+  // 先从服务发现中摘除，不再有新的请求路由过来
+  if (registry_) registry_->Stop();
+
+  drain_ = std::make_shared<DrainInfo>(GetMasterIo(), servers_.size());
+  drain_->deadline = std::chrono::steady_clock::now() + timeout;
+  drain_->flush = flush;
+  BB_INFO_LOG("aio drain start, timeout:%lldms", static_cast<long long>(timeout.count()));
+
+  auto drain = drain_;
+  for (std::size_t i = 0; i < servers_.size(); ++i) {
+    auto server = servers_[i];
+    boost::asio::dispatch(server->GetExecutor(), [server, drain, i]() {
+      server->Drain();
+      drain->counts[i].store(server->GetAcceptedSize());
+    });
+  }
+  DrainCheck();
+}
+
+void AioIf::DrainCheck() {
+  auto drain = drain_;
+  if (!drain) return;
+
+  bool idle = true;
+  for (auto& count : drain->counts) {
+    if (count.load() != 0) {
+      idle = false;
+      break;
+    }
+  }
+
+  auto now = std::chrono::steady_clock::now();
+  if (!drain->flushing && (idle || now >= drain->deadline)) {
+    // 接入的链接已经处理完或者等待超时，发送完剩余数据后关闭所有链接
+    if (!idle) BB_INFO_LOG("aio drain timeout, close connections after flush");
+    drain->flushing = true;
+    drain->deadline = now + drain->flush;
+    for (auto& count : drain->counts) count.store(SIZE_MAX);
+    for (std::size_t i = 0; i < servers_.size(); ++i) {
+      auto server = servers_[i];
+      boost::asio::dispatch(server->GetExecutor(), [server, drain, i]() {
+        server->CloseAfterFlush();
+        drain->counts[i].store(server->GetConnectionSize());
+      });
+    }
+  } else if (drain->flushing && (idle || now >= drain->deadline)) {
+    if (!idle) BB_ERROR_LOG("aio drain flush timeout, drop unsent data");
+    BB_INFO_LOG("aio drain finish");
+    Stop();
+    return;
+  } else {
+    // 在服务自己的执行器上统计，共享模式下不会和服务的回调并发
+    for (std::size_t i = 0; i < servers_.size(); ++i) {
+      auto server = servers_[i];
+      bool flushing = drain->flushing;
+      boost::asio::dispatch(server->GetExecutor(), [server, drain, i, flushing]() {
+        drain->counts[i].store(flushing ? server->GetConnectionSize() : server->GetAcceptedSize());
+      });
+    }
+  }
+
+  drain->timer.expires_after(DRAIN_INTERVAL);
+  drain->timer.async_wait([this, drain](const boost::system::error_code& ec) {
+    if (ec || drain != drain_) return;
+    DrainCheck();
+  });
+}
+
+void AioIf::InitMailbox() {
+  std::vector<boost::asio::io_context*> ios;
+  for (std::size_t i = 0; i < GetIoSize(); ++i) {
+    ios.push_back(&GetIo(i));
+  }
+  mailbox_.reset(new Mailbox(std::move(ios)));
+}
+
+bamboo::concurrency::Executor AioIf::CreateExecutor(boost::asio::io_context& io) {
+  return bamboo::concurrency::Executor(io);
+}
+
+bool AioIf::Post(std::size_t ioIndex, std::function<void()>&& handler) {
+  if (!mailbox_) return false;
+  return mailbox_->Post(ioIndex, std::move(handler));
+}
+
+IoLoad& AioIf::GetLoad(std::size_t index) {
+  return IoLoad::Of(GetIo(index));
+}
+
+std::size_t AioIf::LightestIo(std::size_t first, std::size_t count) {
+  std::size_t size = GetIoSize();
+  if (first >= size) first = 0;
+  if (count == 0 || first + count > size) count = size - first;
+
+  // 从上一次选中的下一个开始比较，负载相同时轮流分配
+  std::size_t best = first + rotate_ % count;
+  uint64_t bestScore = GetLoad(best).Score();
+  for (std::size_t i = 1; i < count; ++i) {
+    std::size_t index = first + (rotate_ + i) % count;
+    uint64_t score = GetLoad(index).Score();
+    if (score < bestScore) {
+      best = index;
+      bestScore = score;
+    }
+  }
+  rotate_ = best - first + 1;
+  return best;
+}
+
+bool AioIf::MoveSocket(const bamboo::net::SocketPtr& so, std::size_t ioIndex,
+                       const bamboo::net::ConnManagerPtr& target,
+                       std::function<void(bamboo::net::SocketPtr)>&& handler) {
+  if (!so || !target || ioIndex >= GetIoSize()) return false;
+
+  boost::system::error_code ec;
+  auto protocol = so->local_endpoint(ec).protocol();
+  if (ec) return false;
+
+  auto group = so->GetGroup();
+  auto callback = std::make_shared<std::function<void(bamboo::net::SocketPtr)>>(std::move(handler));
+  boost::asio::io_context* io = &GetIo(ioIndex);
+  // 在读处理函数中调用时，处理函数返回后才交出，交出的回调仍然在原来的执行器上同步执行
+  return so->Release([this, io, ioIndex, protocol, group, target, callback](
+      bamboo::net::SocketIf::native_handle_type fd, std::string& rest) {
+    auto unread = std::make_shared<std::string>(std::move(rest));
+    std::function<void()> adopt = [io, protocol, fd, unread, group, target, callback]() {
+      // 处理函数返回前链接又有了待发送的数据或者已经关闭，没有交出
+      if (fd < 0) {
+        if (*callback) (*callback)(nullptr);
+        return;
+      }
+
+      boost::system::error_code ec;
+      boost::asio::ip::tcp::socket socket(*io);
+      socket.assign(protocol, fd, ec);
+      if (ec) {
+        BB_ERROR_LOG("adopt socket fail:%s", ec.message().c_str());
+        ::close(fd);
+        if (*callback) (*callback)(nullptr);
+        return;
+      }
+
+      auto so = target->Adopt(std::move(socket), *unread);
+      if (so) so->SetGroup(group);
+      if (*callback) (*callback)(so);
+    };
+    auto run = [target, adopt]() {
+      auto& executor = target->GetExecutor();
+      if (executor) {
+        boost::asio::dispatch(executor, adopt);
+      } else {
+        adopt();
+      }
+    };
+
+    // 文件描述符已经交出，邮箱满时直接投递到目标io，不能丢弃
+    if (!mailbox_ || !mailbox_->Post(ioIndex, std::function<void()>(run))) {
+      boost::asio::post(*io, run);
+    }
+  });
+}
+
 std::shared_ptr<bamboo::distributed::Registry> AioIf::InitRegistry() {
   BB_ASSERT(registry_ == nullptr);
   registry_.reset(new bamboo::distributed::Registry(GetMasterIo()));
@@ -0,0 +1,179 @@
+#include "bamboo/aio/ioload.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cxxabi.h>
+
+#include "bamboo/utility/tsc.hpp"
+
+namespace {
+
+/**
+ * 把回调类型名还原为可读的名字
+ *
+ * @brief 回调一般被 asio 包装过几层，只保留最里面的 lambda，
+ *        lambda 的名字带有定义它的函数，如 bamboo::net::Socket::ReadData()::{lambda(...)#1}
+ */
+std::string SiteName(const char* name) {
+  int status = 0;
+  char* demangled = abi::__cxa_demangle(name, nullptr, nullptr, &status);
+  if (status != 0 || demangled == nullptr) return name;
+  std::string site(demangled);
+  std::free(demangled);
+
+  auto lambda = site.find("::{lambda");
+  if (lambda == std::string::npos) return site;
+
+  // 向前找到 lambda 所在函数名的开始，跳过函数参数列表里的括号
+  std::size_t begin = lambda;
+  int depth = 0;
+  while (begin > 0) {
+    char c = site[begin - 1];
+    if (c == ')' || c == '>') ++depth;
+    if (c == '(' || c == '<') {
+      if (depth == 0) break;
+      --depth;
+    }
+    if ((c == ',' || c == ' ') && depth == 0) break;
+    --begin;
+  }
+
+  // 向后找到 lambda 名字的结束
+  std::size_t end = site.find('}', lambda);
+  if (end == std::string::npos) return site.substr(begin);
+  return site.substr(begin, end + 1 - begin);
+}
+
+}
+
+namespace bamboo {
+namespace aio {
+
+const std::chrono::milliseconds IoLoad::PROBE_INTERVAL(100);
+const uint64_t IoLoad::SERVER_COST;
+const uint64_t IoLoad::CONNECTION_COST;
+const std::size_t IoLoad::BUCKETS;
+const std::size_t IoLoad::MAX_SLOW_SITES;
+boost::asio::execution_context::id IoLoad::id;
+
+IoLoad::IoLoad(boost::asio::execution_context& context) : boost::asio::execution_context::service(context) {
+  for (auto& bucket : histogram_) {
+    bucket.store(0);
+  }
+}
+
+IoLoad& IoLoad::Of(boost::asio::io_context& io) {
+  return boost::asio::use_service<IoLoad>(static_cast<boost::asio::execution_context&>(io));
+}
+
+uint64_t IoLoad::Score() const {
+  int64_t servers = std::max<int64_t>(Servers(), 0);
+  int64_t connections = std::max<int64_t>(Connections(), 0);
+  return Lag() + static_cast<uint64_t>(servers) * SERVER_COST + static_cast<uint64_t>(connections) * CONNECTION_COST;
+}
+
+void IoLoad::StartProbe(boost::asio::io_context& io) {
+  if (timer_) return;
+  timer_.reset(new boost::asio::steady_timer(io));
+  Probe();
+}
+
+void IoLoad::Probe() {
+  expected_ = std::chrono::steady_clock::now() + PROBE_INTERVAL;
+  timer_->expires_at(expected_);
+  timer_->async_wait([this](const boost::system::error_code& ec) {
+    if (ec) return;
+
+    auto late = std::chrono::steady_clock::now() - expected_;
+    auto sample = static_cast<uint64_t>(std::max<int64_t>(
+        std::chrono::duration_cast<std::chrono::microseconds>(late).count(), 0));
+    // 权重 1/8 的滑动平均，平滑掉单次的抖动
+    uint64_t lag = lag_.load(std::memory_order_relaxed);
+    lag_.store(lag - lag / 8 + sample / 8, std::memory_order_relaxed);
+    if (sample > maxLag_.load(std::memory_order_relaxed)) maxLag_.store(sample, std::memory_order_relaxed);
+    Probe();
+  });
+}
+
+void IoLoad::Record(uint64_t ticks, const char* site) {
+  uint64_t ns = bamboo::utility::TicksToNanoseconds(ticks);
+  handlers_.fetch_add(1, std::memory_order_relaxed);
+  handlerTime_.fetch_add(ns, std::memory_order_relaxed);
+
+  uint64_t us = ns / 1000;
+  std::size_t bucket = 0;
+  while (us > 0 && bucket < BUCKETS - 1) {
+    us >>= 1;
+    ++bucket;
+  }
+  histogram_[bucket].fetch_add(1, std::memory_order_relaxed);
+
+  if (ns < slowThreshold_.load(std::memory_order_relaxed)) return;
+
+  std::lock_guard<std::mutex> lock(slowMutex_);
+  auto it = slow_.find(site);
+  if (it == slow_.end()) {
+    if (slow_.size() >= MAX_SLOW_SITES) return;
+    it = slow_.insert(std::make_pair(site, SlowInfo())).first;
+  }
+  it->second.count += 1;
+  it->second.total += ns;
+  it->second.max = std::max(it->second.max, ns);
+}
+
+void IoLoad::SetSlowThreshold(uint64_t microseconds) {
+  slowThreshold_.store(microseconds * 1000, std::memory_order_relaxed);
+}
+
+IoLoad::Stats IoLoad::GetStats(std::size_t top) const {
+  Stats stats;
+  stats.servers = Servers();
+  stats.connections = Connections();
+  stats.lag = Lag();
+  stats.maxLag = maxLag_.load(std::memory_order_relaxed);
+  stats.handlers = handlers_.load(std::memory_order_relaxed);
+  stats.handlerTime = handlerTime_.load(std::memory_order_relaxed);
+  stats.queued = std::max<int64_t>(queued_.load(std::memory_order_relaxed), 0);
+  for (std::size_t i = 0; i < BUCKETS; ++i) {
+    stats.histogram[i] = histogram_[i].load(std::memory_order_relaxed);
+  }
+
+  std::vector<std::pair<const char*, SlowInfo>> slow;
+  {
+    std::lock_guard<std::mutex> lock(slowMutex_);
+    slow.assign(slow_.begin(), slow_.end());
+  }
+  std::sort(slow.begin(), slow.end(), [](const std::pair<const char*, SlowInfo>& a,
+                                         const std::pair<const char*, SlowInfo>& b) {
+    return a.second.max > b.second.max;
+  });
+  if (slow.size() > top) slow.resize(top);
+  for (auto& it : slow) {
+    SlowSite site;
+    site.site = SiteName(it.first);
+    site.count = it.second.count;
+    site.total = it.second.total;
+    site.max = it.second.max;
+    stats.slow.push_back(std::move(site));
+  }
+  return stats;
+}
+
+void IoLoad::ResetStats() {
+  maxLag_.store(0, std::memory_order_relaxed);
+  handlers_.store(0, std::memory_order_relaxed);
+  handlerTime_.store(0, std::memory_order_relaxed);
+  for (auto& bucket : histogram_) {
+    bucket.store(0, std::memory_order_relaxed);
+  }
+  std::lock_guard<std::mutex> lock(slowMutex_);
+  slow_.clear();
+}
+
+void IoLoad::shutdown() {
+  // 在io销毁其他服务之前释放定时器
+  timer_.reset();
+}
+
+}
+}
@@ -0,0 +1,153 @@
+#include "bamboo/aio/mailbox.hpp"
+
+#include <unistd.h>
+#include <sys/eventfd.h>
+
+#include <boost/asio/bind_executor.hpp>
+
+#include "bamboo/log/log.hpp"
+
+namespace {
+
+/// 每个队列每轮最多处理的消息数，避免一个队列占满整个io
+const std::size_t DRAIN_BUDGET = 256;
+
+thread_local const bamboo::aio::Mailbox* currentMailbox = nullptr;
+thread_local std::size_t currentIndex = bamboo::aio::Mailbox::NPOS;
+
+int CreateEvent() {
+  int fd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  if (fd < 0) throw std::runtime_error("create eventfd fail");
+  return fd;
+}
+
+}
+
+namespace bamboo {
+namespace aio {
+
+const std::size_t Mailbox::NPOS;
+const std::size_t Mailbox::Task::INLINE_SIZE;
+
+Mailbox::Box::Box(boost::asio::io_context& io, std::size_t ios, std::size_t capacity) : event(io, CreateEvent()),
+                                                                                       strand(io),
+                                                                                       from(new std::atomic<Queue*>[ios]),
+                                                                                       shared(capacity) {
+  for (std::size_t i = 0; i < ios; ++i) {
+    from[i].store(nullptr);
+  }
+}
+
+Mailbox::Mailbox(std::vector<boost::asio::io_context*> ios, std::size_t capacity) : capacity_(capacity) {
+  boxes_.reserve(ios.size());
+  for (auto io : ios) {
+    boxes_.emplace_back(new Box(*io, ios.size(), capacity));
+  }
+  for (std::size_t i = 0; i < boxes_.size(); ++i) {
+    DoRead(i);
+  }
+}
+
+Mailbox::~Mailbox() {
+  Stop();
+  for (auto& box : boxes_) {
+    for (std::size_t i = 0; i < boxes_.size(); ++i) {
+      delete box->from[i].load();
+    }
+  }
+}
+
+void Mailbox::Stop() {
+  if (!running_.exchange(false)) return;
+
+  boost::system::error_code ec;
+  for (auto& box : boxes_) {
+    box->event.close(ec);
+  }
+}
+
+void Mailbox::Bind(std::size_t index) {
+  currentMailbox = this;
+  currentIndex = index;
+}
+
+std::size_t Mailbox::Current() const {
+  return currentMailbox == this ? currentIndex : NPOS;
+}
+
+bool Mailbox::Post(std::size_t to, Task&& task) {
+  if (to >= boxes_.size() || !running_.load()) return false;
+
+  auto& box = *boxes_[to];
+  std::size_t from = Current();
+  bool success;
+  if (from == NPOS) {
+    success = box.shared.TryPush(std::move(task));
+  } else {
+    // 只有来源io的线程会写这个队列，第一次发送时创建
+    Queue* queue = box.from[from].load(std::memory_order_acquire);
+    if (queue == nullptr) {
+      queue = new Queue(capacity_);
+      box.from[from].store(queue, std::memory_order_release);
+    }
+    success = queue->TryPush(std::move(task));
+  }
+  if (!success) return false;
+
+  // 目标io已经被唤醒过，本轮处理时会一并取出
+  if (!box.scheduled.exchange(true)) Wake(to);
+  return true;
+}
+
+void Mailbox::Wake(std::size_t index) {
+  uint64_t one = 1;
+  if (::write(boxes_[index]->event.native_handle(), &one, sizeof(one)) < 0 && errno != EAGAIN) {
+    BB_ERROR_LOG("mailbox[%zu] wake fail:%s", index, ::strerror(errno));
+  }
+}
+
+void Mailbox::DoRead(std::size_t index) {
+  auto& box = *boxes_[index];
+  box.event.async_read_some(boost::asio::buffer(box.buffer), boost::asio::bind_executor(box.strand,
+      [this, index](const boost::system::error_code& ec, std::size_t) {
+    if (ec || !running_.load()) return;
+
+    // 先继续监听，消息处理函数抛出异常时也不会丢失唤醒
+    DoRead(index);
+
+    auto& box = *boxes_[index];
+    // 先清除标记再取消息，取的过程中新到的消息会再次唤醒
+    box.scheduled.store(false);
+    if (Drain(index) && !box.scheduled.exchange(true)) Wake(index);
+  }));
+}
+
+bool Mailbox::Drain(std::size_t index) {
+  auto& box = *boxes_[index];
+  bool more = false;
+  Task task;
+  for (std::size_t i = 0; i < boxes_.size(); ++i) {
+    Queue* queue = box.from[i].load(std::memory_order_acquire);
+    if (queue == nullptr) continue;
+
+    std::size_t count = 0;
+    while (count < DRAIN_BUDGET && queue->TryPop(task)) {
+      task();
+      task = Task();
+      count += 1;
+    }
+    if (count == DRAIN_BUDGET) more = true;
+  }
+
+  std::size_t count = 0;
+  while (count < DRAIN_BUDGET && box.shared.TryPop(task)) {
+    task();
+    task = Task();
+    count += 1;
+  }
+  if (count == DRAIN_BUDGET) more = true;
+  return more;
+}
+
+}
+}
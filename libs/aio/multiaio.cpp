@@ -7,8 +7,9 @@
 namespace bamboo {
 namespace aio {
 
-MultiAio::MultiAio() {
-  int cpu = std::thread::hardware_concurrency();
+MultiAio::MultiAio(const Topology& topology) {
+  topology_ = topology;
+  int cpu = topology.ioSize > 0 ? static_cast<int>(topology.ioSize) : std::thread::hardware_concurrency();
   cpu = std::max(cpu , 2);
 
   ios_.reserve(cpu);
@@ -21,19 +22,27 @@ MultiAio::MultiAio() {
     guards_.emplace_back(new guard_t(boost::asio::make_work_guard(io)));
   }
   threads_.reserve(cpu - 1);
+  InitMailbox();
 
   BB_INFO_LOG("multi-aio init %d io_contexts", cpu);
 }
 
-MultiAio::~MultiAio() { Stop(); }
+MultiAio::~MultiAio() {
+  Stop();
+  mailbox_.reset();
+}
 
 void MultiAio::IoRun() {
   for (int i = 0; i < ios_.size()-1; ++i) {
     boost::asio::io_context* io = ios_[i].get();
-    threads_.emplace_back([io]() {
+    Mailbox* mailbox = mailbox_.get();
+    const Topology* topology = &topology_;
+    threads_.emplace_back([io, mailbox, topology, i]() {
+      topology->Apply(i);
+      mailbox->Bind(i);
       for (;;) {
         try {
-          io->run();
+          topology->Run(*io, i);
           break;
         } catch (std::exception& e) {
           BB_ERROR_LOG("catch exception:%s", e.what());
@@ -42,9 +51,11 @@ void MultiAio::IoRun() {
     });
   }
 
+  topology_.Apply(ios_.size() - 1);
+  mailbox_->Bind(ios_.size() - 1);
   for (;;) {
     try {
-      GetMasterIo().run();
+      topology_.Run(GetMasterIo(), ios_.size() - 1);
       break;
     } catch (std::exception& e) {
       BB_ERROR_LOG("catch exception:%s", e.what());
@@ -69,7 +80,7 @@ std::size_t MultiAio::GetIoSize() {
 }
 
 std::pair<boost::asio::io_context&, std::size_t> MultiAio::AllocateIo() {
-  std::size_t index = index_++ % ios_.size();
+  std::size_t index = LightestIo();
   return std::make_pair(std::ref(*ios_[index]), index);
 }
 
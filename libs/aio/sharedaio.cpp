@@ -0,0 +1,114 @@
+#include "bamboo/aio/sharedaio.hpp"
+
+#include <thread>
+
+#include "bamboo/log/log.hpp"
+
+namespace {
+/// 默认每个共享io上运行的线程数
+const std::size_t THREADS_PER_IO = 4;
+}
+
+namespace bamboo {
+namespace aio {
+
+SharedAio::SharedAio(const Topology& topology) {
+  topology_ = topology;
+  threadSize_ = topology.threadSize > 0 ? topology.threadSize : std::thread::hardware_concurrency();
+  threadSize_ = std::max<std::size_t>(threadSize_, 1);
+  std::size_t shared = topology.ioSize > 0 ? topology.ioSize : (threadSize_ + THREADS_PER_IO - 1) / THREADS_PER_IO;
+  shared = std::max<std::size_t>(shared, 1);
+  // 每个共享io至少有一个线程
+  threadSize_ = std::max(threadSize_, shared);
+
+  ios_.reserve(shared + 1);
+  for (std::size_t i = 0; i < shared + 1; ++i) {
+    ios_.emplace_back(new boost::asio::io_context);
+  }
+  guards_.reserve(ios_.size());
+  for (auto& io : ios_) {
+    guards_.emplace_back(new guard_t(boost::asio::make_work_guard(*io)));
+  }
+  threads_.reserve(threadSize_);
+  InitMailbox();
+
+  BB_INFO_LOG("shared-aio init %zu io_contexts with %zu threads", shared, threadSize_);
+}
+
+SharedAio::~SharedAio() {
+  Stop();
+  mailbox_.reset();
+}
+
+void SharedAio::IoRun() {
+  std::size_t shared = ios_.size() - 1;
+  for (std::size_t i = 0; i < threadSize_; ++i) {
+    std::size_t index = i % shared;
+    boost::asio::io_context* io = ios_[index].get();
+    const Topology* topology = &topology_;
+    // 多个线程运行同一个io，不能作为邮箱的单生产者，所以不绑定邮箱
+    threads_.emplace_back([io, topology, index]() {
+      topology->Apply(index);
+      for (;;) {
+        try {
+          topology->Run(*io, index);
+          break;
+        } catch (std::exception& e) {
+          BB_ERROR_LOG("catch exception:%s", e.what());
+        }
+      }
+    });
+  }
+
+  topology_.Apply(shared);
+  mailbox_->Bind(shared);
+  for (;;) {
+    try {
+      topology_.Run(GetMasterIo(), ios_.size() - 1);
+      break;
+    } catch (std::exception& e) {
+      BB_ERROR_LOG("catch exception:%s", e.what());
+    }
+  }
+}
+
+void SharedAio::StopHandle() {
+  for (auto& ptr : ios_) {
+    ptr->stop();
+  }
+
+  for (auto& thread : threads_) {
+    if (thread.joinable()) {
+      thread.join();
+    }
+  }
+}
+
+bamboo::concurrency::Executor SharedAio::CreateExecutor(boost::asio::io_context& io) {
+  return bamboo::concurrency::Executor::Strand(io);
+}
+
+std::size_t SharedAio::GetIoSize() {
+  return ios_.size();
+}
+
+std::size_t SharedAio::GetThreadSize() const {
+  return threadSize_;
+}
+
+std::pair<boost::asio::io_context&, std::size_t> SharedAio::AllocateIo() {
+  // 服务只分配到共享io上，主io留给服务发现和全局调度
+  std::size_t index = LightestIo(0, ios_.size() - 1);
+  return std::make_pair(std::ref(*ios_[index]), index);
+}
+
+boost::asio::io_context& SharedAio::GetIo(std::size_t index) {
+  return *ios_[index];
+}
+
+boost::asio::io_context& SharedAio::GetMasterIo() {
+  return *(*ios_.rbegin());
+}
+
+}
+}
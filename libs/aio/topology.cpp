@@ -0,0 +1,93 @@
+#include "bamboo/aio/topology.hpp"
+
+#include <chrono>
+#include <sstream>
+
+#include "bamboo/buffer/bufferpool.hpp"
+#include "bamboo/utility/affinity.hpp"
+#include "bamboo/log/log.hpp"
+
+namespace {
+/// 预热时使用的内存块长度，和链接读缓冲的常用长度一致
+const std::size_t PREFILL_BLOCK = 4096;
+}
+
+namespace bamboo {
+namespace aio {
+
+Topology Topology::Pinned(std::size_t ioSize, int first) {
+  auto allowed = bamboo::utility::AllowedCpus();
+  if (ioSize == 0) ioSize = allowed.size();
+
+  Topology topology;
+  topology.ioSize = ioSize;
+  // first 是允许使用的cpu里的序号，io超过cpu数量时会绕回开头，工作线程只用没有分配给io的cpu
+  std::vector<bool> used(allowed.size(), false);
+  std::size_t start = first > 0 ? static_cast<std::size_t>(first) : 0;
+  for (std::size_t i = 0; i < ioSize; ++i) {
+    std::size_t index = (start + i) % allowed.size();
+    topology.ioCpus.push_back({allowed[index]});
+    used[index] = true;
+  }
+  for (std::size_t index = 0; index < allowed.size(); ++index) {
+    if (!used[index]) topology.workerCpus.push_back(allowed[index]);
+  }
+  return topology;
+}
+
+Topology Topology::Parse(const std::string& ios, const std::string& workers) {
+  Topology topology;
+  std::stringstream stream(ios);
+  std::string item;
+  while (std::getline(stream, item, ';')) {
+    topology.ioCpus.push_back(bamboo::utility::ParseCpuList(item));
+  }
+  topology.ioSize = topology.ioCpus.size();
+  topology.workerCpus = bamboo::utility::ParseCpuList(workers);
+  return topology;
+}
+
+void Topology::Apply(std::size_t index) const {
+  if (index >= ioCpus.size() || ioCpus[index].empty()) return;
+
+  const auto& cpus = ioCpus[index];
+  if (!bamboo::utility::BindCpus(cpus)) return;
+  BB_INFO_LOG("io[%zu] bind to %zu cpu(s), first cpu:%d node:%d", index, cpus.size(), cpus.front(),
+              bamboo::utility::CpuNode(cpus.front()));
+
+  if (numaLocal) {
+    // 绑定之后再首次访问，缓冲池的内存页落在本地节点
+    bamboo::utility::LocalMemoryPolicy();
+    auto& pool = bamboo::buffer::BufferPool::Local();
+    pool.Scratch();
+    pool.Prefill(PREFILL_BLOCK, prefillBytes);
+  }
+}
+
+void Topology::Run(boost::asio::io_context& io, std::size_t index) const {
+  std::size_t budget = index < pollBudget.size() ? pollBudget[index] : 0;
+  if (budget == 0) {
+    io.run();
+    return;
+  }
+
+  const std::chrono::microseconds spin(budget);
+  while (!io.stopped()) {
+    if (io.poll() > 0) continue;
+
+    auto deadline = std::chrono::steady_clock::now() + spin;
+    std::size_t count = 0;
+    while (!io.stopped() && std::chrono::steady_clock::now() < deadline) {
+      count = io.poll();
+      if (count > 0) break;
+#if defined(__x86_64__) || defined(__i386__)
+      __builtin_ia32_pause();
+#endif
+    }
+    // 预算内一直空闲，阻塞到下一个回调
+    if (count == 0 && !io.stopped()) io.run_one();
+  }
+}
+
+}
+}
\ No newline at end of file
@@ -0,0 +1,103 @@
+#include "bamboo/buffer/bufferpool.hpp"
+
+#include <cstring>
+
+namespace {
+const std::size_t CLASS_COUNT = 10;
+}
+
+namespace bamboo {
+namespace buffer {
+
+const std::size_t BufferPool::MIN_BLOCK;
+const std::size_t BufferPool::MAX_BLOCK;
+const std::size_t BufferPool::SCRATCH_SIZE;
+
+BufferPool::BufferPool() : free_(CLASS_COUNT) {}
+
+BufferPool::~BufferPool() {
+  for (auto& blocks : free_) {
+    for (auto block : blocks) {
+      delete[] block;
+    }
+  }
+}
+
+BufferPool& BufferPool::Local() {
+  static thread_local BufferPool pool;
+  return pool;
+}
+
+std::size_t BufferPool::ClassIndex(std::size_t size) {
+  std::size_t index = 0;
+  std::size_t block = MIN_BLOCK;
+  while (block < size) {
+    block <<= 1;
+    ++index;
+  }
+  return index;
+}
+
+char* BufferPool::Allocate(std::size_t& size) {
+  if (size > MAX_BLOCK) return new char[size];
+
+  std::size_t index = ClassIndex(size);
+  size = MIN_BLOCK << index;
+  auto& blocks = free_[index];
+  if (blocks.empty()) return new char[size];
+
+  char* block = blocks.back();
+  blocks.pop_back();
+  cached_ -= size;
+  return block;
+}
+
+void BufferPool::Free(char* block, std::size_t size) {
+  if (block == nullptr) return;
+  if (size > MAX_BLOCK) {
+    delete[] block;
+    return;
+  }
+
+  auto& blocks = free_[ClassIndex(size)];
+  if ((blocks.size() + 1) * size > cacheLimit_) {
+    delete[] block;
+    return;
+  }
+  blocks.push_back(block);
+  cached_ += size;
+}
+
+char* BufferPool::Scratch() {
+  if (!scratch_) {
+    scratch_.reset(new char[SCRATCH_SIZE]);
+    std::memset(scratch_.get(), 0, SCRATCH_SIZE);
+  }
+  return scratch_.get();
+}
+
+void BufferPool::Prefill(std::size_t size, std::size_t bytes) {
+  if (size == 0 || size > MAX_BLOCK) return;
+
+  std::size_t index = ClassIndex(size);
+  size = MIN_BLOCK << index;
+  auto& blocks = free_[index];
+  for (std::size_t filled = 0; filled < bytes; filled += size) {
+    if ((blocks.size() + 1) * size > cacheLimit_) break;
+    char* block = new char[size];
+    std::memset(block, 0, size);
+    blocks.push_back(block);
+    cached_ += size;
+  }
+}
+
+void BufferPool::SetCacheLimit(std::size_t bytes) {
+  cacheLimit_ = bytes;
+}
+
+std::size_t BufferPool::CachedBytes() const {
+  return cached_;
+}
+
+}
+}
@@ -1,5 +1,7 @@
 #include "bamboo/buffer/dynamicbuffer.hpp"
 
+#include <cstring>
+
 namespace bamboo {
 namespace buffer {
 
@@ -11,7 +13,7 @@ DynamicBuffer::DynamicBuffer() {
 DynamicBuffer::~DynamicBuffer() {}
 
 std::size_t DynamicBuffer::Write(const char* data, std::size_t size) {
-  if (Free() < size) Grow(size);
+  Prepare(size);
 
   std::memcpy(Tail(), data, size);
   Skip(size, SkipType::WRITE);
@@ -59,6 +61,20 @@ char* DynamicBuffer::Tail() {
   return &(buffer_.get()[tail_]);
 }
 
+std::size_t DynamicBuffer::Prepare(std::size_t size) {
+  if (Free() >= size) return Free();
+
+  if (Capacity() - Size() >= size) {
+    std::size_t used = Size();
+    std::memmove(buffer_.get(), Head(), used);
+    head_ = 0;
+    tail_ = used;
+  } else {
+    Grow(size);
+  }
+  return Free();
+}
+
 void DynamicBuffer::Grow(std::size_t need) {
   std::size_t newSize = Capacity() + need;
   std::size_t calcSize = Capacity();
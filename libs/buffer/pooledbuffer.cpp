@@ -0,0 +1,98 @@
+#include "bamboo/buffer/pooledbuffer.hpp"
+
+#include <cstring>
+
+#include "bamboo/buffer/bufferpool.hpp"
+
+namespace bamboo {
+namespace buffer {
+
+PooledBuffer::PooledBuffer() {}
+
+PooledBuffer::~PooledBuffer() { Release(); }
+
+std::size_t PooledBuffer::Write(const char* data, std::size_t size) {
+  if (size < 1) return 0;
+  Prepare(size);
+
+  std::memcpy(Tail(), data, size);
+  Skip(size, SkipType::WRITE);
+  return size;
+}
+
+std::size_t PooledBuffer::Read(char* data, std::size_t size, bool skip) {
+  std::size_t readSize = size;
+  if (readSize > Size()) readSize = Size();
+  if (readSize < 1) return 0;
+
+  std::memcpy(data, Head(), readSize);
+  if (skip) Skip(readSize, SkipType::READ);
+  return readSize;
+}
+
+std::size_t PooledBuffer::Size() {
+  return tail_ - head_;
+}
+
+std::size_t PooledBuffer::Capacity() {
+  return capacity_;
+}
+
+char* PooledBuffer::Data() {
+  return Head();
+}
+
+std::size_t PooledBuffer::Free() {
+  return capacity_ - tail_;
+}
+
+void PooledBuffer::Skip(std::size_t size, SkipType type) {
+  if (type == SkipType::READ) {
+    head_ += size;
+    if (head_ == tail_) Release();
+  } else {
+    tail_ += size;
+  }
+}
+
+std::size_t PooledBuffer::Prepare(std::size_t size) {
+  if (Free() >= size) return Free();
+
+  std::size_t used = Size();
+  if (capacity_ - used >= size) {
+    std::memmove(buffer_, Head(), used);
+    head_ = 0;
+    tail_ = used;
+    return Free();
+  }
+
+  std::size_t capacity = Size() + size;
+  char* buffer = BufferPool::Local().Allocate(capacity);
+  if (used > 0) std::memcpy(buffer, Head(), used);
+
+  BufferPool::Local().Free(buffer_, capacity_);
+  buffer_ = buffer;
+  capacity_ = capacity;
+  head_ = 0;
+  tail_ = used;
+  return Free();
+}
+
+void PooledBuffer::Release() {
+  BufferPool::Local().Free(buffer_, capacity_);
+  buffer_ = nullptr;
+  capacity_ = 0;
+  head_ = 0;
+  tail_ = 0;
+}
+
+char* PooledBuffer::Head() {
+  return buffer_ + head_;
+}
+
+char* PooledBuffer::Tail() {
+  return buffer_ + tail_;
+}
+
+}
+}
@@ -0,0 +1,62 @@
+#include "bamboo/buffer/slabpool.hpp"
+
+#include <atomic>
+
+namespace bamboo {
+namespace buffer {
+
+const std::size_t SlabPool::SLAB_SIZE;
+const std::size_t SlabPool::MAX_MESSAGE;
+const std::size_t SlabPool::MAX_SLABS;
+
+SlabPool::SlabPool() {}
+
+SlabPool::~SlabPool() {}
+
+SlabPool& SlabPool::Local() {
+  static thread_local SlabPool pool;
+  return pool;
+}
+
+char* SlabPool::Reserve(std::size_t size, std::shared_ptr<const void>& holder) {
+  if (size == 0 || size > MAX_MESSAGE) return nullptr;
+
+  // 按8字节对齐，方便消息直接写入整数
+  std::size_t aligned = (size + 7) & ~static_cast<std::size_t>(7);
+  if (slabs_.empty() || slabs_[current_]->used + aligned > SLAB_SIZE) {
+    if (!NextSlab()) return nullptr;
+  }
+
+  auto& slab = slabs_[current_];
+  char* out = slab->data.get() + slab->used;
+  slab->used += aligned;
+  holder = slab;
+  return out;
+}
+
+std::size_t SlabPool::SlabCount() const {
+  return slabs_.size();
+}
+
+bool SlabPool::NextSlab() {
+  // 从当前的内存板开始找，只有缓冲池自己持有时才能重用。
+  // 发送队列可能在其他线程释放，需要看到它们的读取已经结束
+  for (std::size_t n = 0; n < slabs_.size(); ++n) {
+    std::size_t i = (current_ + n) % slabs_.size();
+    if (slabs_[i].use_count() != 1) continue;
+    std::atomic_thread_fence(std::memory_order_acquire);
+    slabs_[i]->used = 0;
+    current_ = i;
+    return true;
+  }
+
+  if (slabs_.size() >= MAX_SLABS) return false;
+  std::shared_ptr<Slab> slab(new Slab);
+  slab->data.reset(new char[SLAB_SIZE]);
+  slabs_.push_back(std::move(slab));
+  current_ = slabs_.size() - 1;
+  return true;
+}
+
+}
+}
@@ -1,83 +1,76 @@
 #include "bamboo/concurrency/asyncrun.hpp"
 
-#include <boost/asio/local/connect_pair.hpp>
+namespace {
 
-namespace bamboo {
-namespace concurrency {
-
-AsyncRun::AsyncRun(boost::asio::io_context& io) : sender_(io),
-                                                  receiver_(io) {
+uint64_t Nanosecond(std::chrono::steady_clock::duration duration) {
+  return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count());
+}
 
-  boost::asio::local::connect_pair(sender_, receiver_);
+}
 
-  pendingDoneList_.reset(new std::list<AsyncInfoPtr>);
-  doneList_.reset(new std::list<AsyncInfoPtr>);
+namespace bamboo {
+namespace concurrency {
 
-  masterThread_ = std::thread(&AsyncRun::MasterThread, this);
-  DoRead();
+AsyncRun::AsyncRun(boost::asio::io_context& io, std::size_t threads, std::size_t maxPending,
+                   std::vector<int> cpus) : io_(io),
+                                            maxPending_(maxPending),
+                                            state_(std::make_shared<State>()) {
+  if (threads == 0) {
+    // 绑定了cpu时线程数和cpu数一致
+    threads = cpus.empty() ? std::thread::hardware_concurrency() : cpus.size();
+  }
+  pool_.reset(new TaskPool(threads, std::move(cpus)));
 }
 
 AsyncRun::~AsyncRun() {
-  isRunning_ = false;
-  masterThread_.join();
+  // 等待工作线程执行完已提交的任务，回调仍然会在io里执行
+  pool_.reset();
 }
 
-void AsyncRun::MasterThread() {
-  while (isRunning_.load()) {
-    {
-      std::lock_guard<std::mutex> lock(sendLock_);
-      while (!sendList_.empty()) {
-        checkList_.push_back(std::move(sendList_.front()));
-        sendList_.pop_front();
-      }
+bool AsyncRun::Acquire() {
+  uint64_t pending = state_->pending.load();
+  do {
+    if (maxPending_ > 0 && pending >= maxPending_) {
+      state_->rejected.fetch_add(1);
+      return false;
     }
+  } while (!state_->pending.compare_exchange_weak(pending, pending + 1));
 
-    std::size_t done = 0;
-    for (auto it = checkList_.begin(); it != checkList_.end();) {
-      if ((*it)->checker()) {
-        doneLock_.lock();
-        pendingDoneList_->push_back(std::move(*it));
-        doneLock_.unlock();
-        it = checkList_.erase(it);
-        done += 1;
-      } else {
-        ++it;
-      }
-    }
-    if (done > 0) {
-      static const char c = 'i';
-      sender_.write_some(boost::asio::buffer(&c, 1));
-    }
-    std::this_thread::yield();
-  }
+  state_->submitted.fetch_add(1);
+  return true;
 }
 
-void AsyncRun::HandleDone() {
-  if (!doneList_->empty()) {
-    for (auto& ptr : *doneList_) {
-      ptr->callback();
-    }
-    doneList_->clear();
-  }
+AsyncRun::Stats AsyncRun::GetStats() const {
+  Stats stats;
+  stats.submitted = state_->submitted.load();
+  stats.rejected = state_->rejected.load();
+  stats.completed = state_->completed.load();
+  stats.failed = state_->failed.load();
+  stats.pending = state_->pending.load();
+  stats.queueTime = state_->queueTime.load();
+  stats.runTime = state_->runTime.load();
+  stats.totalTime = state_->totalTime.load();
+  stats.maxTotalTime = state_->maxTotalTime.load();
+  return stats;
+}
 
-  doneLock_.lock();
-  pendingDoneList_.swap(doneList_);
-  doneLock_.unlock();
+void AsyncRun::State::Fail() {
+  failed.fetch_add(1);
+  pending.fetch_sub(1);
+}
 
-  for (auto& ptr : *doneList_) {
-    ptr->callback();
-  }
+void AsyncRun::State::Complete(Clock::time_point submit, Clock::time_point begin, Clock::time_point end) {
+  uint64_t total = Nanosecond(Clock::now() - submit);
+  queueTime.fetch_add(Nanosecond(begin - submit));
+  runTime.fetch_add(Nanosecond(end - begin));
+  totalTime.fetch_add(total);
 
-  doneList_->clear();
-}
+  uint64_t max = maxTotalTime.load();
+  while (total > max && !maxTotalTime.compare_exchange_weak(max, total)) {}
 
-void AsyncRun::DoRead() {
-  receiver_.async_read_some(boost::asio::buffer(buffer_.data(), buffer_.size()),
-                             [this](const boost::system::error_code& ec, std::size_t rd) {
-                               HandleDone();
-                               DoRead();
-                             });
+  completed.fetch_add(1);
+  pending.fetch_sub(1);
 }
 
 }
-}
\ No newline at end of file
+}
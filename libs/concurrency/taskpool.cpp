@@ -1,7 +1,13 @@
 #include "bamboo/concurrency/taskpool.hpp"
 
+#include "bamboo/utility/affinity.hpp"
+
 namespace {
 const std::size_t DEFAULT_CPU_MIN_SIZE = 1;
+
+/// 当前线程所属的任务池和队列索引
+thread_local bamboo::concurrency::TaskPool* currentPool = nullptr;
+thread_local std::size_t currentIndex = 0;
 }
 
 namespace bamboo {
@@ -10,41 +16,88 @@ namespace concurrency {
 TaskPool::TaskPool() : TaskPool(std::thread::hardware_concurrency()) {
 }
 
-TaskPool::TaskPool(std::size_t size) {
+TaskPool::TaskPool(std::size_t size, std::vector<int> cpus) {
   size = std::max(size, DEFAULT_CPU_MIN_SIZE);
 
-  for (int i = 0; i < size; ++i) {
-    threads_.emplace_back(&TaskPool::TaskMain, this);
+  for (std::size_t i = 0; i < size; ++i) {
+    workers_.emplace_back(new Worker);
+  }
+  for (std::size_t i = 0; i < size; ++i) {
+    threads_.emplace_back(&TaskPool::TaskMain, this, i, cpus);
   }
 }
 
 TaskPool::~TaskPool() {
-  isRunning_ = false;
-  cond_.notify_all();
+  {
+    std::lock_guard<std::mutex> lock(parkMutex_);
+    isRunning_ = false;
+  }
+  parkCond_.notify_all();
 
   for (auto& thread : threads_) {
-    thread.detach();
+    thread.join();
   }
 }
 
 void TaskPool::Add(bamboo::concurrency::TaskPool::Handler&& handle) {
-  std::lock_guard<std::mutex> lock(mutex_);
-  list_.push_back(std::move(handle));
-  cond_.notify_one();
-}
-
-void TaskPool::TaskMain() {
-  while (isRunning_.load()) {
-    std::unique_lock<std::mutex> lock(mutex_);
-    if (list_.empty()) {
-      cond_.wait(lock);
-    } else {
-      Handler h = std::move(list_.front());
-      list_.pop_front();
+  std::size_t index = currentPool == this ? currentIndex : next_.fetch_add(1) % workers_.size();
+
+  // 先增加任务数再检查休眠数，和 TaskMain 中的顺序相反，保证不会漏掉唤醒
+  pending_.fetch_add(1);
+  {
+    std::lock_guard<std::mutex> lock(workers_[index]->mutex);
+    workers_[index]->tasks.push_back(std::move(handle));
+  }
+
+  if (idle_.load() > 0) {
+    std::lock_guard<std::mutex> lock(parkMutex_);
+    parkCond_.notify_one();
+  }
+}
+
+bool TaskPool::Pop(std::size_t index, Handler& h) {
+  auto& worker = *workers_[index];
+  std::lock_guard<std::mutex> lock(worker.mutex);
+  if (worker.tasks.empty()) return false;
+  h = std::move(worker.tasks.back());
+  worker.tasks.pop_back();
+  return true;
+}
+
+bool TaskPool::Steal(std::size_t index, Handler& h) {
+  for (std::size_t i = 1; i < workers_.size(); ++i) {
+    auto& worker = *workers_[(index + i) % workers_.size()];
+    std::unique_lock<std::mutex> lock(worker.mutex, std::try_to_lock);
+    if (!lock.owns_lock() || worker.tasks.empty()) continue;
+    h = std::move(worker.tasks.front());
+    worker.tasks.pop_front();
+    return true;
+  }
+  return false;
+}
+
+void TaskPool::TaskMain(std::size_t index, std::vector<int> cpus) {
+  bamboo::utility::BindCpus(cpus);
+  currentPool = this;
+  currentIndex = index;
+
+  while (true) {
+    Handler h;
+    if (Pop(index, h) || Steal(index, h)) {
+      pending_.fetch_sub(1);
       h();
-      std::this_thread::yield();
+      continue;
     }
+
+    std::unique_lock<std::mutex> lock(parkMutex_);
+    idle_.fetch_add(1);
+    parkCond_.wait(lock, [this]() { return pending_.load() > 0 || !isRunning_; });
+    idle_.fetch_sub(1);
+    // 关闭时先把剩余的任务执行完
+    if (!isRunning_ && pending_.load() == 0) break;
   }
+
+  currentPool = nullptr;
 }
 
 }
@@ -3,6 +3,7 @@
 #include <boost/dll.hpp>
 
 #include "bamboo/aio/multiaio.hpp"
+#include "bamboo/aio/sharedaio.hpp"
 #include "bamboo/aio/aio.hpp"
 
 namespace {
@@ -16,25 +17,38 @@ std::string program_name;
 namespace bamboo {
 namespace env {
 
-void Init(ThreadMode mode) {
+void Init(ThreadMode mode, const bamboo::aio::Topology& topology) {
   BB_ASSERT(Aio == nullptr);
   program_name = boost::dll::program_location().filename().string();
   BB_LOG_OPEN(program_name.c_str(), LOG_PID, LOG_LOCAL0);
   BB_DEBUG_LOG("open log:%s", program_name.c_str());
 
   if (mode == ThreadMode::SINGLE) {
-    Aio = std::make_shared<bamboo::aio::Aio>();
+    Aio = std::make_shared<bamboo::aio::Aio>(topology);
+  } else if (mode == ThreadMode::MULTIPLE) {
+    Aio = std::make_shared<bamboo::aio::MultiAio>(topology);
   } else {
-    Aio = std::make_shared<bamboo::aio::MultiAio>();
+    Aio = std::make_shared<bamboo::aio::SharedAio>(topology);
   }
 
-  scheduler.reset(new bamboo::schedule::Scheduler(Aio->GetMasterIo()));
+  scheduler.reset(new bamboo::schedule::Scheduler(Aio->GetMasterIo(), topology.schedulerEngine));
+  BB_INFO_LOG("aio backend:%s", Backend());
 }
 
 bamboo::aio::AioPtr GetIo() {
   return Aio;
 }
 
+const char* Backend() {
+#if defined(BOOST_ASIO_HAS_IO_URING_AS_DEFAULT)
+  return "io_uring";
+#elif defined(BOOST_ASIO_HAS_EPOLL)
+  return "epoll";
+#else
+  return "select";
+#endif
+}
+
 bamboo::schedule::Scheduler& GetScheduler() {
   return *scheduler;
 }
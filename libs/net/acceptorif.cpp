@@ -3,7 +3,7 @@
 namespace bamboo {
 namespace net {
 
-AcceptorIf::AcceptorIf(boost::asio::io_context& io) : io_(io) {}
+AcceptorIf::AcceptorIf(boost::asio::io_context& io) : io_(io), executor_(io) {}
 
 AcceptorIf::~AcceptorIf() {}
 
@@ -12,7 +12,41 @@ void AcceptorIf::SetAddress(std::string address, uint16_t port) {
 
   auto end = boost::asio::ip::make_address(address);
   boost::asio::ip::tcp::endpoint endpoint(end, port);
-  acceptor_.reset(new boost::asio::ip::tcp::acceptor(io_, endpoint));
+  std::unique_ptr<boost::asio::ip::tcp::acceptor> acceptor(new boost::asio::ip::tcp::acceptor(io_));
+  acceptor->open(endpoint.protocol());
+  acceptor->set_option(boost::asio::ip::tcp::acceptor::reuse_address(true));
+  reusePort_ = ReusePort() && EnableReusePort(*acceptor);
+  if (ReusePort() && !reusePort_) {
+    BB_ERROR_LOG("SO_REUSEPORT is not supported, listen on %s:%u exclusively", address.c_str(), port);
+  }
+  acceptor->bind(endpoint);
+  acceptor->listen();
+  acceptor_ = std::move(acceptor);
+}
+
+bool AcceptorIf::ReusePort() {
+  return false;
+}
+
+bool AcceptorIf::EnableReusePort(boost::asio::ip::tcp::acceptor& acceptor) {
+#ifdef SO_REUSEPORT
+  using reuse_port = boost::asio::detail::socket_option::boolean<SOL_SOCKET, SO_REUSEPORT>;
+  boost::system::error_code ec;
+  acceptor.set_option(reuse_port(true), ec);
+  return !ec;
+#else
+  return false;
+#endif
+}
+
+boost::asio::ip::tcp::endpoint AcceptorIf::GetLocalEndpoint() const {
+  boost::system::error_code ec;
+  if (!acceptor_) return boost::asio::ip::tcp::endpoint();
+  return acceptor_->local_endpoint(ec);
+}
+
+bool AcceptorIf::IsReusePort() const {
+  return reusePort_;
 }
 
 ConnManagerPtr AcceptorIf::GetConnManager() {
@@ -22,6 +56,7 @@ ConnManagerPtr AcceptorIf::GetConnManager() {
 void AcceptorIf::SetConnManager(ConnManagerPtr& mgr) {
   BB_ASSERT(connManager_ == nullptr && mgr != nullptr);
   connManager_ = mgr;
+  connManager_->SetExecutor(executor_);
 }
 
 }
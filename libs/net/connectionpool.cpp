@@ -0,0 +1,71 @@
+#include "bamboo/net/connectionpool.hpp"
+
+namespace bamboo {
+namespace net {
+
+ConnectionPool::ConnectionPool(ConnectorPtr connector, std::string address, uint16_t port, std::size_t size,
+                               ConnectorIf::ReconnectPolicy policy) : connector_(std::move(connector)),
+                                                                      address_(std::move(address)),
+                                                                      port_(port),
+                                                                      policy_(policy),
+                                                                      slots_(std::max<std::size_t>(size, 1)) {}
+
+ConnectionPool::~ConnectionPool() {}
+
+void ConnectionPool::Start() {
+  std::weak_ptr<ConnectionPool> weak = shared_from_this();
+  for (std::size_t i = 0; i < slots_.size(); ++i) {
+    if (slots_[i].keep != 0) continue;
+    slots_[i].keep = connector_->KeepConnect(address_, port_, policy_, [weak, i](SocketPtr so) {
+      auto self = weak.lock();
+      if (!self) return;
+      self->slots_[i].socket = so;
+      self->slots_[i].inflight = 0;
+    });
+  }
+}
+
+void ConnectionPool::Stop() {
+  for (auto& slot : slots_) {
+    if (slot.keep == 0) continue;
+    connector_->StopKeepConnect(slot.keep);
+    slot.keep = 0;
+  }
+}
+
+SocketPtr ConnectionPool::Select() {
+  Slot* best = nullptr;
+  for (auto& slot : slots_) {
+    if (!slot.socket || !slot.socket->is_open()) continue;
+    if (best == nullptr || slot.inflight < best->inflight) best = &slot;
+  }
+  return best ? best->socket : nullptr;
+}
+
+void ConnectionPool::Begin(const SocketPtr& so) {
+  auto slot = Find(so);
+  if (slot) slot->inflight += 1;
+}
+
+void ConnectionPool::End(const SocketPtr& so) {
+  auto slot = Find(so);
+  if (slot && slot->inflight > 0) slot->inflight -= 1;
+}
+
+std::size_t ConnectionPool::GetAliveSize() {
+  std::size_t alive = 0;
+  for (auto& slot : slots_) {
+    if (slot.socket && slot.socket->is_open()) alive += 1;
+  }
+  return alive;
+}
+
+ConnectionPool::Slot* ConnectionPool::Find(const SocketPtr& so) {
+  for (auto& slot : slots_) {
+    if (slot.socket == so) return &slot;
+  }
+  return nullptr;
+}
+
+}
+}
@@ -4,7 +4,36 @@
 namespace bamboo {
 namespace net {
 
-ConnectorIf::ConnectorIf(boost::asio::io_context &io) : io_(io) {}
+/// 一次异步连接的上下文
+struct ConnectorIf::ConnectContext {
+  boost::asio::ip::tcp::resolver resolver;
+  boost::asio::ip::tcp::socket socket;
+  ConnectorIf::ConnectHandler handler;
+  bamboo::schedule::Scheduler::ID timer{0};
+  bool done{false};
+  std::string address;
+  uint16_t port{0};
+
+  ConnectContext(boost::asio::io_context& io) : resolver(io), socket(io) {}
+
+  /// 取消还在进行的解析和连接，它们的回调看到 done 后直接返回
+  void Cancel() {
+    resolver.cancel();
+    boost::system::error_code ec;
+    socket.close(ec);
+  }
+};
+
+ConnectorIf::ConnectorIf(boost::asio::io_context &io) : executor_(io), io_(io) {}
+
+ConnectorIf::~ConnectorIf() {
+  // 服务先析构调度器，这里不能再访问 scheduler_
+  alive_.reset();
+  for (auto& ctx : connecting_) {
+    ctx->done = true;
+    ctx->Cancel();
+  }
+}
 
 ConnManagerPtr ConnectorIf::GetConnManager() {
   return connManager_;
@@ -13,6 +42,7 @@ ConnManagerPtr ConnectorIf::GetConnManager() {
 void ConnectorIf::SetConnManager(ConnManagerPtr& mgr) {
   BB_ASSERT(connManager_ == nullptr && mgr != nullptr);
   connManager_ = mgr;
+  connManager_->SetExecutor(executor_);
 }
 
 SocketPtr ConnectorIf::Connect(std::string address, uint16_t port) {
@@ -43,5 +73,167 @@ SocketPtr ConnectorIf::Connect(std::string address, uint16_t port) {
   return nullptr;
 }
 
+void ConnectorIf::AsyncConnect(std::string address, uint16_t port, ConnectHandler&& handler, std::time_t timeout) {
+  auto ctx = std::make_shared<ConnectContext>(io_);
+  ctx->handler = std::move(handler);
+  ctx->address = address;
+  ctx->port = port;
+  connecting_.insert(ctx);
+
+  // 回调可能在连接助手析构后才执行，只持有弱引用
+  std::weak_ptr<bool> alive = alive_;
+  if (timeout > 0) {
+    BB_ASSERT(scheduler_ != nullptr);
+    ctx->timer = scheduler_->Timeout([this, alive, ctx]() {
+      if (alive.expired()) return;
+      // 计时器已经触发，不能在回调里再取消它
+      ctx->timer = 0;
+      FinishConnect(ctx, boost::asio::error::timed_out);
+    }, timeout);
+  }
+
+  auto executor = executor_;
+  ctx->resolver.async_resolve(address, std::to_string(port), boost::asio::bind_executor(executor_,
+      [this, alive, ctx, executor](const boost::system::error_code& ec,
+                                   boost::asio::ip::tcp::resolver::results_type results) {
+        if (alive.expired() || ctx->done) return;
+        if (ec) {
+          FinishConnect(ctx, ec);
+          return;
+        }
+
+        boost::asio::async_connect(ctx->socket, results, boost::asio::bind_executor(executor,
+            [this, alive, ctx](const boost::system::error_code& ec, const boost::asio::ip::tcp::endpoint&) {
+              if (alive.expired()) return;
+              FinishConnect(ctx, ec);
+            }));
+      }));
+}
+
+void ConnectorIf::FinishConnect(const std::shared_ptr<ConnectContext>& ctx, const boost::system::error_code& ec) {
+  if (ctx->done) return;
+  ctx->done = true;
+  connecting_.erase(ctx);
+  if (ctx->timer != 0) scheduler_->Cancel(ctx->timer);
+
+  if (ec) {
+    ctx->Cancel();
+    BB_ERROR_LOG("connect to [%s:%d] fail:%s", ctx->address.c_str(), ctx->port, ec.message().c_str());
+    if (ctx->handler) ctx->handler(ec, nullptr);
+    return;
+  }
+
+  if (!connManager_) {
+    BB_ERROR_LOG("established connection to [%s:%d] but no conn manager.", ctx->address.c_str(), ctx->port);
+    if (ctx->handler) ctx->handler(boost::asio::error::no_protocol_option, nullptr);
+    return;
+  }
+
+  BB_INFO_LOG("established connection to [%s:%d]", ctx->address.c_str(), ctx->port);
+  auto so = connManager_->OnConnect(std::move(ctx->socket));
+  if (ctx->handler) ctx->handler(ec, so);
+}
+
+ConnectorIf::KeepId ConnectorIf::KeepConnect(std::string address, uint16_t port, ReconnectPolicy policy,
+                                             std::function<void(SocketPtr)>&& handler) {
+  KeepId id = ++keepId_;
+  auto info = std::make_shared<KeepInfo>();
+  info->owner = this;
+  info->id = id;
+  info->address = std::move(address);
+  info->port = port;
+  info->policy = policy;
+  info->handler = std::move(handler);
+
+  keeps_[id] = info;
+  DoKeepConnect(id);
+  return id;
+}
+
+void ConnectorIf::StopKeepConnect(KeepId id) {
+  auto it = keeps_.find(id);
+  if (it == keeps_.end()) return;
+
+  auto& info = it->second;
+  if (info->timer != 0) scheduler_->Cancel(info->timer);
+  // 已经建立的链接上的关闭回调还持有弱引用，断开所属关系后回调不再重连
+  info->owner = nullptr;
+  keeps_.erase(it);
+}
+
+void ConnectorIf::Stop() {
+  while (!keeps_.empty()) {
+    StopKeepConnect(keeps_.begin()->first);
+  }
+
+  // 回调里可能发起新的连接，只取消停止时已经在进行的
+  auto connecting = connecting_;
+  for (auto& ctx : connecting) {
+    FinishConnect(ctx, boost::asio::error::operation_aborted);
+  }
+}
+
+void ConnectorIf::DoKeepConnect(KeepId id) {
+  auto it = keeps_.find(id);
+  if (it == keeps_.end()) return;
+  auto info = it->second;
+
+  std::weak_ptr<bool> alive = alive_;
+  AsyncConnect(info->address, info->port, [this, alive, id](const boost::system::error_code& ec, SocketPtr so) {
+    if (alive.expired()) return;
+    auto it = keeps_.find(id);
+    if (it == keeps_.end()) return;
+    auto info = it->second;
+
+    if (ec || !so) {
+      ScheduleReconnect(id);
+      return;
+    }
+
+    info->attempt = 0;
+    // 链接可能比连接助手活得久，只通过保持连接的信息找回来，停止或析构后回调失效
+    std::weak_ptr<KeepInfo> weak = info;
+    so->AddCloseListener([weak]() {
+      auto info = weak.lock();
+      if (info && info->owner) info->owner->ScheduleReconnect(info->id);
+    });
+    if (info->handler) info->handler(so);
+  }, info->policy.timeout);
+}
+
+void ConnectorIf::ScheduleReconnect(KeepId id) {
+  auto it = keeps_.find(id);
+  if (it == keeps_.end()) return;
+  auto& info = it->second;
+
+  BB_ASSERT(scheduler_ != nullptr);
+  std::uniform_real_distribution<double> dist(-1.0, 1.0);
+  std::time_t delay = info->policy.Delay(info->attempt, dist(random_));
+  info->attempt += 1;
+
+  BB_INFO_LOG("reconnect to [%s:%d] after %lld ms", info->address.c_str(), info->port,
+              static_cast<long long>(delay));
+  std::weak_ptr<bool> alive = alive_;
+  info->timer = scheduler_->Timeout([this, alive, id]() {
+    if (alive.expired()) return;
+    auto it = keeps_.find(id);
+    if (it == keeps_.end()) return;
+    it->second->timer = 0;
+    DoKeepConnect(id);
+  }, delay);
+}
+
+std::time_t ConnectorIf::ReconnectPolicy::Delay(std::size_t attempt, double random) const {
+  double delay = static_cast<double>(initialDelay);
+  for (std::size_t i = 0; i < attempt && delay < maxDelay; ++i) {
+    delay *= multiplier;
+  }
+  delay = std::min(delay, static_cast<double>(maxDelay));
+  if (jitter > 0) {
+    delay *= 1.0 + jitter * std::max(-1.0, std::min(random, 1.0));
+  }
+  return static_cast<std::time_t>(std::max(delay, 0.0));
+}
+
 }
 }
\ No newline at end of file
@@ -33,6 +33,123 @@ ConnManagerIf::ConnectHandler& ConnManagerIf::GetConnectHandler() {
   return connector_;
 }
 
+std::size_t ConnManagerIf::Broadcast(const ConstBufferPtr& payload) {
+  if (!payload || payload->empty()) return 0;
+
+  std::size_t count = 0;
+  ForeachSocket([&payload, &count](SocketPtr& so) {
+    if (!so->is_open()) return;
+    so->WriteData(payload);
+    ++count;
+  });
+  return count;
+}
+
+std::size_t ConnManagerIf::Broadcast(uint32_t group, const ConstBufferPtr& payload) {
+  return Broadcast(payload, [group](const SocketPtr& so) -> bool { return so->GetGroup() == group; });
+}
+
+std::size_t ConnManagerIf::Broadcast(const ConstBufferPtr& payload, SocketFilter&& filter) {
+  if (!payload || payload->empty()) return 0;
+  if (!filter) return Broadcast(payload);
+
+  std::size_t count = 0;
+  ForeachSocket([&payload, &filter, &count](SocketPtr& so) {
+    if (!so->is_open() || !filter(so)) return;
+    so->WriteData(payload);
+    ++count;
+  });
+  return count;
+}
+
+std::size_t ConnManagerIf::Multicast(const std::vector<uint64_t>& sockets, const ConstBufferPtr& payload) {
+  if (!payload || payload->empty()) return 0;
+
+  std::size_t count = 0;
+  for (auto id : sockets) {
+    auto so = GetSocket(id);
+    if (!so || !so->is_open()) continue;
+    so->WriteData(payload);
+    ++count;
+  }
+  return count;
+}
+
+void ConnManagerIf::CloseAfterFlush() {
+  ForeachSocket([](SocketPtr& so) {
+    so->CloseAfterFlush();
+  });
+}
+
+void ConnManagerIf::SetWriteWatermark(std::size_t high, std::size_t low, bool pauseRead) {
+  highWatermark_ = high;
+  lowWatermark_ = low;
+  pauseReadOnHigh_ = pauseRead;
+}
+
+void ConnManagerIf::SetBusyPoll(uint32_t microseconds) {
+  busyPoll_ = microseconds;
+}
+
+void ConnManagerIf::SetWatermarkHandler(bamboo::net::ConnManagerIf::WatermarkHandler&& handle) {
+  watermarker_ = std::move(handle);
+}
+
+ConnManagerIf::WatermarkHandler& ConnManagerIf::GetWatermarkHandler() {
+  return watermarker_;
+}
+
+void ConnManagerIf::SetExecutor(const bamboo::concurrency::Executor& executor) {
+  executor_ = executor;
+}
+
+const bamboo::concurrency::Executor& ConnManagerIf::GetExecutor() {
+  return executor_;
+}
+
+SocketPtr ConnManagerIf::Adopt(boost::asio::ip::tcp::socket&& socket, const std::string& unread) {
+  auto so = OnConnect(std::move(socket));
+  if (so && !unread.empty()) so->Feed(unread.data(), unread.size());
+  return so;
+}
+
+void ConnManagerIf::InitSocket(const SocketPtr& so) {
+  if (executor_) so->SetExecutor(executor_);
+
+  if (highWatermark_ > 0) {
+    so->SetWriteWatermark(highWatermark_, lowWatermark_, pauseReadOnHigh_);
+  }
+
+  if (busyPoll_ > 0) {
+#ifdef SO_BUSY_POLL
+    using busy_poll = boost::asio::detail::socket_option::integer<SOL_SOCKET, SO_BUSY_POLL>;
+    boost::system::error_code ec;
+    so->set_option(busy_poll(static_cast<int>(busyPoll_)), ec);
+    if (ec) BB_DEBUG_LOG("socket[%llu] set SO_BUSY_POLL fail:%s", so->GetId(), ec.message().c_str());
+#else
+    BB_DEBUG_LOG("SO_BUSY_POLL is not supported");
+#endif
+  }
+
+  if (protocol_) {
+    protocol_->OnConnect(so);
+    std::weak_ptr<SocketIf> weak = so;
+    auto protocol = protocol_;
+    so->AddCloseListener([weak, protocol]() {
+      auto so = weak.lock();
+      if (so) protocol->OnClose(so);
+    });
+  }
+
+  if (watermarker_) {
+    std::weak_ptr<SocketIf> weak = so;
+    so->SetWatermarkHandler([this, weak](bool high) {
+      auto so = weak.lock();
+      if (so && watermarker_) watermarker_(so, high);
+    });
+  }
+}
+
 bamboo::protocol::ProtocolPtr ConnManagerIf::GetProtocol() {
   return protocol_;
 }
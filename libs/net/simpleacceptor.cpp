@@ -12,13 +12,16 @@ void SimpleAcceptor::Start() {
 }
 
 void SimpleAcceptor::Stop() {
-  acceptor_->close();
+  boost::system::error_code ec;
+  acceptor_->close(ec);
 }
 
 void SimpleAcceptor::DoAccept() {
   auto self = shared_from_this();
-  acceptor_->async_accept(
+  acceptor_->async_accept(boost::asio::bind_executor(executor_,
       [this, self](boost::system::error_code ec, boost::asio::ip::tcp::socket&& socket) {
+        // 关闭监听后不再重新投递，排空期间io还在运行
+        if (!acceptor_->is_open()) return;
         if (ec) {
           BB_ERROR_LOG("accept connect fail:%s", ec.message().c_str());
         } else {
@@ -27,7 +30,7 @@ void SimpleAcceptor::DoAccept() {
           }
         }
         DoAccept();
-      });
+      }));
 }
 
 }
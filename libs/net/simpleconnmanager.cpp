@@ -7,22 +7,22 @@ SimpleConnManager::~SimpleConnManager() {}
 
 SocketPtr SimpleConnManager::OnConnect(boost::asio::ip::tcp::socket&& socket) {
   auto so = std::make_shared<bamboo::net::Socket>(std::move(socket));
-  auto id = static_cast<uint32_t>(so->native_handle());
+  auto id = sockets_.Insert(so);
   so->SetId(id);
-  sockets_[so->GetId()] = so;
 
   auto self = shared_from_this();
   so->SetReadHandler([id, self, this](const char* data, std::size_t size) -> std::size_t {
     auto& reader = GetReadHandler();
     if (reader) {
-      auto it = sockets_.find(id);
-      if (it == sockets_.end()) return size;
-      return reader(it->second, data, size);
+      auto it = sockets_.Find(id);
+      if (it == nullptr) return size;
+      return reader(*it, data, size);
     }
     return size;
   });
 
   so->SetCloseHandler([self, id]() { self->OnDelete(id); });
+  InitSocket(so);
 
   auto& connector = GetConnectHandler();
   if (connector) connector(std::dynamic_pointer_cast<SocketIf>(so));
@@ -31,22 +31,42 @@ SocketPtr SimpleConnManager::OnConnect(boost::asio::ip::tcp::socket&& socket) {
   return so;
 }
 
-void SimpleConnManager::OnDelete(uint32_t socket) {
-  auto it = sockets_.find(socket);
-  if (it == sockets_.end()) return;
+void SimpleConnManager::OnDelete(uint64_t socket) {
+  auto it = sockets_.Find(socket);
+  if (it == nullptr) return;
 
+  SocketPtr so = *it;
   auto& deleter = GetDeleteHandler();
-  if (deleter) deleter(it->second);
+  if (deleter) deleter(so);
 
-  sockets_.erase(it);
+  sockets_.Erase(socket);
 }
 
-void SimpleConnManager::WriteData(uint32_t socket, const char* data, std::size_t size) {
-  auto it = sockets_.find(socket);
-  if (it == sockets_.end()) return;
+void SimpleConnManager::WriteData(uint64_t socket, const char* data, std::size_t size) {
+  auto it = sockets_.Find(socket);
+  if (it == nullptr) return;
 
-  it->second->WriteData(data, size);
+  (*it)->WriteData(data, size);
 }
 
+SocketPtr SimpleConnManager::GetSocket(uint64_t socket) {
+  auto it = sockets_.Find(socket);
+  if (it == nullptr) return nullptr;
+  return *it;
+}
+
+std::size_t SimpleConnManager::GetSocketSize() {
+  return sockets_.Size();
+}
+
+void SimpleConnManager::ForeachSocket(std::function<void(SocketPtr&)>&& handler) {
+  // 倒序遍历，处理函数关闭当前链接时，被移过来的是已经遍历过的链接
+  for (std::size_t i = sockets_.Size(); i > 0; --i) {
+    if (i > sockets_.Size()) continue;
+    SocketPtr so = sockets_[i - 1];
+    handler(so);
+  }
+}
+
+}
 }
-}
\ No newline at end of file
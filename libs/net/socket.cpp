@@ -1,97 +1,299 @@
 #include "bamboo/net/socket.hpp"
 
+#include "bamboo/buffer/bufferpool.hpp"
+#include "bamboo/buffer/slabpool.hpp"
+
 namespace bamboo {
 namespace net {
 
+const std::size_t Socket::MAX_READ_BUFFER;
+const std::size_t Socket::READ_CHUNK;
+const std::size_t Socket::MAX_WRITE_BUFFERS;
+
 Socket::~Socket() {}
 
 void Socket::ReadData() {
-  if (buffer_.Free() < 1) {
-    BB_ERROR_LOG("socket[%d] read buffer is full????", GetId());
-    Close();
+  if (!is_open() || flushClose_) return;
+  if (overHigh_ && pauseReadOnHigh_) {
+    readPaused_ = true;
     return;
   }
   auto self = shared_from_this();
+
+  if (buffer_.Size() == 0) {
+    // 空闲的链接不持有读缓冲区，等数据可读时再读到线程共享的临时内存里
+    async_wait(boost::asio::ip::tcp::socket::wait_read,
+               boost::asio::bind_executor(GetExecutor(), [this, self](const boost::system::error_code& ec) {
+                 if (ec) {
+                   // 交出或者关闭时取消的等待不是错误
+                   if (ec == boost::asio::error::operation_aborted && closed_) return;
+                   BB_ERROR_LOG("socket[%llu] wait data ec:%s", GetId(), ec.message().c_str());
+                   Close();
+                   return;
+                 }
+                 if (flushClose_) return;
+                 ReadScratch();
+               }));
+    return;
+  }
+
+  if (buffer_.Size() >= MAX_READ_BUFFER) {
+    BB_ERROR_LOG("socket[%llu] read buffer is full????", GetId());
+    Close();
+    return;
+  }
+  buffer_.Prepare(std::min(READ_CHUNK, MAX_READ_BUFFER - buffer_.Size()));
   async_read_some(boost::asio::buffer(buffer_.Tail(), buffer_.Free()),
-                  [this, self](const boost::system::error_code& ec, std::size_t rd) {
+                  boost::asio::bind_executor(GetExecutor(), [this, self](const boost::system::error_code& ec,
+                                                                          std::size_t rd) {
                     if (ec) {
-                      BB_ERROR_LOG("socket[%d] read data ec:%s", GetId(), ec.message().c_str());
+                      if (ec == boost::asio::error::operation_aborted && closed_) return;
+                      BB_ERROR_LOG("socket[%llu] read data ec:%s", GetId(), ec.message().c_str());
                       Close();
                       return;
                     }
+                    if (flushClose_) return;
                     buffer_.Skip(rd, bamboo::buffer::SkipType::WRITE);
-                    auto& handler = GetReadHandler();
-                    if (handler) {
-                      std::size_t read = handler(buffer_.Head(), buffer_.Size());
-                      buffer_.Skip(read, bamboo::buffer::SkipType::READ);
-                    } else {
-                      buffer_.Skip(rd, bamboo::buffer::SkipType::READ);
-                    }
-
+                    HandleRead(buffer_.Head(), buffer_.Size());
                     ReadData();
-                  });
+                  }));
 }
 
-void Socket::DoWriteData() {
-  if (list_.empty()) return;
+void Socket::ReadScratch() {
+  if (buffer_.Size() > 0) {
+    // 等待期间通过 Feed 放入了未处理的数据，新数据要接在后面
+    ReadData();
+    return;
+  }
 
-  auto buff = list_.front();
-  auto self = shared_from_this();
-  async_write_some(boost::asio::buffer(buff->data(), buff->size()),
-                   [buff, self, this](const boost::system::error_code& ec, std::size_t wd) {
-                     if (ec) {
-                       BB_ERROR_LOG("socket[%d] write data ec:%s", GetId(), ec.message().c_str());
-                       Close();
-                       return;
-                     }
-
-                     if (wd < buff->size()) {
-                       buff->erase(0, wd);
-                     } else {
-                       list_.pop_front();
-                     }
-                     DoWriteData();
-                   });
+  boost::system::error_code ec;
+  if (!non_blocking()) non_blocking(true, ec);
+
+  auto& pool = bamboo::buffer::BufferPool::Local();
+  char* scratch = pool.Scratch();
+  std::size_t rd = read_some(boost::asio::buffer(scratch, bamboo::buffer::BufferPool::SCRATCH_SIZE), ec);
+  if (ec == boost::asio::error::would_block || ec == boost::asio::error::try_again) {
+    ReadData();
+    return;
+  }
+  if (ec) {
+    BB_ERROR_LOG("socket[%llu] read data ec:%s", GetId(), ec.message().c_str());
+    Close();
+    return;
+  }
+
+  auto& handler = GetReadHandler();
+  reading_ = true;
+  std::size_t read = std::min(handler ? handler(scratch, rd) : rd, rd);
+  reading_ = false;
+  // 没有消耗的数据还在线程共享的临时内存里，跟着文件描述符一起交出
+  if (releaser_ && DoRelease(scratch + read, rd - read)) return;
+  if (read < rd && is_open()) {
+    // 只有不完整的数据才拷贝到私有的读缓冲区
+    buffer_.Write(scratch + read, rd - read);
+  }
+  ReadData();
 }
 
-void Socket::WriteData(const char* data, std::size_t size) {
-  if (!is_open() || size < 1) return;
+void Socket::HandleRead(const char* data, std::size_t size) {
+  auto& handler = GetReadHandler();
+  reading_ = true;
+  std::size_t read = std::min(handler ? handler(data, size) : size, size);
+  reading_ = false;
+  if (releaser_ && DoRelease(data + read, size - read)) return;
+  buffer_.Skip(read, bamboo::buffer::SkipType::READ);
+}
+
+namespace {
 
-  auto buff = std::make_shared<std::string>();
-  buff->append(data, size);
+/// 引用 Socket 内部数组的一段区间，避免每次 writev 复制一份缓冲区列表
+struct BufferRange {
+  using value_type = boost::asio::const_buffer;
+  using const_iterator = const boost::asio::const_buffer*;
+  const_iterator first;
+  const_iterator last;
+  const_iterator begin() const { return first; }
+  const_iterator end() const { return last; }
+};
 
+}
+
+void Socket::DoWriteData() {
   if (list_.empty()) {
-    list_.push_back(buff);
+    writing_ = false;
+    if (flushClose_) Close();
+    return;
+  }
+
+  std::size_t count = std::min(list_.size(), MAX_WRITE_BUFFERS);
+  for (std::size_t i = 0; i < count; ++i) {
+    auto& item = list_[i];
+    if (i == 0) {
+      writeBuffers_[i] = boost::asio::buffer(item.data + offset_, item.size - offset_);
+    } else {
+      writeBuffers_[i] = boost::asio::buffer(item.data, item.size);
+    }
+  }
+
+  writing_ = true;
+  auto self = shared_from_this();
+  BufferRange range{writeBuffers_.data(), writeBuffers_.data() + count};
+  async_write_some(range, boost::asio::bind_executor(GetExecutor(), [self, this](const boost::system::error_code& ec,
+                                                                                  std::size_t wd) {
+    if (ec) {
+      writing_ = false;
+      BB_ERROR_LOG("socket[%llu] write data ec:%s", GetId(), ec.message().c_str());
+      Close();
+      return;
+    }
+
+    ConsumeWrite(wd);
     DoWriteData();
-  } else {
-    list_.push_back(buff);
+  }));
+}
+
+void Socket::ConsumeWrite(std::size_t size) {
+  queued_ -= std::min(size, queued_);
+  while (size > 0 && !list_.empty()) {
+    std::size_t left = list_.front().size - offset_;
+    if (size < left) {
+      offset_ += size;
+      break;
+    }
+    size -= left;
+    offset_ = 0;
+    list_.pop_front();
   }
+
+  if (overHigh_ && queued_ <= lowWatermark_) {
+    overHigh_ = false;
+    auto& handler = GetWatermarkHandler();
+    if (handler) handler(false);
+    if (readPaused_) {
+      readPaused_ = false;
+      ReadData();
+    }
+  }
+}
+
+void Socket::PushWrite(std::shared_ptr<const void> holder, const char* data, std::size_t size) {
+  list_.push_back(WriteItem{std::move(holder), data, size});
+  queued_ += size;
+  if (highWatermark_ > 0 && !overHigh_ && queued_ >= highWatermark_) {
+    overHigh_ = true;
+    auto& handler = GetWatermarkHandler();
+    if (handler) handler(true);
+  }
+  if (!writing_) DoWriteData();
+}
+
+void Socket::WriteData(const char* data, std::size_t size) {
+  if (!is_open() || size < 1) return;
+
+  auto buff = std::make_shared<std::string>(data, size);
+  const char* ptr = buff->data();
+  PushWrite(std::move(buff), ptr, size);
 }
 
 void Socket::WriteData(bamboo::protocol::MessageIf* message) {
-  if (!is_open()) return;
+  if (!is_open() || message == nullptr) return;
 
-  WriteData(message->Build());
+  std::size_t size = message->EncodedSize();
+  if (size == 0) {
+    WriteData(message->Build());
+    return;
+  }
+
+  // 直接编码到线程的内存板上，内存板不够时才单独申请
+  std::shared_ptr<const void> holder;
+  char* out = bamboo::buffer::SlabPool::Local().Reserve(size, holder);
+  if (out == nullptr) {
+    WriteData(message->Build());
+    return;
+  }
+  message->SerializeTo(out);
+  PushWrite(std::move(holder), out, size);
 }
 
 void Socket::WriteData(std::unique_ptr<std::string>&& buffer) {
   if (!is_open() || !buffer || buffer->size() < 1) return;
 
-  std::shared_ptr<std::string> buff(buffer.release());
+  WriteData(ConstBufferPtr(buffer.release()));
+}
 
-  if (list_.empty()) {
-    list_.push_back(buff);
-    DoWriteData();
-  } else {
-    list_.push_back(buff);
+void Socket::WriteData(ConstBufferPtr buffer) {
+  if (!is_open() || !buffer || buffer->size() < 1) return;
+
+  const char* ptr = buffer->data();
+  std::size_t size = buffer->size();
+  PushWrite(std::move(buffer), ptr, size);
+}
+
+std::size_t Socket::GetWriteQueueSize() {
+  return queued_;
+}
+
+bool Socket::Release(ReleaseHandler&& handler) {
+  if (closed_ || !is_open() || writing_ || !list_.empty() || releaser_ || !handler) return false;
+
+  releaser_ = std::move(handler);
+  // 读处理函数返回后才知道当前这段数据消耗了多少
+  if (!reading_) DoRelease(buffer_.Head(), buffer_.Size());
+  return true;
+}
+
+bool Socket::DoRelease(const char* unread, std::size_t size) {
+  auto handler = std::move(releaser_);
+  releaser_ = nullptr;
+  // unread 可能指向读缓冲区，先复制出来
+  std::string rest(unread, size);
+
+  native_handle_type fd = -1;
+  if (!closed_ && is_open() && !writing_ && list_.empty()) {
+    boost::system::error_code ec;
+    fd = release(ec);
+    if (ec) {
+      BB_ERROR_LOG("socket[%llu] release fail:%s", GetId(), ec.message().c_str());
+      fd = -1;
+    }
+  }
+
+  if (fd >= 0) {
+    buffer_.Release();
+    // 已经不持有文件描述符，关闭只会通知管理类移除这个链接
+    Close();
   }
+  handler(fd, rest);
+  return fd >= 0;
+}
+
+void Socket::Feed(const char* data, std::size_t size) {
+  if (!is_open() || size < 1) return;
+
+  buffer_.Write(data, size);
+  HandleRead(buffer_.Head(), buffer_.Size());
+}
+
+void Socket::CloseAfterFlush() {
+  if (closed_ || flushClose_) return;
+  flushClose_ = true;
+  if (!writing_ && list_.empty()) Close();
 }
 
 void Socket::Close() {
-  BB_DEBUG_LOG("socket close:%d", GetId());
+  if (closed_) return;
+  closed_ = true;
+
+  BB_DEBUG_LOG("socket close:%llu", GetId());
+  auto self = shared_from_this();
   auto& closer = GetCloseHandler();
   if (closer) closer();
 
+  auto listeners = std::move(GetCloseListeners());
+  for (auto& listener : listeners) {
+    if (listener) listener();
+  }
+
   if (is_open()) {
     boost::system::error_code ec;
     this->shutdown(boost::asio::ip::tcp::socket::shutdown_both, ec);
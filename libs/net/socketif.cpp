@@ -4,18 +4,56 @@ namespace bamboo {
 namespace net {
 
 SocketIf::SocketIf(boost::asio::ip::tcp::socket&& socket) :
-    boost::asio::ip::tcp::socket(std::move(socket)) {}
+    boost::asio::ip::tcp::socket(std::move(socket)) {
+  load_ = &bamboo::aio::IoLoad::Of(static_cast<boost::asio::io_context&>(get_executor().context()));
+  load_->AddConnection(1);
+}
 
-SocketIf::~SocketIf() {}
+SocketIf::~SocketIf() {
+  if (load_) load_->AddConnection(-1);
+}
 
-uint32_t SocketIf::GetId() {
+uint64_t SocketIf::GetId() {
   return id_;
 }
 
-void SocketIf::SetId(uint32_t id) {
+void SocketIf::SetId(uint64_t id) {
   id_ = id;
 }
 
+void SocketIf::SetGroup(uint32_t group) {
+  group_ = group;
+}
+
+uint32_t SocketIf::GetGroup() {
+  return group_;
+}
+
+void SocketIf::SetExecutor(const bamboo::concurrency::Executor& executor) {
+  executor_ = executor;
+}
+
+const bamboo::concurrency::Executor& SocketIf::GetExecutor() {
+  if (!executor_) {
+    executor_ = bamboo::concurrency::Executor(static_cast<boost::asio::io_context&>(get_executor().context()));
+  }
+  return executor_;
+}
+
+void SocketIf::SetWriteWatermark(std::size_t high, std::size_t low, bool pauseRead) {
+  highWatermark_ = high;
+  lowWatermark_ = std::min(low, high);
+  pauseReadOnHigh_ = pauseRead;
+}
+
+void SocketIf::SetWatermarkHandler(bamboo::net::SocketIf::WatermarkHandler&& handle) {
+  watermarker_ = std::move(handle);
+}
+
+SocketIf::WatermarkHandler& SocketIf::GetWatermarkHandler() {
+  return watermarker_;
+}
+
 void SocketIf::SetReadHandler(bamboo::net::SocketIf::ReadHandler&& handle) {
   reader_ = std::move(handle);
 }
@@ -32,5 +70,13 @@ SocketIf::CloseHandler& SocketIf::GetCloseHandler() {
   return closer_;
 }
 
+void SocketIf::AddCloseListener(bamboo::net::SocketIf::CloseHandler&& handle) {
+  listeners_.push_back(std::move(handle));
+}
+
+std::vector<SocketIf::CloseHandler>& SocketIf::GetCloseListeners() {
+  return listeners_;
+}
+
 }
 }
\ No newline at end of file
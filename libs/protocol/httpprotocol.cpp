@@ -0,0 +1,384 @@
+#include "bamboo/protocol/httpprotocol.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+
+namespace bamboo {
+namespace protocol {
+
+const std::size_t HttpProtocol::MAX_HEADER;
+const std::size_t HttpProtocol::MAX_PIPELINE;
+
+namespace {
+
+bool EqualsIgnoreCase(boost::string_view a, boost::string_view b) {
+  if (a.size() != b.size()) return false;
+  for (std::size_t i = 0; i < a.size(); ++i) {
+    if (std::tolower(static_cast<unsigned char>(a[i])) != std::tolower(static_cast<unsigned char>(b[i]))) return false;
+  }
+  return true;
+}
+
+/// 逗号分隔的列表中是否包含某一项，不区分大小写
+bool HasToken(boost::string_view list, boost::string_view token) {
+  while (!list.empty()) {
+    std::size_t comma = list.find(',');
+    boost::string_view item = list.substr(0, comma);
+    while (!item.empty() && (item.front() == ' ' || item.front() == '\t')) item.remove_prefix(1);
+    while (!item.empty() && (item.back() == ' ' || item.back() == '\t')) item.remove_suffix(1);
+    if (EqualsIgnoreCase(item, token)) return true;
+    if (comma == boost::string_view::npos) break;
+    list.remove_prefix(comma + 1);
+  }
+  return false;
+}
+
+const char* Reason(int status) {
+  switch (status) {
+    case 100: return "Continue";
+    case 200: return "OK";
+    case 201: return "Created";
+    case 202: return "Accepted";
+    case 204: return "No Content";
+    case 301: return "Moved Permanently";
+    case 302: return "Found";
+    case 304: return "Not Modified";
+    case 400: return "Bad Request";
+    case 401: return "Unauthorized";
+    case 403: return "Forbidden";
+    case 404: return "Not Found";
+    case 405: return "Method Not Allowed";
+    case 408: return "Request Timeout";
+    case 413: return "Payload Too Large";
+    case 429: return "Too Many Requests";
+    case 431: return "Request Header Fields Too Large";
+    case 500: return "Internal Server Error";
+    case 501: return "Not Implemented";
+    case 502: return "Bad Gateway";
+    case 503: return "Service Unavailable";
+    default: return "Unknown";
+  }
+}
+
+}
+
+/// 一个链接上按请求顺序排队的回复
+struct HttpResponse::Connection {
+  std::weak_ptr<bamboo::net::SocketIf> socket;
+  std::deque<HttpResponsePtr> queue;
+  /// 已经决定关闭链接，不再解析后面的请求
+  bool closing{false};
+};
+
+boost::string_view HttpRequest::Get(boost::string_view name) const {
+  for (auto& header : headers) {
+    if (EqualsIgnoreCase(header.name, name)) return header.value;
+  }
+  return boost::string_view();
+}
+
+bool HttpRequest::HasToken(boost::string_view name, boost::string_view token) const {
+  for (auto& header : headers) {
+    if (EqualsIgnoreCase(header.name, name) && bamboo::protocol::HasToken(header.value, token)) return true;
+  }
+  return false;
+}
+
+HttpResponse::HttpResponse(std::weak_ptr<Connection> connection, bool keepAlive, bool head,
+                           int minorVersion) : connection_(std::move(connection)),
+                                               keepAlive_(keepAlive),
+                                               headOnly_(head),
+                                               minorVersion_(minorVersion) {}
+
+void HttpResponse::SetStatus(int status, const char* reason) {
+  status_ = status;
+  reason_ = reason;
+}
+
+void HttpResponse::AddHeader(const std::string& name, const std::string& value) {
+  headers_.append(name);
+  headers_.append(": ", 2);
+  headers_.append(value);
+  headers_.append("\r\n", 2);
+}
+
+void HttpResponse::WriteHead(std::string& out, std::size_t length) {
+  const char* reason = reason_ ? reason_ : Reason(status_);
+  out.append("HTTP/1.1 ", 9);
+  out.append(std::to_string(status_));
+  out.push_back(' ');
+  out.append(reason);
+  out.append("\r\n", 2);
+  out.append(headers_);
+
+  // 1xx、204、304 没有内容
+  bool bodyless = status_ < 200 || status_ == 204 || status_ == 304;
+  if (chunked_) {
+    out.append("Transfer-Encoding: chunked\r\n");
+  } else if (!bodyless && length != std::string::npos) {
+    out.append("Content-Length: ");
+    out.append(std::to_string(length));
+    out.append("\r\n", 2);
+  }
+  if (!keepAlive_) {
+    out.append("Connection: close\r\n");
+  } else if (minorVersion_ == 0) {
+    out.append("Connection: keep-alive\r\n");
+  }
+  out.append("\r\n", 2);
+  headSent_ = true;
+}
+
+void HttpResponse::Send(const char* data, std::size_t size) {
+  if (headSent_ || finished_) return;
+
+  std::unique_ptr<std::string> out(new std::string());
+  out->reserve(128 + headers_.size() + size);
+  WriteHead(*out, size);
+  if (!headOnly_) out->append(data, size);
+  Output(std::move(out));
+  Finish();
+}
+
+void HttpResponse::WriteChunk(const char* data, std::size_t size) {
+  if (finished_ || size == 0) return;
+
+  std::unique_ptr<std::string> out(new std::string());
+  if (!headSent_) {
+    // HTTP/1.0 不支持 chunked，直接发送内容，结束时关闭链接
+    if (minorVersion_ == 0) {
+      keepAlive_ = false;
+    } else {
+      chunked_ = true;
+    }
+    WriteHead(*out, std::string::npos);
+  }
+
+  if (!headOnly_) {
+    if (chunked_) {
+      char length[32];
+      int n = std::snprintf(length, sizeof(length), "%zx\r\n", size);
+      out->append(length, n);
+      out->append(data, size);
+      out->append("\r\n", 2);
+    } else {
+      out->append(data, size);
+    }
+  }
+  Output(std::move(out));
+}
+
+void HttpResponse::End() {
+  if (finished_) return;
+
+  std::unique_ptr<std::string> out(new std::string());
+  if (!headSent_) {
+    chunked_ = minorVersion_ > 0;
+    if (!chunked_) keepAlive_ = false;
+    WriteHead(*out, std::string::npos);
+  }
+  if (chunked_ && !headOnly_) out->append("0\r\n\r\n", 5);
+  Output(std::move(out));
+  Finish();
+}
+
+void HttpResponse::Output(std::unique_ptr<std::string>&& data) {
+  if (data->empty()) return;
+  auto connection = connection_.lock();
+  if (!connection) return;
+
+  if (connection->queue.empty() || connection->queue.front().get() != this) {
+    pending_.append(*data);
+    return;
+  }
+  auto so = connection->socket.lock();
+  if (so) so->WriteData(std::move(data));
+}
+
+void HttpResponse::Finish() {
+  finished_ = true;
+  auto connection = connection_.lock();
+  if (!connection || connection->queue.empty() || connection->queue.front().get() != this) return;
+
+  auto so = connection->socket.lock();
+  // 依次发送已经可以发送的回复
+  while (!connection->queue.empty()) {
+    auto front = connection->queue.front();
+    if (!front->pending_.empty()) {
+      std::unique_ptr<std::string> data(new std::string());
+      data->swap(front->pending_);
+      if (so) so->WriteData(std::move(data));
+    }
+    if (!front->finished_) break;
+
+    connection->queue.pop_front();
+    if (!front->keepAlive_) {
+      connection->closing = true;
+      connection->queue.clear();
+      if (so) so->CloseAfterFlush();
+      break;
+    }
+  }
+}
+
+HttpProtocol::HttpProtocol() {}
+
+HttpProtocol::~HttpProtocol() {}
+
+void HttpProtocol::Handle(const std::string& path, Handler&& handler) {
+  handlers_[path] = std::move(handler);
+}
+
+void HttpProtocol::SetDefaultHandler(Handler&& handler) {
+  default_ = std::move(handler);
+}
+
+void HttpProtocol::SetMaxBody(std::size_t size) {
+  maxBody_ = size;
+}
+
+void HttpProtocol::OnConnect(bamboo::net::SocketPtr so) {
+  auto connection = std::make_shared<HttpResponse::Connection>();
+  connection->socket = so;
+  connections_[so->GetId()] = connection;
+}
+
+void HttpProtocol::OnClose(bamboo::net::SocketPtr so) {
+  auto it = connections_.find(so->GetId());
+  if (it == connections_.end()) return;
+  it->second->closing = true;
+  it->second->queue.clear();
+  connections_.erase(it);
+}
+
+std::size_t HttpProtocol::ReceiveData(bamboo::net::SocketPtr so, const char* data, std::size_t size) {
+  auto it = connections_.find(so->GetId());
+  if (it == connections_.end()) {
+    OnConnect(so);
+    it = connections_.find(so->GetId());
+  }
+  auto connection = it->second;
+
+  std::size_t offset = 0;
+  while (offset < size && !connection->closing) {
+    long length = Parse(data + offset, size - offset, request_, maxBody_);
+    if (length == 0) break;
+    if (length < 0) {
+      Reject(connection, length == -1 ? 400 : static_cast<int>(-length));
+      return size;
+    }
+    if (connection->queue.size() >= MAX_PIPELINE) {
+      Reject(connection, 503);
+      return size;
+    }
+    offset += static_cast<std::size_t>(length);
+
+    HttpResponsePtr response(new HttpResponse(connection, request_.keepAlive, request_.method == "HEAD",
+                                              request_.minorVersion));
+    connection->queue.push_back(response);
+    if (!request_.keepAlive) connection->closing = true;
+
+    auto handler = handlers_.find(std::string(request_.path.data(), request_.path.size()));
+    if (handler != handlers_.end() && handler->second) {
+      handler->second(so, request_, response);
+    } else if (default_) {
+      default_(so, request_, response);
+    } else {
+      response->SetStatus(404);
+      response->Send(nullptr, 0);
+    }
+    if (!so->is_open()) return size;
+  }
+
+  // 已经决定关闭时丢弃后面的数据
+  return connection->closing ? size : offset;
+}
+
+void HttpProtocol::Reject(const std::shared_ptr<HttpResponse::Connection>& connection, int status) {
+  BB_DEBUG_LOG("reject http request:%d", status);
+  HttpResponsePtr response(new HttpResponse(connection, false, false, 1));
+  connection->queue.push_back(response);
+  connection->closing = true;
+  response->SetStatus(status);
+  response->Send(nullptr, 0);
+}
+
+long HttpProtocol::Parse(const char* data, std::size_t size, HttpRequest& request, std::size_t maxBody) {
+  static const char END[] = "\r\n\r\n";
+  std::size_t limit = std::min(size, MAX_HEADER);
+  const char* end = std::search(data, data + limit, END, END + 4);
+  if (end == data + limit) return size >= MAX_HEADER ? -431 : 0;
+
+  boost::string_view head(data, end - data + 2);
+  request.headers.clear();
+  request.body = boost::string_view();
+
+  // 请求行
+  std::size_t line = head.find("\r\n");
+  boost::string_view first = head.substr(0, line);
+  std::size_t space = first.find(' ');
+  if (space == boost::string_view::npos || space == 0) return -1;
+  request.method = first.substr(0, space);
+  first.remove_prefix(space + 1);
+  space = first.find(' ');
+  if (space == boost::string_view::npos || space == 0) return -1;
+  request.target = first.substr(0, space);
+  boost::string_view version = first.substr(space + 1);
+  if (version.size() != 8 || version.substr(0, 7) != "HTTP/1." || version[7] < '0' || version[7] > '9') return -1;
+  request.minorVersion = version[7] - '0';
+
+  std::size_t question = request.target.find('?');
+  request.path = request.target.substr(0, question);
+  request.query = question == boost::string_view::npos ? boost::string_view() : request.target.substr(question + 1);
+
+  // 请求头
+  request.keepAlive = request.minorVersion > 0;
+  std::size_t contentLength = 0;
+  bool hasLength = false;
+  head.remove_prefix(line + 2);
+  while (!head.empty()) {
+    line = head.find("\r\n");
+    boost::string_view field = head.substr(0, line);
+    head.remove_prefix(line + 2);
+
+    std::size_t colon = field.find(':');
+    if (colon == boost::string_view::npos || colon == 0) return -1;
+    boost::string_view name = field.substr(0, colon);
+    if (name.back() == ' ' || name.back() == '\t') return -1;
+    boost::string_view value = field.substr(colon + 1);
+    while (!value.empty() && (value.front() == ' ' || value.front() == '\t')) value.remove_prefix(1);
+    while (!value.empty() && (value.back() == ' ' || value.back() == '\t')) value.remove_suffix(1);
+    request.headers.push_back(HttpRequest::Header{name, value});
+
+    if (EqualsIgnoreCase(name, "Content-Length")) {
+      if (value.empty() || value.size() > 18) return -1;
+      std::size_t length = 0;
+      for (char c : value) {
+        if (c < '0' || c > '9') return -1;
+        length = length * 10 + (c - '0');
+      }
+      // 重复的 Content-Length 只接受相同的值，RFC 7230 3.3.2
+      if (hasLength && length != contentLength) return -1;
+      hasLength = true;
+      contentLength = length;
+    } else if (EqualsIgnoreCase(name, "Transfer-Encoding")) {
+      return -501;
+    } else if (EqualsIgnoreCase(name, "Connection")) {
+      if (HasToken(value, "close")) {
+        request.keepAlive = false;
+      } else if (HasToken(value, "keep-alive")) {
+        request.keepAlive = true;
+      }
+    }
+  }
+
+  if (contentLength > maxBody) return -413;
+  std::size_t headerSize = end - data + 4;
+  if (size - headerSize < contentLength) return 0;
+  request.body = boost::string_view(data + headerSize, contentLength);
+  return static_cast<long>(headerSize + contentLength);
+}
+
+}
+}
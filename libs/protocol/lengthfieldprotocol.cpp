@@ -0,0 +1,137 @@
+#include "bamboo/protocol/lengthfieldprotocol.hpp"
+
+namespace bamboo {
+namespace protocol {
+
+const std::size_t LengthFieldProtocol::MAX_HEADER;
+
+LengthFieldProtocol::LengthFieldProtocol() {}
+
+LengthFieldProtocol::LengthFieldProtocol(const Option& option) : option_(option) {
+  if (option_.type == LengthType::FIXED) {
+    BB_ASSERT(option_.fieldSize == 1 || option_.fieldSize == 2 || option_.fieldSize == 4 || option_.fieldSize == 8);
+  }
+}
+
+LengthFieldProtocol::~LengthFieldProtocol() {}
+
+void LengthFieldProtocol::SetFrameHandler(FrameHandler&& handler) {
+  handler_ = std::move(handler);
+}
+
+const LengthFieldProtocol::Option& LengthFieldProtocol::GetOption() const {
+  return option_;
+}
+
+std::size_t LengthFieldProtocol::ReceiveData(bamboo::net::SocketPtr so, const char* data, std::size_t size) {
+  // 处理函数中可能再次进入，先把复用的列表拿出来
+  std::vector<Frame> frames;
+  frames.swap(frames_);
+  frames.clear();
+
+  std::size_t offset = 0;
+  while (offset < size) {
+    uint64_t length = 0;
+    std::size_t header = 0;
+    int result = DecodeHeader(data + offset, size - offset, length, header);
+    if (result == 0) break;
+    if (result < 0 || length > option_.maxFrame) {
+      BB_ERROR_LOG("socket[%llu] invalid frame length:%llu", so ? so->GetId() : 0,
+                   static_cast<unsigned long long>(length));
+      if (so) so->Close();
+      frames_.swap(frames);
+      return size;
+    }
+    if (size - offset - header < length) break;
+
+    frames.push_back(Frame{data + offset + header, static_cast<std::size_t>(length)});
+    offset += header + static_cast<std::size_t>(length);
+  }
+
+  if (!frames.empty() && handler_) handler_(so, frames);
+  frames_.swap(frames);
+  return offset;
+}
+
+int LengthFieldProtocol::DecodeHeader(const char* data, std::size_t size, uint64_t& length,
+                                      std::size_t& header) const {
+  auto bytes = reinterpret_cast<const uint8_t*>(data);
+  length = 0;
+  if (option_.type == LengthType::FIXED) {
+    if (size < option_.fieldSize) return 0;
+    for (std::size_t i = 0; i < option_.fieldSize; ++i) {
+      std::size_t index = option_.order == ByteOrder::BIG ? i : option_.fieldSize - 1 - i;
+      length = (length << 8) | bytes[index];
+    }
+    header = option_.fieldSize;
+  } else {
+    std::size_t i = 0;
+    for (;; ++i) {
+      if (i >= MAX_HEADER) return -1;
+      if (i >= size) return 0;
+      length |= static_cast<uint64_t>(bytes[i] & 0x7f) << (7 * i);
+      if ((bytes[i] & 0x80) == 0) break;
+    }
+    header = i + 1;
+  }
+
+  if (option_.includeHeader) {
+    if (length < header) return -1;
+    length -= header;
+  }
+  return 1;
+}
+
+std::size_t LengthFieldProtocol::EncodeHeader(std::size_t size, char* out) const {
+  auto bytes = reinterpret_cast<uint8_t*>(out);
+  uint64_t length = size;
+  if (option_.type == LengthType::FIXED) {
+    if (option_.includeHeader) length += option_.fieldSize;
+    for (std::size_t i = 0; i < option_.fieldSize; ++i) {
+      std::size_t index = option_.order == ByteOrder::BIG ? option_.fieldSize - 1 - i : i;
+      bytes[index] = static_cast<uint8_t>(length >> (8 * i));
+    }
+    return option_.fieldSize;
+  }
+
+  // 包含长度头时，长度头的字节数取决于加上自身后的值
+  std::size_t header = 1;
+  if (option_.includeHeader) {
+    while (true) {
+      uint64_t total = length + header;
+      std::size_t need = 1;
+      while (total >= 0x80) {
+        total >>= 7;
+        ++need;
+      }
+      if (need <= header) break;
+      header = need;
+    }
+    length += header;
+  }
+
+  std::size_t i = 0;
+  while (length >= 0x80) {
+    bytes[i++] = static_cast<uint8_t>(length | 0x80);
+    length >>= 7;
+  }
+  bytes[i++] = static_cast<uint8_t>(length);
+  return i;
+}
+
+std::unique_ptr<std::string> LengthFieldProtocol::Encode(const char* data, std::size_t size) const {
+  char header[MAX_HEADER];
+  std::size_t headerSize = EncodeHeader(size, header);
+  std::unique_ptr<std::string> buffer(new std::string());
+  buffer->reserve(headerSize + size);
+  buffer->append(header, headerSize);
+  buffer->append(data, size);
+  return buffer;
+}
+
+void LengthFieldProtocol::Send(const bamboo::net::SocketPtr& so, const char* data, std::size_t size) const {
+  so->WriteData(Encode(data, size));
+}
+
+}
+}
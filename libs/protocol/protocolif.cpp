@@ -7,5 +7,9 @@ ProtocolIf::ProtocolIf() {}
 
 ProtocolIf::~ProtocolIf() {}
 
+void ProtocolIf::OnConnect(bamboo::net::SocketPtr socket) {}
+
+void ProtocolIf::OnClose(bamboo::net::SocketPtr socket) {}
+
 }
 }
\ No newline at end of file
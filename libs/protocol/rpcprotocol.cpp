@@ -0,0 +1,228 @@
+#include "bamboo/protocol/rpcprotocol.hpp"
+
+#include <cstring>
+
+namespace bamboo {
+namespace protocol {
+
+const std::size_t RpcProtocol::REQUEST_HEAD;
+const std::size_t RpcProtocol::RESPONSE_HEAD;
+
+namespace {
+
+void PutUint(char* out, uint64_t value, std::size_t size) {
+  for (std::size_t i = 0; i < size; ++i) {
+    out[size - 1 - i] = static_cast<char>(value >> (8 * i));
+  }
+}
+
+uint64_t GetUint(const char* data, std::size_t size) {
+  uint64_t value = 0;
+  for (std::size_t i = 0; i < size; ++i) {
+    value = (value << 8) | static_cast<uint8_t>(data[i]);
+  }
+  return value;
+}
+
+}
+
+RpcProtocol::RpcProtocol(bamboo::schedule::Scheduler& scheduler,
+                         const LengthFieldProtocol::Option& option) : scheduler_(scheduler),
+                                                                      framer_(option) {
+  framer_.SetFrameHandler([this](bamboo::net::SocketPtr so, const std::vector<LengthFieldProtocol::Frame>& frames) {
+    HandleFrames(so, frames);
+  });
+}
+
+RpcProtocol::~RpcProtocol() {
+  for (auto& it : pending_) {
+    if (it.second.timer != 0) scheduler_.Cancel(it.second.timer);
+  }
+}
+
+std::size_t RpcProtocol::ReceiveData(bamboo::net::SocketPtr so, const char* data, std::size_t size) {
+  return framer_.ReceiveData(so, data, size);
+}
+
+void RpcProtocol::OnClose(bamboo::net::SocketPtr so) {
+  auto it = inflight_.find(so->GetId());
+  if (it == inflight_.end()) return;
+
+  auto ids = std::move(it->second);
+  inflight_.erase(it);
+  for (auto id : ids) {
+    Finish(id, Status::CLOSED, nullptr, 0);
+  }
+}
+
+void RpcProtocol::Register(const std::string& method, MethodHandler&& handler) {
+  BB_ASSERT(method.size() <= UINT8_MAX);
+  methods_[method] = std::move(handler);
+}
+
+bool RpcProtocol::Call(const bamboo::net::SocketPtr& so, const std::string& method, const char* data, std::size_t size,
+                       ResponseHandler&& handler, std::time_t timeout) {
+  if (!so || !so->is_open() || method.size() > UINT8_MAX) return false;
+
+  uint64_t id = ++nextId_;
+  // 固定头部和方法名都放在栈上，和内容一起拼成一帧
+  char head[REQUEST_HEAD + UINT8_MAX];
+  head[0] = static_cast<char>(Type::REQUEST);
+  PutUint(head + 1, id, 8);
+  PutUint(head + 9, timeout > 0 ? static_cast<uint64_t>(std::min<std::time_t>(timeout, UINT32_MAX)) : 0, 4);
+  head[13] = static_cast<char>(method.size());
+  std::memcpy(head + REQUEST_HEAD, method.data(), method.size());
+
+  Pending pending;
+  pending.socket = so->GetId();
+  pending.handler = std::move(handler);
+  if (timeout > 0) {
+    pending.timer = scheduler_.Timeout([this, id]() {
+      auto it = pending_.find(id);
+      if (it == pending_.end()) return;
+      it->second.timer = 0;
+      Finish(id, Status::TIMEOUT, nullptr, 0);
+    }, timeout);
+  }
+  pending_[id] = std::move(pending);
+  inflight_[so->GetId()].insert(id);
+
+  Send(so, head, REQUEST_HEAD + method.size(), data, size);
+  return true;
+}
+
+bool RpcProtocol::Call(const bamboo::net::ConnectionPoolPtr& pool, const std::string& method, const char* data,
+                       std::size_t size, ResponseHandler&& handler, std::time_t timeout) {
+  if (!pool) return false;
+  auto so = pool->Select();
+  if (!so) return false;
+
+  pool->Begin(so);
+  std::weak_ptr<bamboo::net::ConnectionPool> weak = pool;
+  auto callback = std::make_shared<ResponseHandler>(std::move(handler));
+  bool sent = Call(so, method, data, size, [weak, so, callback](Status status, const char* data, std::size_t size) {
+    auto pool = weak.lock();
+    if (pool) pool->End(so);
+    if (*callback) (*callback)(status, data, size);
+  }, timeout);
+  if (!sent) pool->End(so);
+  return sent;
+}
+
+std::size_t RpcProtocol::GetPendingSize() const {
+  return pending_.size();
+}
+
+void RpcProtocol::HandleFrames(const bamboo::net::SocketPtr& so, const std::vector<LengthFieldProtocol::Frame>& frames) {
+  for (auto& frame : frames) {
+    if (frame.size < 1) continue;
+    auto type = static_cast<Type>(frame.data[0]);
+    if (type == Type::REQUEST) {
+      HandleRequest(so, frame.data, frame.size);
+    } else if (type == Type::RESPONSE) {
+      HandleResponse(so, frame.data, frame.size);
+    } else {
+      BB_ERROR_LOG("socket[%llu] unknown rpc frame type:%d", so ? so->GetId() : 0, static_cast<int>(type));
+    }
+  }
+}
+
+void RpcProtocol::HandleRequest(const bamboo::net::SocketPtr& so, const char* data, std::size_t size) {
+  if (size < REQUEST_HEAD || size < REQUEST_HEAD + static_cast<uint8_t>(data[13])) {
+    BB_ERROR_LOG("socket[%llu] broken rpc request", so ? so->GetId() : 0);
+    return;
+  }
+
+  Request request;
+  request.id = GetUint(data + 1, 8);
+  uint64_t timeout = GetUint(data + 9, 4);
+  request.methodSize = static_cast<uint8_t>(data[13]);
+  request.method = data + REQUEST_HEAD;
+  request.data = request.method + request.methodSize;
+  request.size = size - REQUEST_HEAD - request.methodSize;
+  request.deadline = timeout > 0 ? std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout)
+                                 : std::chrono::steady_clock::time_point::max();
+
+  auto it = methods_.find(std::string(request.method, request.methodSize));
+  if (it == methods_.end() || !it->second) {
+    Respond(so, request.id, Status::NO_METHOD, nullptr, 0);
+    return;
+  }
+
+  std::weak_ptr<RpcProtocol> weakSelf = shared_from_this();
+  std::weak_ptr<bamboo::net::SocketIf> weakSocket = so;
+  uint64_t id = request.id;
+  auto deadline = request.deadline;
+  auto done = std::make_shared<bool>(false);
+  it->second(so, request, [weakSelf, weakSocket, id, deadline, done](Status status, const char* data,
+                                                                       std::size_t size) {
+    if (*done) return;
+    *done = true;
+    // 客户端已经按超时处理，回复也没有用
+    if (std::chrono::steady_clock::now() >= deadline) return;
+    auto self = weakSelf.lock();
+    auto so = weakSocket.lock();
+    if (!self || !so || !so->is_open()) return;
+    self->Respond(so, id, status, data, size);
+  });
+}
+
+void RpcProtocol::HandleResponse(const bamboo::net::SocketPtr& so, const char* data, std::size_t size) {
+  if (size < RESPONSE_HEAD) {
+    BB_ERROR_LOG("socket[%llu] broken rpc response", so ? so->GetId() : 0);
+    return;
+  }
+
+  uint64_t id = GetUint(data + 1, 8);
+  auto status = static_cast<Status>(data[9]);
+  // 编号只在发出请求的链接上有效，其他链接上的同号回复直接丢弃
+  auto it = pending_.find(id);
+  if (it != pending_.end() && (!so || it->second.socket != so->GetId())) {
+    BB_ERROR_LOG("socket[%llu] rpc response %llu belongs to socket[%llu]", so ? so->GetId() : 0, id,
+                 it->second.socket);
+    return;
+  }
+  // 超时或者链接关闭后才到的回复已经没有等待者
+  Finish(id, status, data + RESPONSE_HEAD, size - RESPONSE_HEAD);
+}
+
+void RpcProtocol::Finish(uint64_t id, Status status, const char* data, std::size_t size) {
+  auto it = pending_.find(id);
+  if (it == pending_.end()) return;
+
+  auto pending = std::move(it->second);
+  pending_.erase(it);
+  if (pending.timer != 0) scheduler_.Cancel(pending.timer);
+  auto inflight = inflight_.find(pending.socket);
+  if (inflight != inflight_.end()) {
+    inflight->second.erase(id);
+    if (inflight->second.empty()) inflight_.erase(inflight);
+  }
+
+  if (pending.handler) pending.handler(status, data, size);
+}
+
+void RpcProtocol::Send(const bamboo::net::SocketPtr& so, const char* head, std::size_t headSize,
+                       const char* data, std::size_t size) {
+  char header[LengthFieldProtocol::MAX_HEADER];
+  std::size_t headerSize = framer_.EncodeHeader(headSize + size, header);
+
+  std::unique_ptr<std::string> buffer(new std::string());
+  buffer->reserve(headerSize + headSize + size);
+  buffer->append(header, headerSize);
+  buffer->append(head, headSize);
+  buffer->append(data, size);
+  so->WriteData(std::move(buffer));
+}
+
+void RpcProtocol::Respond(const bamboo::net::SocketPtr& so, uint64_t id, Status status,
+                          const char* data, std::size_t size) {
+  char head[RESPONSE_HEAD];
+  head[0] = static_cast<char>(Type::RESPONSE);
+  PutUint(head + 1, id, 8);
+  head[9] = static_cast<char>(status);
+  Send(so, head, RESPONSE_HEAD, data, size);
+}
+
+}
+}
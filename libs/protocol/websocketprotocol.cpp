@@ -0,0 +1,645 @@
+#include "bamboo/protocol/websocketprotocol.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include <boost/algorithm/string/predicate.hpp>
+#include <boost/beast/zlib/deflate_stream.hpp>
+#include <boost/beast/zlib/inflate_stream.hpp>
+#include <boost/uuid/detail/sha1.hpp>
+
+namespace bamboo {
+namespace protocol {
+
+const std::size_t WebSocketProtocol::MAX_HEADER;
+
+namespace {
+
+const char GUID[] = "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+
+/// 压缩后去掉、解压前补上的同步刷新标记
+const char DEFLATE_TAIL[] = {'\x00', '\x00', '\xff', '\xff'};
+
+std::string Base64(const unsigned char* data, std::size_t size) {
+  static const char TABLE[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+  std::string out;
+  out.reserve((size + 2) / 3 * 4);
+  for (std::size_t i = 0; i < size; i += 3) {
+    uint32_t n = static_cast<uint32_t>(data[i]) << 16;
+    if (i + 1 < size) n |= static_cast<uint32_t>(data[i + 1]) << 8;
+    if (i + 2 < size) n |= data[i + 2];
+    out.push_back(TABLE[(n >> 18) & 0x3f]);
+    out.push_back(TABLE[(n >> 12) & 0x3f]);
+    out.push_back(i + 1 < size ? TABLE[(n >> 6) & 0x3f] : '=');
+    out.push_back(i + 2 < size ? TABLE[n & 0x3f] : '=');
+  }
+  return out;
+}
+
+/// 校验 utf-8 编码，ascii 部分每次检查8字节
+bool ValidUtf8(const char* text, std::size_t size) {
+  auto data = reinterpret_cast<const unsigned char*>(text);
+  std::size_t i = 0;
+  while (i < size) {
+    if (i + 8 <= size) {
+      uint64_t word;
+      std::memcpy(&word, data + i, 8);
+      if ((word & 0x8080808080808080ull) == 0) {
+        i += 8;
+        continue;
+      }
+    }
+
+    unsigned char c = data[i];
+    std::size_t length;
+    uint32_t code;
+    if (c < 0x80) {
+      ++i;
+      continue;
+    } else if ((c & 0xe0) == 0xc0) {
+      length = 2;
+      code = c & 0x1f;
+    } else if ((c & 0xf0) == 0xe0) {
+      length = 3;
+      code = c & 0x0f;
+    } else if ((c & 0xf8) == 0xf0) {
+      length = 4;
+      code = c & 0x07;
+    } else {
+      return false;
+    }
+    if (i + length > size) return false;
+    for (std::size_t j = 1; j < length; ++j) {
+      if ((data[i + j] & 0xc0) != 0x80) return false;
+      code = (code << 6) | (data[i + j] & 0x3f);
+    }
+    // 过长编码、代理区和超出范围的码点
+    if ((length == 2 && code < 0x80) || (length == 3 && code < 0x800) || (length == 4 && code < 0x10000) ||
+        (code >= 0xd800 && code <= 0xdfff) || code > 0x10ffff) {
+      return false;
+    }
+    i += length;
+  }
+  return true;
+}
+
+bool ValidCloseCode(uint16_t code) {
+  if (code >= 3000 && code <= 4999) return true;
+  return (code >= 1000 && code <= 1003) || (code >= 1007 && code <= 1011);
+}
+
+bool IsControl(uint8_t opcode) {
+  return (opcode & 0x8) != 0;
+}
+
+}
+
+struct WebSocketProtocol::Connection {
+  enum class State {
+    HANDSHAKE,
+    OPEN,
+    CLOSED, /**< 已经发送 close 或者握手失败，丢弃后面的数据 */
+  };
+
+  State state{State::HANDSHAKE};
+  /// 是否协商了 permessage-deflate
+  bool deflate{false};
+  /// 是否正在接收分片的消息
+  bool fragmented{false};
+  /// 当前消息是否压缩
+  bool compressed{false};
+  Opcode opcode{Opcode::TEXT};
+  /// 去掉掩码后的消息内容，分片时逐帧追加
+  std::string message;
+  /// 客户端可以使用上下文，每个链接一个解压流，第一次收到压缩消息时创建
+  std::unique_ptr<boost::beast::zlib::inflate_stream> inflater;
+  std::string inflated;
+};
+
+WebSocketProtocol::WebSocketProtocol() {}
+
+WebSocketProtocol::WebSocketProtocol(const Option& option) : option_(option) {
+  if (option_.windowBits < 9) option_.windowBits = 9;
+  if (option_.windowBits > 15) option_.windowBits = 15;
+}
+
+WebSocketProtocol::~WebSocketProtocol() {}
+
+void WebSocketProtocol::SetAcceptHandler(AcceptHandler&& handler) {
+  acceptor_ = std::move(handler);
+}
+
+void WebSocketProtocol::SetMessageHandler(MessageHandler&& handler) {
+  messenger_ = std::move(handler);
+}
+
+void WebSocketProtocol::SetCloseHandler(CloseHandler&& handler) {
+  closer_ = std::move(handler);
+}
+
+const WebSocketProtocol::Option& WebSocketProtocol::GetOption() const {
+  return option_;
+}
+
+void WebSocketProtocol::OnConnect(bamboo::net::SocketPtr so) {
+  connections_[so->GetId()] = std::make_shared<Connection>();
+}
+
+void WebSocketProtocol::OnClose(bamboo::net::SocketPtr so) {
+  auto it = connections_.find(so->GetId());
+  if (it == connections_.end()) return;
+  auto connection = it->second;
+  connections_.erase(it);
+
+  if (connection->state == Connection::State::OPEN) {
+    --openSize_;
+    connection->state = Connection::State::CLOSED;
+    if (closer_) closer_(so, 1006);
+  }
+}
+
+std::size_t WebSocketProtocol::ReceiveData(bamboo::net::SocketPtr so, const char* data, std::size_t size) {
+  auto it = connections_.find(so->GetId());
+  if (it == connections_.end()) {
+    OnConnect(so);
+    it = connections_.find(so->GetId());
+  }
+  // 处理函数中可能关闭链接，保持连接状态到处理结束
+  auto connection = it->second;
+
+  std::size_t offset = 0;
+  if (connection->state == Connection::State::HANDSHAKE) {
+    offset = Handshake(so, *connection, data, size);
+    if (connection->state != Connection::State::OPEN) return offset;
+  }
+  if (connection->state == Connection::State::OPEN) {
+    offset += ReadFrames(so, *connection, data + offset, size - offset);
+  }
+  return connection->state == Connection::State::CLOSED ? size : offset;
+}
+
+std::size_t WebSocketProtocol::Handshake(const bamboo::net::SocketPtr& so, Connection& connection,
+                                         const char* data, std::size_t size) {
+  long length = HttpProtocol::Parse(data, size, request_, 0);
+  if (length == 0) return 0;
+
+  connection.state = Connection::State::CLOSED;
+  if (length < 0) {
+    Reject(so, length == -1 ? 400 : static_cast<int>(-length));
+    return size;
+  }
+
+  if (!option_.path.empty() && request_.path != option_.path) {
+    Reject(so, 404);
+    return size;
+  }
+  boost::string_view key = request_.Get("Sec-WebSocket-Key");
+  if (request_.method != "GET" || request_.minorVersion < 1 || request_.Get("Host").empty() ||
+      !request_.HasToken("Upgrade", "websocket") || !request_.HasToken("Connection", "upgrade") || key.size() != 24) {
+    Reject(so, 400);
+    return size;
+  }
+  if (request_.Get("Sec-WebSocket-Version") != "13") {
+    Reject(so, 426, "Sec-WebSocket-Version: 13\r\n");
+    return size;
+  }
+  if (acceptor_ && !acceptor_(so, request_)) {
+    Reject(so, 403);
+    return size;
+  }
+
+  // 选择第一个可以接受的 permessage-deflate 参数
+  bool deflate = false;
+  for (auto& header : request_.headers) {
+    if (!option_.deflate || deflate) break;
+    if (header.name.size() != 24 || !boost::algorithm::iequals(header.name, "Sec-WebSocket-Extensions")) continue;
+
+    boost::string_view offers = header.value;
+    while (!offers.empty() && !deflate) {
+      std::size_t comma = offers.find(',');
+      boost::string_view offer = offers.substr(0, comma);
+      offers = comma == boost::string_view::npos ? boost::string_view() : offers.substr(comma + 1);
+
+      bool first = true;
+      bool acceptable = true;
+      while (!offer.empty()) {
+        std::size_t semicolon = offer.find(';');
+        boost::string_view param = offer.substr(0, semicolon);
+        offer = semicolon == boost::string_view::npos ? boost::string_view() : offer.substr(semicolon + 1);
+        while (!param.empty() && (param.front() == ' ' || param.front() == '\t')) param.remove_prefix(1);
+        while (!param.empty() && (param.back() == ' ' || param.back() == '\t')) param.remove_suffix(1);
+
+        std::size_t equal = param.find('=');
+        boost::string_view name = param.substr(0, equal);
+        boost::string_view value = equal == boost::string_view::npos ? boost::string_view() : param.substr(equal + 1);
+        if (!value.empty() && value.front() == '"' && value.size() >= 2) value = value.substr(1, value.size() - 2);
+
+        if (first) {
+          acceptable = name == "permessage-deflate";
+          first = false;
+        } else if (name == "server_max_window_bits") {
+          // 服务端的窗口不能超过客户端要求的大小
+          int bits = value.size() == 2 ? (value[0] - '0') * 10 + (value[1] - '0') : value.size() == 1 ? value[0] - '0' : 0;
+          if (bits < option_.windowBits || bits > 15) acceptable = false;
+        } else if (name != "server_no_context_takeover" && name != "client_no_context_takeover" &&
+                   name != "client_max_window_bits") {
+          acceptable = false;
+        }
+        if (!acceptable) break;
+      }
+      deflate = acceptable && !first;
+    }
+  }
+
+  std::unique_ptr<std::string> response(new std::string());
+  response->reserve(256);
+  response->append("HTTP/1.1 101 Switching Protocols\r\n"
+                   "Upgrade: websocket\r\n"
+                   "Connection: Upgrade\r\n"
+                   "Sec-WebSocket-Accept: ");
+  response->append(AcceptKey(key));
+  response->append("\r\n", 2);
+  if (deflate) response->append("Sec-WebSocket-Extensions: permessage-deflate; server_no_context_takeover\r\n");
+  response->append("\r\n", 2);
+  so->WriteData(std::move(response));
+
+  connection.state = Connection::State::OPEN;
+  connection.deflate = deflate;
+  ++openSize_;
+  return static_cast<std::size_t>(length);
+}
+
+void WebSocketProtocol::Reject(const bamboo::net::SocketPtr& so, int status, const char* extra) {
+  BB_DEBUG_LOG("reject websocket handshake:%d", status);
+  std::unique_ptr<std::string> response(new std::string("HTTP/1.1 "));
+  response->append(std::to_string(status));
+  response->append(status == 426 ? " Upgrade Required\r\n" : " Rejected\r\n");
+  response->append(extra);
+  response->append("Content-Length: 0\r\nConnection: close\r\n\r\n");
+  so->WriteData(std::move(response));
+  so->CloseAfterFlush();
+}
+
+std::size_t WebSocketProtocol::ReadFrames(const bamboo::net::SocketPtr& so, Connection& connection,
+                                          const char* data, std::size_t size) {
+  std::size_t offset = 0;
+  while (connection.state == Connection::State::OPEN && size - offset >= 2) {
+    auto frame = reinterpret_cast<const unsigned char*>(data + offset);
+    std::size_t available = size - offset;
+
+    bool fin = (frame[0] & 0x80) != 0;
+    bool rsv1 = (frame[0] & 0x40) != 0;
+    uint8_t opcode = frame[0] & 0x0f;
+    bool masked = (frame[1] & 0x80) != 0;
+    uint64_t length = frame[1] & 0x7f;
+    std::size_t header = 2;
+    if (length == 126) {
+      if (available < 4) break;
+      length = (static_cast<uint64_t>(frame[2]) << 8) | frame[3];
+      header = 4;
+    } else if (length == 127) {
+      if (available < 10) break;
+      length = 0;
+      for (std::size_t i = 0; i < 8; ++i) length = (length << 8) | frame[2 + i];
+      header = 10;
+    }
+
+    // 客户端的帧必须带掩码，保留位只有压缩的第一帧可以使用 rsv1
+    bool known = opcode <= 0x2 || (opcode >= 0x8 && opcode <= 0xa);
+    if (!masked || (frame[0] & 0x30) != 0 || !known) {
+      Fail(so, connection, 1002);
+      break;
+    }
+    if (IsControl(opcode)) {
+      if (!fin || rsv1 || length > 125) {
+        Fail(so, connection, 1002);
+        break;
+      }
+    } else if (static_cast<Opcode>(opcode) == Opcode::CONTINUATION) {
+      if (!connection.fragmented || rsv1) {
+        Fail(so, connection, 1002);
+        break;
+      }
+    } else if (connection.fragmented || (rsv1 && !connection.deflate)) {
+      Fail(so, connection, 1002);
+      break;
+    }
+    std::size_t received = connection.fragmented ? connection.message.size() : 0;
+    if (!IsControl(opcode) && length > option_.maxMessage - std::min(option_.maxMessage, received)) {
+      Fail(so, connection, 1009);
+      break;
+    }
+
+    header += 4;
+    if (available < header + length) break;
+    const char* key = data + offset + header - 4;
+    const char* payload = data + offset + header;
+    offset += header + static_cast<std::size_t>(length);
+
+    if (IsControl(opcode)) {
+      char control[125];
+      Unmask(control, payload, length, key);
+
+      if (static_cast<Opcode>(opcode) == Opcode::PING) {
+        Send(so, Opcode::PONG, control, length);
+      } else if (static_cast<Opcode>(opcode) == Opcode::CLOSE) {
+        uint16_t code = 1005;
+        if (length == 1) {
+          Fail(so, connection, 1002);
+          break;
+        }
+        if (length >= 2) {
+          code = static_cast<uint16_t>((static_cast<unsigned char>(control[0]) << 8) | static_cast<unsigned char>(control[1]));
+          if (!ValidCloseCode(code) || !ValidUtf8(control + 2, length - 2)) {
+            Fail(so, connection, ValidCloseCode(code) ? 1007 : 1002);
+            break;
+          }
+        }
+        // 回复 close 后关闭，回复中带上对方的关闭码
+        char reply[2] = {static_cast<char>(code >> 8), static_cast<char>(code & 0xff)};
+        std::unique_ptr<std::string> out(new std::string());
+        EncodeTo(*out, Opcode::CLOSE, reply, code == 1005 ? 0 : 2, false);
+        so->WriteData(std::move(out));
+        so->CloseAfterFlush();
+        connection.state = Connection::State::CLOSED;
+        --openSize_;
+        if (closer_) closer_(so, code);
+      }
+      continue;
+    }
+
+    if (static_cast<Opcode>(opcode) != Opcode::CONTINUATION) {
+      connection.opcode = static_cast<Opcode>(opcode);
+      connection.compressed = rsv1;
+      connection.message.clear();
+    }
+    std::size_t used = connection.message.size();
+    connection.message.resize(used + length);
+    Unmask(&connection.message[used], payload, length, key);
+
+    connection.fragmented = !fin;
+    if (fin && !Deliver(so, connection)) break;
+  }
+  return offset;
+}
+
+bool WebSocketProtocol::Deliver(const bamboo::net::SocketPtr& so, Connection& connection) {
+  const char* data = connection.message.data();
+  std::size_t size = connection.message.size();
+
+  if (connection.compressed) {
+    if (!connection.inflater) {
+      connection.inflater.reset(new boost::beast::zlib::inflate_stream());
+      connection.inflater->reset(15);
+    }
+    connection.message.append(DEFLATE_TAIL, sizeof(DEFLATE_TAIL));
+
+    boost::beast::zlib::z_params zs;
+    zs.next_in = connection.message.data();
+    zs.avail_in = connection.message.size();
+    connection.inflated.clear();
+    while (true) {
+      std::size_t used = connection.inflated.size();
+      if (used > option_.maxMessage) {
+        Fail(so, connection, 1009);
+        return false;
+      }
+      connection.inflated.resize(std::max<std::size_t>(used * 2, used + 4096));
+      zs.next_out = &connection.inflated[used];
+      zs.avail_out = connection.inflated.size() - used;
+
+      boost::system::error_code ec;
+      connection.inflater->write(zs, boost::beast::zlib::Flush::sync, ec);
+      connection.inflated.resize(connection.inflated.size() - zs.avail_out);
+      if (ec == boost::beast::zlib::error::end_of_stream) {
+        // 客户端结束了压缩流，下一条消息重新开始
+        connection.inflater->reset(15);
+        break;
+      }
+      if (ec && ec != boost::beast::zlib::error::need_buffers) {
+        Fail(so, connection, 1007);
+        return false;
+      }
+      if (zs.avail_in == 0 && zs.avail_out > 0) break;
+    }
+    if (connection.inflated.size() > option_.maxMessage) {
+      Fail(so, connection, 1009);
+      return false;
+    }
+    data = connection.inflated.data();
+    size = connection.inflated.size();
+  }
+
+  if (connection.opcode == Opcode::TEXT && !ValidUtf8(data, size)) {
+    Fail(so, connection, 1007);
+    return false;
+  }
+  if (messenger_) messenger_(so, connection.opcode, data, size);
+  return connection.state == Connection::State::OPEN;
+}
+
+void WebSocketProtocol::Fail(const bamboo::net::SocketPtr& so, Connection& connection, uint16_t code) {
+  BB_DEBUG_LOG("websocket protocol error:%u", code);
+  Close(so, code);
+}
+
+bool WebSocketProtocol::Send(bamboo::net::SocketPtr so, Opcode opcode, const char* data, std::size_t size) {
+  auto it = connections_.find(so->GetId());
+  if (it == connections_.end() || it->second->state != Connection::State::OPEN) return false;
+
+  std::unique_ptr<std::string> out(new std::string());
+  if (ShouldCompress(*it->second, opcode, size)) {
+    Deflate(data, size, deflated_);
+    EncodeTo(*out, opcode, deflated_.data(), deflated_.size(), true);
+  } else {
+    EncodeTo(*out, opcode, data, size, false);
+  }
+  so->WriteData(std::move(out));
+  return true;
+}
+
+void WebSocketProtocol::Close(bamboo::net::SocketPtr so, uint16_t code, const std::string& reason) {
+  auto it = connections_.find(so->GetId());
+  if (it == connections_.end() || it->second->state != Connection::State::OPEN) return;
+  auto connection = it->second;
+
+  std::string payload;
+  payload.push_back(static_cast<char>(code >> 8));
+  payload.push_back(static_cast<char>(code & 0xff));
+  payload.append(reason, 0, 123);
+  std::unique_ptr<std::string> out(new std::string());
+  EncodeTo(*out, Opcode::CLOSE, payload.data(), payload.size(), false);
+  so->WriteData(std::move(out));
+  so->CloseAfterFlush();
+
+  connection->state = Connection::State::CLOSED;
+  --openSize_;
+  if (closer_) closer_(so, code);
+}
+
+std::size_t WebSocketProtocol::Broadcast(bamboo::net::ConnManagerIf& manager, Opcode opcode, const char* data,
+                                         std::size_t size, bamboo::net::ConnManagerIf::SocketFilter&& filter) {
+  bamboo::net::ConstBufferPtr plain = Encode(opcode, data, size, false);
+  bamboo::net::ConstBufferPtr compressed;
+  if (option_.deflate && !IsControl(static_cast<uint8_t>(opcode)) && size >= option_.deflateThreshold) {
+    compressed = Encode(opcode, data, size, true);
+  }
+
+  auto select = [this, &filter](const bamboo::net::SocketPtr& so, bool deflate) -> bool {
+    auto it = connections_.find(so->GetId());
+    if (it == connections_.end() || it->second->state != Connection::State::OPEN) return false;
+    if (it->second->deflate != deflate) return false;
+    return !filter || filter(so);
+  };
+
+  if (!compressed) {
+    return manager.Broadcast(plain, [&select](const bamboo::net::SocketPtr& so) {
+      return select(so, false) || select(so, true);
+    });
+  }
+  std::size_t count = manager.Broadcast(plain, [&select](const bamboo::net::SocketPtr& so) {
+    return select(so, false);
+  });
+  count += manager.Broadcast(compressed, [&select](const bamboo::net::SocketPtr& so) {
+    return select(so, true);
+  });
+  return count;
+}
+
+bamboo::net::ConstBufferPtr WebSocketProtocol::Encode(Opcode opcode, const char* data, std::size_t size,
+                                                      bool compress) {
+  auto out = std::make_shared<std::string>();
+  if (compress && !IsControl(static_cast<uint8_t>(opcode))) {
+    Deflate(data, size, deflated_);
+    EncodeTo(*out, opcode, deflated_.data(), deflated_.size(), true);
+  } else {
+    EncodeTo(*out, opcode, data, size, false);
+  }
+  return out;
+}
+
+void WebSocketProtocol::EncodeTo(std::string& out, Opcode opcode, const char* data, std::size_t size,
+                                 bool compressed) const {
+  char header[MAX_HEADER];
+  std::size_t length = 2;
+  header[0] = static_cast<char>(0x80 | (compressed ? 0x40 : 0) | static_cast<uint8_t>(opcode));
+  if (size < 126) {
+    header[1] = static_cast<char>(size);
+  } else if (size <= 0xffff) {
+    header[1] = 126;
+    header[2] = static_cast<char>(size >> 8);
+    header[3] = static_cast<char>(size & 0xff);
+    length = 4;
+  } else {
+    header[1] = 127;
+    for (std::size_t i = 0; i < 8; ++i) header[2 + i] = static_cast<char>((static_cast<uint64_t>(size) >> (56 - i * 8)) & 0xff);
+    length = 10;
+  }
+
+  out.reserve(out.size() + length + size);
+  out.append(header, length);
+  out.append(data, size);
+}
+
+void WebSocketProtocol::Deflate(const char* data, std::size_t size, std::string& out) {
+  if (!deflater_) {
+    deflater_.reset(new boost::beast::zlib::deflate_stream());
+    deflater_->reset(option_.deflateLevel, option_.windowBits, 8, boost::beast::zlib::Strategy::normal);
+  } else {
+    // server_no_context_takeover，每条消息独立压缩
+    deflater_->reset();
+  }
+
+  boost::beast::zlib::z_params zs;
+  zs.next_in = data;
+  zs.avail_in = size;
+  out.resize(size + 64);
+  std::size_t used = 0;
+  while (true) {
+    zs.next_out = &out[used];
+    zs.avail_out = out.size() - used;
+    boost::system::error_code ec;
+    deflater_->write(zs, boost::beast::zlib::Flush::sync, ec);
+    used = out.size() - zs.avail_out;
+    if (zs.avail_in == 0 && zs.avail_out > 6) break;
+    out.resize(out.size() * 2);
+  }
+  out.resize(used);
+
+  if (out.size() >= sizeof(DEFLATE_TAIL) &&
+      std::memcmp(out.data() + out.size() - sizeof(DEFLATE_TAIL), DEFLATE_TAIL, sizeof(DEFLATE_TAIL)) == 0) {
+    out.resize(out.size() - sizeof(DEFLATE_TAIL));
+  }
+}
+
+bool WebSocketProtocol::ShouldCompress(const Connection& connection, Opcode opcode, std::size_t size) const {
+  return connection.deflate && !IsControl(static_cast<uint8_t>(opcode)) && size >= option_.deflateThreshold;
+}
+
+bool WebSocketProtocol::IsOpen(const bamboo::net::SocketPtr& so) const {
+  auto it = connections_.find(so->GetId());
+  return it != connections_.end() && it->second->state == Connection::State::OPEN;
+}
+
+std::size_t WebSocketProtocol::GetOpenSize() const {
+  return openSize_;
+}
+
+std::string WebSocketProtocol::AcceptKey(boost::string_view key) {
+  boost::uuids::detail::sha1 sha1;
+  sha1.process_bytes(key.data(), key.size());
+  sha1.process_bytes(GUID, sizeof(GUID) - 1);
+  unsigned int digest[5];
+  sha1.get_digest(digest);
+
+  unsigned char bytes[20];
+  for (std::size_t i = 0; i < 5; ++i) {
+    bytes[i * 4] = static_cast<unsigned char>(digest[i] >> 24);
+    bytes[i * 4 + 1] = static_cast<unsigned char>(digest[i] >> 16);
+    bytes[i * 4 + 2] = static_cast<unsigned char>(digest[i] >> 8);
+    bytes[i * 4 + 3] = static_cast<unsigned char>(digest[i]);
+  }
+  return Base64(bytes, sizeof(bytes));
+}
+
+void WebSocketProtocol::Unmask(char* dst, const char* src, std::size_t size, const char* key, std::size_t offset) {
+  // 按偏移旋转掩码，之后每个4字节对齐的位置都从掩码的第一个字节开始
+  char rotated[4];
+  for (std::size_t i = 0; i < 4; ++i) rotated[i] = key[(offset + i) & 3];
+  uint32_t mask32;
+  std::memcpy(&mask32, rotated, 4);
+
+  std::size_t i = 0;
+#if defined(__SSE2__)
+  const __m128i mask128 = _mm_set1_epi32(static_cast<int>(mask32));
+  for (; i + 64 <= size; i += 64) {
+    __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 16));
+    __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 32));
+    __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 48));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_xor_si128(a, mask128));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i + 16), _mm_xor_si128(b, mask128));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i + 32), _mm_xor_si128(c, mask128));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i + 48), _mm_xor_si128(d, mask128));
+  }
+  for (; i + 16 <= size; i += 16) {
+    __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_xor_si128(a, mask128));
+  }
+#endif
+  const uint64_t mask64 = static_cast<uint64_t>(mask32) | (static_cast<uint64_t>(mask32) << 32);
+  for (; i + 8 <= size; i += 8) {
+    uint64_t word;
+    std::memcpy(&word, src + i, 8);
+    word ^= mask64;
+    std::memcpy(dst + i, &word, 8);
+  }
+  for (; i < size; ++i) dst[i] = src[i] ^ rotated[i & 3];
+}
+
+}
+}
@@ -1,11 +1,19 @@
 #include "bamboo/schedule/scheduler.hpp"
 
+#include <algorithm>
+
 #include "bamboo/log/log.hpp"
 
 namespace bamboo {
 namespace schedule {
 
-Scheduler::Scheduler(boost::asio::io_context& io) :io_(io) {}
+Scheduler::Scheduler(boost::asio::io_context& io, Engine engine) :io_(io), executor_(io), engine_(engine) {
+  if (engine_ == Engine::WHEEL) {
+    wheel_.reset(new TimingWheel());
+    tick_.reset(new boost::asio::steady_timer(io_));
+    start_ = std::chrono::steady_clock::now();
+  }
+}
 
 Scheduler::~Scheduler() {}
 
@@ -22,6 +30,15 @@ Scheduler::ID Scheduler::GenId() {
 }
 
 Scheduler::ID Scheduler::RegisterTimeout(Handler&& handler, std::time_t millisecond, bool isCycle) {
+  if (engine_ == Engine::WHEEL) {
+    uint64_t ms = millisecond > 0 ? static_cast<uint64_t>(millisecond) : 0;
+    // 时间轮只在定时器触发时推进，落后于当前时间的部分加到延迟上
+    uint64_t lag = Elapsed() - wheel_->Now();
+    auto id = wheel_->Add(std::move(handler), ms + lag, isCycle ? std::max<uint64_t>(ms, 1) : 0);
+    ArmWheel();
+    return id;
+  }
+
   auto id = GenId();
   if (id == 0) {
     BB_ERROR_LOG("schedule id == 0 ???");
@@ -34,6 +51,7 @@ Scheduler::ID Scheduler::RegisterTimeout(Handler&& handler, std::time_t millisec
   info->wait.expires_after(info->timeout);
 
   info->waitHandler = [this, id](const boost::system::error_code& ec) {
+    if (ec == boost::asio::error::operation_aborted) return;
     if (ec) {
       maps_.erase(id);
       BB_ERROR_LOG("schedule[%llu] error:%s", id, ec.message().c_str());
@@ -58,6 +76,11 @@ Scheduler::ID Scheduler::Heartbeat(Handler&& handler, std::time_t millisecond) {
 }
 
 void Scheduler::Cancel(Scheduler::ID id) {
+  if (engine_ == Engine::WHEEL) {
+    wheel_->Cancel(id);
+    return;
+  }
+
   auto it = maps_.find(id);
   if (it == maps_.end()) return;
   it->second->wait.cancel();
@@ -69,20 +92,61 @@ void Scheduler::HandleTimeout(Scheduler::ID id, bool first) {
   auto it = maps_.find(id);
   if (it == maps_.end()) return;
 
+  // 回调中可能取消自己，持有一份引用，回调后重新查找
+  auto info = it->second;
   if (!first) {
-    if (it->second->callback) {
-      it->second->callback();
+    if (info->callback) {
+      info->callback();
     }
 
-    if (it->second->isCycle) {
-      it->second->wait.expires_after(it->second->timeout);
-    } else {
+    if (!info->isCycle) {
       maps_.erase(id);
       return;
     }
+    if (maps_.find(id) == maps_.end()) return;
+    info->wait.expires_after(info->timeout);
+  }
+
+  info->wait.async_wait(boost::asio::bind_executor(executor_, info->waitHandler));
+}
+
+void Scheduler::SetExecutor(const bamboo::concurrency::Executor& executor) {
+  executor_ = executor;
+}
+
+std::size_t Scheduler::Size() const {
+  if (engine_ == Engine::WHEEL) return wheel_->Size();
+  return maps_.size();
+}
+
+uint64_t Scheduler::Elapsed() const {
+  auto elapsed = std::chrono::steady_clock::now() - start_;
+  return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count());
+}
+
+void Scheduler::ArmWheel() {
+  if (wheel_->Size() == 0) return;
+
+  uint64_t deadline = wheel_->Now() + wheel_->NextTick();
+  if (armed_ != 0 && armed_ <= deadline) return;
+
+  armed_ = deadline;
+  tick_->expires_at(start_ + std::chrono::milliseconds(deadline));
+  tick_->async_wait(boost::asio::bind_executor(executor_, [this](const boost::system::error_code& ec) {
+    if (ec == boost::asio::error::operation_aborted) return;
+    HandleWheel(ec);
+  }));
+}
+
+void Scheduler::HandleWheel(const boost::system::error_code& ec) {
+  if (ec) {
+    BB_ERROR_LOG("schedule wheel error:%s", ec.message().c_str());
   }
 
-  it->second->wait.async_wait(it->second->waitHandler);
+  armed_ = 0;
+  uint64_t now = Elapsed();
+  if (now > wheel_->Now()) wheel_->Advance(now - wheel_->Now());
+  ArmWheel();
 }
 
 }
@@ -0,0 +1,225 @@
+#include "bamboo/schedule/timingwheel.hpp"
+
+namespace bamboo {
+namespace schedule {
+
+const std::size_t TimingWheel::LEVELS;
+const std::size_t TimingWheel::SLOT_BITS;
+const std::size_t TimingWheel::SLOTS;
+const uint32_t TimingWheel::NIL;
+
+TimingWheel::TimingWheel() {
+  for (auto& wheel : wheels_) {
+    wheel.fill(NIL);
+  }
+  occupied_.fill(0);
+}
+
+TimingWheel::~TimingWheel() {}
+
+TimingWheel::ID TimingWheel::Add(Handler&& handler, uint64_t delay, uint64_t interval) {
+  uint32_t index = AllocNode();
+  Node& node = nodes_[index];
+  node.handler = std::move(handler);
+  node.interval = interval;
+  node.expire = current_ + (delay > 0 ? delay : 1);
+  Insert(index);
+  size_ += 1;
+  return (static_cast<ID>(node.generation) << 32) | index;
+}
+
+bool TimingWheel::Cancel(ID id) {
+  uint32_t index = static_cast<uint32_t>(id);
+  uint32_t generation = static_cast<uint32_t>(id >> 32);
+  if (index >= nodes_.size()) return false;
+
+  Node& node = nodes_[index];
+  if (node.generation != generation || node.place == Place::FREE || node.cancelled) return false;
+
+  size_ -= 1;
+  if (node.running) {
+    // 正在执行回调，回调结束后再释放
+    node.cancelled = true;
+    return true;
+  }
+
+  Unlink(index);
+  FreeNode(index);
+  return true;
+}
+
+std::size_t TimingWheel::Advance(uint64_t ticks) {
+  std::size_t fired = 0;
+  uint64_t target = current_ + ticks;
+  while (current_ < target) {
+    // 跳过中间的空槽位
+    uint64_t step = NextTick();
+    if (step == 0 || current_ + step > target) {
+      current_ = target;
+      break;
+    }
+
+    current_ += step;
+    if ((current_ & (SLOTS - 1)) == 0) {
+      for (std::size_t level = 1; level < LEVELS; ++level) {
+        Cascade(level);
+        if (((current_ >> (SLOT_BITS * level)) & (SLOTS - 1)) != 0) break;
+      }
+    }
+
+    uint32_t& slot = wheels_[0][current_ & (SLOTS - 1)];
+    if (slot != NIL) fired += Fire(slot);
+  }
+  return fired;
+}
+
+uint64_t TimingWheel::NextTick() const {
+  if (size_ == 0) return 0;
+
+  // 在第0层的占用位图中找下一个非空槽位，找不到时到一圈的末尾，需要把上层的节点降下来
+  std::size_t offset = current_ & (SLOTS - 1);
+  for (std::size_t pos = offset + 1; pos < SLOTS; pos = (pos | 63) + 1) {
+    uint64_t bits = occupied_[pos / 64] >> (pos % 64);
+    if (bits != 0) return pos + __builtin_ctzll(bits) - offset;
+  }
+  return SLOTS - offset;
+}
+
+void TimingWheel::Mark(std::size_t slot, bool occupied) {
+  if (occupied) {
+    occupied_[slot / 64] |= static_cast<uint64_t>(1) << (slot % 64);
+  } else {
+    occupied_[slot / 64] &= ~(static_cast<uint64_t>(1) << (slot % 64));
+  }
+}
+
+uint32_t TimingWheel::AllocNode() {
+  if (free_ != NIL) {
+    uint32_t index = free_;
+    free_ = nodes_[index].next;
+    nodes_[index].next = NIL;
+    return index;
+  }
+
+  nodes_.emplace_back();
+  return static_cast<uint32_t>(nodes_.size() - 1);
+}
+
+void TimingWheel::FreeNode(uint32_t index) {
+  Node& node = nodes_[index];
+  node.handler = nullptr;
+  node.generation += 1;
+  if (node.generation == 0) node.generation = 1;
+  node.place = Place::FREE;
+  node.running = false;
+  node.cancelled = false;
+  node.prev = NIL;
+  node.next = free_;
+  free_ = index;
+}
+
+void TimingWheel::Insert(uint32_t index) {
+  Node& node = nodes_[index];
+  uint64_t delta = node.expire > current_ ? node.expire - current_ : 0;
+
+  std::size_t level = 0;
+  while (level < LEVELS - 1 && delta >= (static_cast<uint64_t>(1) << (SLOT_BITS * (level + 1)))) {
+    ++level;
+  }
+  std::size_t slot = (node.expire >> (SLOT_BITS * level)) & (SLOTS - 1);
+
+  node.place = Place::WHEEL;
+  node.slot = static_cast<uint16_t>(level * SLOTS + slot);
+  PushFront(wheels_[level][slot], index);
+  if (level == 0) Mark(slot, true);
+}
+
+uint32_t& TimingWheel::Head(const Node& node) {
+  if (node.place == Place::FIRING) return firing_;
+  return wheels_[node.slot / SLOTS][node.slot % SLOTS];
+}
+
+void TimingWheel::PushFront(uint32_t& head, uint32_t index) {
+  Node& node = nodes_[index];
+  node.prev = NIL;
+  node.next = head;
+  if (head != NIL) nodes_[head].prev = index;
+  head = index;
+}
+
+void TimingWheel::Unlink(uint32_t index) {
+  Node& node = nodes_[index];
+  if (node.place != Place::WHEEL && node.place != Place::FIRING) return;
+
+  if (node.prev != NIL) {
+    nodes_[node.prev].next = node.next;
+  } else {
+    Head(node) = node.next;
+    if (node.next == NIL && node.place == Place::WHEEL && node.slot < SLOTS) Mark(node.slot, false);
+  }
+  if (node.next != NIL) nodes_[node.next].prev = node.prev;
+  node.prev = NIL;
+  node.next = NIL;
+}
+
+void TimingWheel::Cascade(std::size_t level) {
+  uint32_t& head = wheels_[level][(current_ >> (SLOT_BITS * level)) & (SLOTS - 1)];
+  uint32_t index = head;
+  head = NIL;
+  while (index != NIL) {
+    uint32_t next = nodes_[index].next;
+    Insert(index);
+    index = next;
+  }
+}
+
+std::size_t TimingWheel::Fire(uint32_t& list) {
+  // 先把整个槽位挪到执行链表上，回调里取消其他定时器时可以正常摘除
+  firing_ = list;
+  list = NIL;
+  Mark(current_ & (SLOTS - 1), false);
+  for (uint32_t index = firing_; index != NIL; index = nodes_[index].next) {
+    nodes_[index].place = Place::FIRING;
+  }
+
+  std::size_t fired = 0;
+  while (firing_ != NIL) {
+    uint32_t index = firing_;
+    Unlink(index);
+
+    Node& node = nodes_[index];
+    if (node.expire > current_) {
+      Insert(index);
+      continue;
+    }
+
+    bool cycle = node.interval > 0;
+    Handler handler = std::move(node.handler);
+    node.running = true;
+    node.prev = NIL;
+    node.next = NIL;
+    if (!cycle) {
+      // 单次定时器在回调前就失效，回调里取消自己不会有影响
+      node.generation += 1;
+      if (node.generation == 0) node.generation = 1;
+      size_ -= 1;
+    }
+
+    if (handler) handler();
+    fired += 1;
+
+    Node& after = nodes_[index];
+    after.running = false;
+    if (!cycle || after.cancelled) {
+      FreeNode(index);
+    } else {
+      after.handler = std::move(handler);
+      after.expire = current_ + after.interval;
+      Insert(index);
+    }
+  }
+  return fired;
+}
+
+}
+}
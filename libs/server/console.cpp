@@ -3,9 +3,12 @@
 #include <bamboo/net/simpleconnmanager.hpp>
 
 #include <boost/algorithm/string.hpp>
+#include <cerrno>
+#include <cstdlib>
 #include <iostream>
 
 #include <bamboo/log/log.hpp>
+#include <bamboo/env.hpp>
 
 namespace bamboo {
 namespace server {
@@ -39,6 +42,8 @@ std::size_t Console::readData(bamboo::net::SocketPtr socket, const char* data, s
     if (helpCmd_.handler) result = helpCmd_.handler(strs);
   } else if (cmd == logCmd_.cmd) {
     if (logCmd_.handler) result = logCmd_.handler(strs);
+  } else if (cmd == ioCmd_.cmd) {
+    if (ioCmd_.handler) result = ioCmd_.handler(strs);
   } else {
     auto it = cmds_.find(cmd);
     if (it != cmds_.end() && it->second->handler) {
@@ -65,6 +70,10 @@ bool Console::FinishStart() {
   logCmd_.cmd = "log";
   logCmd_.handler = std::bind(&Console::Cmd_Log, this, std::placeholders::_1);
   logCmd_.help = "if args null, get level. set [debug,info,warn,error] is set log level";
+
+  ioCmd_.cmd = "io";
+  ioCmd_.handler = std::bind(&Console::Cmd_Io, this, std::placeholders::_1);
+  ioCmd_.help = "print lag, handler latency and slow handlers of every io. [reset] clear stats, [slow us] set slow threshold";
   return true;
 }
 
@@ -92,6 +101,7 @@ std::string Console::Cmd_Help(std::vector<std::string>& args) {
   std::stringstream os;
   os << "help\t\t" << helpCmd_.help << "\n";
   os << "log\t\t" << logCmd_.help << "\n";
+  os << "io\t\t" << ioCmd_.help << "\n";
   os << "exit\t\tquit\n";
   for (auto& it : cmds_) {
     os << it.second->cmd << "\t\t" << it.second->help << "\n";
@@ -119,5 +129,59 @@ std::string Console::Cmd_Log(std::vector<std::string>& args) {
   os << "new level:" << bamboo::log::Level2Name(bamboo::log::GetLevel()) << "\n";
   return os.str();
 }
+
+std::string Console::Cmd_Io(std::vector<std::string>& args) {
+  auto aio = bamboo::env::GetIo();
+  if (!aio) return "no aio";
+
+  std::stringstream os;
+  if (!args.empty() && args.front() == "reset") {
+    for (std::size_t i = 0; i < aio->GetIoSize(); ++i) {
+      aio->GetLoad(i).ResetStats();
+    }
+    os << "reset " << aio->GetIoSize() << " io stats\n";
+    return os.str();
+  }
+  if (args.size() > 1 && args.front() == "slow") {
+    const char* begin = args[1].c_str();
+    char* end = nullptr;
+    errno = 0;
+    uint64_t threshold = std::strtoull(begin, &end, 10);
+    if (args[1].empty() || args[1].front() == '-' || errno != 0 || *end != '\0') {
+      return "usage: io slow <microseconds>";
+    }
+    for (std::size_t i = 0; i < aio->GetIoSize(); ++i) {
+      aio->GetLoad(i).SetSlowThreshold(threshold);
+    }
+    os << "slow handler threshold:" << threshold << "us\n";
+    return os.str();
+  }
+
+  for (std::size_t i = 0; i < aio->GetIoSize(); ++i) {
+    auto stats = aio->GetLoad(i).GetStats();
+    os << "io[" << i << "] servers:" << stats.servers << " connections:" << stats.connections
+       << " lag:" << stats.lag << "us max lag:" << stats.maxLag << "us handlers:" << stats.handlers
+       << " avg:" << (stats.handlers > 0 ? stats.handlerTime / stats.handlers : 0) << "ns"
+       << " queued:" << stats.queued << "\n";
+
+    os << "  histogram:";
+    for (std::size_t b = 0; b < stats.histogram.size(); ++b) {
+      if (stats.histogram[b] == 0) continue;
+      if (b + 1 == stats.histogram.size()) {
+        os << " >=" << (1ull << (b - 1)) << "us:" << stats.histogram[b];
+      } else {
+        os << " <" << (1ull << b) << "us:" << stats.histogram[b];
+      }
+    }
+    os << "\n";
+
+    for (auto& slow : stats.slow) {
+      os << "  slow max:" << slow.max / 1000 << "us avg:" << slow.total / std::max<uint64_t>(slow.count, 1) / 1000
+         << "us count:" << slow.count << " " << slow.site << "\n";
+    }
+  }
+  return os.str();
+}
+
 }
 }
\ No newline at end of file
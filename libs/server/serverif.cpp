@@ -5,6 +5,7 @@ namespace server {
 
 ServerIf::ServerIf(boost::asio::io_context& io, std::string name, std::size_t index) : io_(io),
                                                                                        name_(std::move(name)),
+                                                                                       executor_(io),
                                                                                        ioIndex_(index) {
 
   scheduler_.reset(new bamboo::schedule::Scheduler(io));
@@ -38,9 +39,57 @@ void ServerIf::Stop() {
     it->Stop();
   }
 
+  for (auto& it : connectors_) {
+    it->Stop();
+  }
+
   StopHandle();
 }
 
+void ServerIf::Drain() {
+  for (auto& it : acceptors_) {
+    it->Stop();
+  }
+
+  for (auto& it : connectors_) {
+    it->Stop();
+  }
+
+  DrainHandle();
+}
+
+void ServerIf::DrainHandle() {}
+
+std::size_t ServerIf::GetAcceptedSize() {
+  std::size_t size = 0;
+  for (auto& it : acceptors_) {
+    auto mgr = it->GetConnManager();
+    if (mgr) size += mgr->GetSocketSize();
+  }
+  return size;
+}
+
+std::size_t ServerIf::GetConnectionSize() {
+  std::size_t size = GetAcceptedSize();
+  for (auto& it : connectors_) {
+    auto mgr = it->GetConnManager();
+    if (mgr) size += mgr->GetSocketSize();
+  }
+  return size;
+}
+
+void ServerIf::CloseAfterFlush() {
+  for (auto& it : acceptors_) {
+    auto mgr = it->GetConnManager();
+    if (mgr) mgr->CloseAfterFlush();
+  }
+
+  for (auto& it : connectors_) {
+    auto mgr = it->GetConnManager();
+    if (mgr) mgr->CloseAfterFlush();
+  }
+}
+
 std::size_t ServerIf::GetIoIndex() const {
   return ioIndex_;
 }
@@ -53,6 +102,24 @@ bamboo::schedule::Scheduler& ServerIf::GetScheduler() {
   return *scheduler_.get();
 }
 
+const bamboo::concurrency::Executor& ServerIf::GetExecutor() const {
+  return executor_;
+}
+
+void ServerIf::SetSchedulerEngine(bamboo::schedule::Scheduler::Engine engine) {
+  if (scheduler_->GetEngine() == engine) return;
+  if (scheduler_->Size() > 0 || !connectors_.empty()) {
+    BB_ERROR_LOG("server[%s] scheduler already in use, keep the default engine", GetName().c_str());
+    return;
+  }
+  scheduler_.reset(new bamboo::schedule::Scheduler(io_, engine));
+}
+
+void ServerIf::SetExecutor(const bamboo::concurrency::Executor& executor) {
+  executor_ = executor;
+  scheduler_->SetExecutor(executor);
+}
+
 bamboo::net::AcceptorPtr ServerIf::GetAcceptor(uint32_t index) {
   return acceptors_[index];
 }
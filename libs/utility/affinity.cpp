@@ -0,0 +1,105 @@
+#include "bamboo/utility/affinity.hpp"
+
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <sstream>
+
+#include <boost/filesystem.hpp>
+
+#include "bamboo/log/log.hpp"
+
+namespace {
+/// 和 <linux/mempolicy.h> 中的定义相同
+const int MEMORY_POLICY_LOCAL = 4;
+}
+
+namespace bamboo {
+namespace utility {
+
+std::vector<int> AllowedCpus() {
+  std::vector<int> cpus;
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  if (::sched_getaffinity(0, sizeof(set), &set) == 0) {
+    for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+      if (CPU_ISSET(cpu, &set)) cpus.push_back(cpu);
+    }
+  } else {
+    BB_ERROR_LOG("get affinity fail:%s", ::strerror(errno));
+  }
+  if (cpus.empty()) {
+    long count = ::sysconf(_SC_NPROCESSORS_ONLN);
+    for (long cpu = 0; cpu < std::max(count, 1L); ++cpu) cpus.push_back(static_cast<int>(cpu));
+  }
+  return cpus;
+}
+
+std::size_t CpuCount() {
+  return AllowedCpus().size();
+}
+
+std::vector<int> ParseCpuList(const std::string& list) {
+  std::vector<int> cpus;
+  std::stringstream stream(list);
+  std::string item;
+  while (std::getline(stream, item, ',')) {
+    if (item.empty()) continue;
+    char* end = nullptr;
+    long first = std::strtol(item.c_str(), &end, 10);
+    if (end == item.c_str() || first < 0) continue;
+    long last = first;
+    if (*end == '-') {
+      const char* begin = end + 1;
+      last = std::strtol(begin, &end, 10);
+      if (end == begin || last < first) continue;
+    }
+    for (long cpu = first; cpu <= last; ++cpu) {
+      cpus.push_back(static_cast<int>(cpu));
+    }
+  }
+  return cpus;
+}
+
+bool BindCpus(const std::vector<int>& cpus) {
+  if (cpus.empty()) return true;
+
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  for (int cpu : cpus) {
+    if (cpu >= 0 && cpu < CPU_SETSIZE) CPU_SET(cpu, &set);
+  }
+  int error = ::pthread_setaffinity_np(::pthread_self(), sizeof(set), &set);
+  if (error != 0) {
+    BB_ERROR_LOG("bind cpu fail:%s", ::strerror(error));
+    return false;
+  }
+  return true;
+}
+
+int CpuNode(int cpu) {
+  boost::system::error_code ec;
+  boost::filesystem::path path("/sys/devices/system/cpu/cpu" + std::to_string(cpu));
+  for (boost::filesystem::directory_iterator it(path, ec), end; !ec && it != end; it.increment(ec)) {
+    std::string name = it->path().filename().string();
+    if (name.compare(0, 4, "node") == 0 && name.size() > 4) {
+      return std::atoi(name.c_str() + 4);
+    }
+  }
+  return -1;
+}
+
+bool LocalMemoryPolicy() {
+#ifdef SYS_set_mempolicy
+  if (::syscall(SYS_set_mempolicy, MEMORY_POLICY_LOCAL, nullptr, 0) == 0) return true;
+  BB_ERROR_LOG("set memory policy fail:%s", ::strerror(errno));
+#endif
+  return false;
+}
+
+}
+}
@@ -0,0 +1,36 @@
+#include "bamboo/utility/tsc.hpp"
+
+namespace {
+
+/// 校准时长，TSC 频率恒定，短时间的校准误差在千分之一以内
+const std::chrono::milliseconds CALIBRATE_TIME(5);
+
+double Calibrate() {
+#if defined(__x86_64__) || defined(__i386__)
+  auto start = std::chrono::steady_clock::now();
+  uint64_t begin = bamboo::utility::Ticks();
+  auto now = start;
+  while (now - start < CALIBRATE_TIME) {
+    now = std::chrono::steady_clock::now();
+  }
+  uint64_t ticks = bamboo::utility::Ticks() - begin;
+  auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(now - start).count();
+  if (ticks == 0 || ns <= 0) return 1.0;
+  return static_cast<double>(ticks) / static_cast<double>(ns);
+#else
+  return 1.0;
+#endif
+}
+
+}
+
+namespace bamboo {
+namespace utility {
+
+double TicksPerNanosecond() {
+  static const double ratio = Calibrate();
+  return ratio;
+}
+
+}
+}
@@ -0,0 +1,106 @@
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <thread>
+#include <vector>
+
+#include <bamboo/bamboo.hpp>
+
+/**
+ * 忙轮询延迟测试
+ *
+ * @brief 同一个进程里先后启动阻塞等待和忙轮询两种io，各跑一轮相同的测试。
+ *        客户端每次发送一个小包，收到回显后记录往返时间，再间隔一段时间发送下一个，
+ *        让服务端的io每次都处于空闲状态，测出唤醒的开销
+ */
+
+/// 运行一轮测试，返回排好序的往返纳秒数
+std::vector<uint64_t> RunRound(uint16_t port, std::size_t budget, uint32_t busyPoll,
+                               std::size_t count, std::size_t gap, std::size_t size) {
+  bamboo::aio::Topology topology;
+  topology.pollBudget.push_back(budget);
+  bamboo::aio::Aio aio(topology);
+  auto server = aio.CreateServer<bamboo::server::SimpleServer>("busy-poll-latency").first;
+  auto acceptor = server->CreateAcceptor<bamboo::net::SimpleAcceptor>("127.0.0.1", port);
+  if (!acceptor) return {};
+  auto mgr = acceptor->CreateConnManager<bamboo::net::SimpleConnManager>();
+  mgr->CreateProtocol<bamboo::protocol::EchoProtocol>();
+  mgr->SetBusyPoll(busyPoll);
+
+  std::thread runner([&aio]() { aio.Start(); });
+
+  std::vector<uint64_t> samples;
+  samples.reserve(count);
+  try {
+    boost::asio::io_context io;
+    boost::asio::ip::tcp::socket socket(io);
+    socket.connect(boost::asio::ip::tcp::endpoint(boost::asio::ip::make_address("127.0.0.1"), port));
+    socket.set_option(boost::asio::ip::tcp::no_delay(true));
+    std::string data(size, 'x');
+    std::vector<char> reply(size);
+
+    for (std::size_t i = 0; i < count; ++i) {
+      auto begin = std::chrono::steady_clock::now();
+      boost::asio::write(socket, boost::asio::buffer(data));
+      boost::asio::read(socket, boost::asio::buffer(reply));
+      auto rtt = std::chrono::steady_clock::now() - begin;
+      samples.push_back(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(rtt).count()));
+      if (gap > 0) std::this_thread::sleep_for(std::chrono::microseconds(gap));
+    }
+  } catch (std::exception& e) {
+    std::cout << "client fail:" << e.what() << std::endl;
+  }
+
+  boost::asio::post(aio.GetMasterIo(), [&aio]() { aio.Stop(); });
+  runner.join();
+
+  std::sort(samples.begin(), samples.end());
+  return samples;
+}
+
+void Report(const std::string& name, const std::vector<uint64_t>& samples) {
+  if (samples.empty()) {
+    std::cout << name << " no samples" << std::endl;
+    return;
+  }
+  auto at = [&samples](double p) -> double {
+    std::size_t index = static_cast<std::size_t>(p * (samples.size() - 1));
+    return samples[index] / 1000.0;
+  };
+  std::cout << std::left << std::setw(16) << name << std::fixed << std::setprecision(1)
+            << " p50:" << at(0.5) << "us p90:" << at(0.9) << "us p99:" << at(0.99)
+            << "us p99.9:" << at(0.999) << "us max:" << samples.back() / 1000.0 << "us" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+  uint16_t port;
+  std::size_t budget, count, gap, size;
+  uint32_t busyPoll;
+  boost::program_options::variables_map vm;
+  try {
+    boost::program_options::options_description desc("busy poll latency option");
+    desc.add_options()
+        ("help,h", "print all help manuals")
+        ("port,p", boost::program_options::value<uint16_t>(&port)->default_value(19400), "server listen port")
+        ("budget,b", boost::program_options::value<std::size_t>(&budget)->default_value(1000), "busy poll budget in microseconds")
+        ("socket-busy-poll", boost::program_options::value<uint32_t>(&busyPoll)->default_value(0), "SO_BUSY_POLL microseconds")
+        ("count,n", boost::program_options::value<std::size_t>(&count)->default_value(20000), "ping count")
+        ("gap", boost::program_options::value<std::size_t>(&gap)->default_value(50), "microseconds between pings")
+        ("size", boost::program_options::value<std::size_t>(&size)->default_value(64), "message size");
+
+    boost::program_options::store(boost::program_options::parse_command_line(argc, argv, desc), vm);
+    if (vm.count("help")) {
+      std::cout << desc << std::endl;
+      return EXIT_SUCCESS;
+    }
+    boost::program_options::notify(vm);
+  } catch (std::exception& e) {
+    std::cout << e.what() << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  Report("blocking", RunRound(port, 0, 0, count, gap, size));
+  Report("busy-poll", RunRound(port, budget, busyPoll, count, gap, size));
+  return 0;
+}
@@ -0,0 +1,113 @@
+#include <iostream>
+#include <fstream>
+#include <vector>
+
+#include <unistd.h>
+#include <sys/resource.h>
+
+#include <bamboo/bamboo.hpp>
+
+/// 当前进程的常驻内存(字节)
+std::size_t ResidentBytes() {
+  std::size_t pages = 0, resident = 0;
+  std::ifstream statm("/proc/self/statm");
+  statm >> pages >> resident;
+  return resident * static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+}
+
+void RaiseFileLimit() {
+  struct rlimit limit;
+  if (::getrlimit(RLIMIT_NOFILE, &limit) == 0) {
+    limit.rlim_cur = limit.rlim_max;
+    ::setrlimit(RLIMIT_NOFILE, &limit);
+  }
+}
+
+int main(int argc, char* argv[]) {
+  std::string ip;
+  uint16_t port;
+  std::size_t count;
+  boost::program_options::variables_map vm;
+  try {
+    boost::program_options::options_description desc("connection memory benchmark option");
+    desc.add_options()
+        ("help,h", "print all help manuals")
+        ("ip,i", boost::program_options::value<std::string>(&ip)->default_value("127.0.0.1"), "server listen ip")
+        ("port,p", boost::program_options::value<uint16_t>(&port)->default_value(19100), "server listen port")
+        ("count,n", boost::program_options::value<std::size_t>(&count)->default_value(10000), "connection count");
+
+    boost::program_options::store(boost::program_options::parse_command_line(argc, argv, desc), vm);
+    if (vm.count("help")) {
+      std::cout << desc << std::endl;
+      return EXIT_SUCCESS;
+    }
+    boost::program_options::notify(vm);
+  } catch (std::exception& e) {
+    std::cout << e.what() << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  RaiseFileLimit();
+  bamboo::env::Init();
+  auto aio = bamboo::env::GetIo();
+  auto server = aio->CreateServer<bamboo::server::SimpleServer>("conn-memory-bench").first;
+
+  auto acceptor = server->CreateAcceptor<bamboo::net::SimpleAcceptor>(ip, port);
+  if (!acceptor) return EXIT_FAILURE;
+  auto serverMgr = acceptor->CreateConnManager<bamboo::net::SimpleConnManager>();
+  serverMgr->CreateProtocol<bamboo::protocol::EchoProtocol>();
+
+  auto connector = server->CreateConnector<bamboo::net::SimpleConnector>();
+  auto clientMgr = connector->CreateConnManager<bamboo::net::SimpleConnManager>();
+  std::size_t echoed = 0;
+  clientMgr->SetReadHandler([&echoed](bamboo::net::SocketPtr so, const char* data, std::size_t size) -> std::size_t {
+    echoed += size;
+    return size;
+  });
+
+  std::vector<bamboo::net::SocketPtr> clients;
+  clients.reserve(count);
+  std::size_t base = ResidentBytes();
+
+  /**
+   * 分批建立链接，避免超出监听队列的长度。全部建立后报告空闲时的内存，
+   * 再让每个链接收发一次数据，报告活跃过后的内存
+   */
+  std::function<void()> connecting;
+  connecting = [&]() {
+    for (int i = 0; i < 200 && clients.size() < count; ++i) {
+      auto so = connector->Connect(ip, port);
+      if (!so) {
+        std::cout << "connect fail after " << clients.size() << " connections" << std::endl;
+        count = clients.size();
+        break;
+      }
+      clients.push_back(so);
+    }
+    if (clients.size() < count) {
+      server->GetScheduler().Timeout(std::function<void()>(connecting), 10);
+      return;
+    }
+
+    server->GetScheduler().Timeout([&]() {
+      std::size_t idle = ResidentBytes();
+      std::cout << count << " idle connections, rss delta:" << (idle - base) / 1024 << " KiB, "
+                << (idle - base) / std::max<std::size_t>(count * 2, 1) << " bytes/socket" << std::endl;
+
+      std::string ping(64, 'x');
+      for (auto& so : clients) so->WriteData(ping.data(), ping.size());
+
+      server->GetScheduler().Timeout([&]() {
+        std::size_t active = ResidentBytes();
+        std::cout << "after echo " << echoed << " bytes, rss delta:" << (active - base) / 1024 << " KiB, "
+                  << (active - base) / std::max<std::size_t>(count * 2, 1) << " bytes/socket" << std::endl;
+        aio->Stop();
+      }, 1000);
+    }, 500);
+  };
+  server->GetScheduler().Timeout(std::function<void()>(connecting), 10);
+
+  aio->Start();
+  bamboo::env::Close();
+  return 0;
+}
@@ -0,0 +1,149 @@
+#include <iostream>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include <sys/resource.h>
+
+#include <bamboo/bamboo.hpp>
+
+/**
+ * 回显吞吐测试
+ *
+ * @brief 服务和客户端在同一个进程里，服务运行在 bamboo 的io上，客户端运行在单独的线程上，
+ *        输出每秒的往返次数和每次往返的上下文切换次数，作为更换io后端时对比的基准
+ */
+
+/// 发送固定长度的数据，收到完整回显后再发送下一次
+class Client : public std::enable_shared_from_this<Client> {
+ public:
+  Client(boost::asio::io_context& io, std::size_t size, std::atomic<uint64_t>& rounds) : socket_(io),
+                                                                                        data_(size, 'x'),
+                                                                                        reply_(size),
+                                                                                        rounds_(rounds) {}
+
+  bool Connect(const boost::asio::ip::tcp::endpoint& endpoint) {
+    boost::system::error_code ec;
+    socket_.connect(endpoint, ec);
+    if (ec) return false;
+    socket_.set_option(boost::asio::ip::tcp::no_delay(true), ec);
+    return true;
+  }
+
+  void Round() {
+    auto self = shared_from_this();
+    boost::asio::async_write(socket_, boost::asio::buffer(data_), [this, self](const boost::system::error_code& ec,
+                                                                               std::size_t) {
+      if (ec) return;
+      boost::asio::async_read(socket_, boost::asio::buffer(reply_), [this, self](const boost::system::error_code& ec,
+                                                                                 std::size_t) {
+        if (ec) return;
+        rounds_.fetch_add(1, std::memory_order_relaxed);
+        Round();
+      });
+    });
+  }
+
+  void Close() {
+    boost::system::error_code ec;
+    socket_.close(ec);
+  }
+
+ private:
+  boost::asio::ip::tcp::socket socket_;
+  std::string data_;
+  std::vector<char> reply_;
+  std::atomic<uint64_t>& rounds_;
+};
+
+/// 进程的上下文切换次数，io线程每次进入内核等待都会产生一次自愿切换
+uint64_t ContextSwitches() {
+  struct rusage usage;
+  if (::getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+  return static_cast<uint64_t>(usage.ru_nvcsw + usage.ru_nivcsw);
+}
+
+int main(int argc, char* argv[]) {
+  std::string ip;
+  uint16_t port;
+  std::size_t clients, size, seconds;
+  boost::program_options::variables_map vm;
+  try {
+    boost::program_options::options_description desc("echo benchmark option");
+    desc.add_options()
+        ("help,h", "print all help manuals")
+        ("ip,i", boost::program_options::value<std::string>(&ip)->default_value("127.0.0.1"), "server listen ip")
+        ("port,p", boost::program_options::value<uint16_t>(&port)->default_value(19300), "server listen port")
+        ("clients,c", boost::program_options::value<std::size_t>(&clients)->default_value(64), "client connections")
+        ("size", boost::program_options::value<std::size_t>(&size)->default_value(128), "message size")
+        ("seconds", boost::program_options::value<std::size_t>(&seconds)->default_value(5), "run seconds");
+
+    boost::program_options::store(boost::program_options::parse_command_line(argc, argv, desc), vm);
+    if (vm.count("help")) {
+      std::cout << desc << std::endl;
+      return EXIT_SUCCESS;
+    }
+    boost::program_options::notify(vm);
+  } catch (std::exception& e) {
+    std::cout << e.what() << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  bamboo::env::Init();
+  auto aio = bamboo::env::GetIo();
+  auto server = aio->CreateServer<bamboo::server::SimpleServer>("echo-bench").first;
+  auto acceptor = server->CreateAcceptor<bamboo::net::SimpleAcceptor>(ip, port);
+  if (!acceptor) return EXIT_FAILURE;
+  auto mgr = acceptor->CreateConnManager<bamboo::net::SimpleConnManager>();
+  mgr->CreateProtocol<bamboo::protocol::EchoProtocol>();
+
+  boost::asio::io_context clientIo;
+  std::atomic<uint64_t> rounds{0};
+  std::vector<std::shared_ptr<Client>> list;
+
+  std::thread load([&]() {
+    boost::asio::ip::tcp::endpoint endpoint(boost::asio::ip::make_address(ip), port);
+    for (std::size_t i = 0; i < clients; ++i) {
+      auto client = std::make_shared<Client>(clientIo, size, rounds);
+      if (!client->Connect(endpoint)) {
+        std::cout << "connect fail after " << list.size() << " connections" << std::endl;
+        break;
+      }
+      list.push_back(client);
+    }
+    for (auto& client : list) client->Round();
+
+    std::thread runner([&clientIo]() {
+      auto guard = boost::asio::make_work_guard(clientIo);
+      clientIo.run();
+    });
+
+    // 预热一秒后开始计数
+    std::this_thread::sleep_for(std::chrono::seconds(1));
+    uint64_t begin = rounds.load();
+    uint64_t switches = ContextSwitches();
+    auto start = std::chrono::steady_clock::now();
+    std::this_thread::sleep_for(std::chrono::seconds(seconds));
+    uint64_t done = rounds.load() - begin;
+    switches = ContextSwitches() - switches;
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << bamboo::env::Backend() << " clients:" << list.size() << " size:" << size
+              << " -> " << static_cast<uint64_t>(done / elapsed) << " round trips/s, "
+              << static_cast<double>(switches) / std::max<uint64_t>(done, 1) << " context switches/round trip"
+              << std::endl;
+
+    boost::asio::post(clientIo, [&list, &clientIo]() {
+      for (auto& client : list) client->Close();
+      clientIo.stop();
+    });
+    runner.join();
+    boost::asio::post(aio->GetMasterIo(), [aio]() { aio->Stop(); });
+  });
+
+  aio->Start();
+  load.join();
+  bamboo::env::Close();
+  return 0;
+}
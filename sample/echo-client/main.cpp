@@ -30,16 +30,18 @@ int main(int argc, char* argv[]) {
   auto connect = server.first->CreateConnector<bamboo::net::SimpleConnector>();
   auto manager = connect->CreateConnManager<bamboo::net::SimpleConnManager>();
   manager->CreateProtocol<bamboo::protocol::EchoProtocol>();
-  auto socket = connect->Connect(ip, port);
-  if (socket) {
+  connect->AsyncConnect(ip, port, [server, aio](const boost::system::error_code& ec, bamboo::net::SocketPtr socket) {
+    if (!socket) {
+      std::cout << "connect fail:" << ec.message() << std::endl;
+      aio->Stop();
+      return;
+    }
     server.first->GetScheduler().Timeout([socket]() {
       std::string t = std::to_string(std::time(nullptr));
       std::cout << "send data:" << t << std::endl;
       socket->WriteData(t.data(), t.size());
     }, 3000);
-  } else {
-    return EXIT_FAILURE;
-  }
+  }, 3000);
   aio->Start();
   return 0;
 }
\ No newline at end of file
@@ -1,7 +1,14 @@
 #include <iostream>
+#include <atomic>
 
 #include <bamboo/bamboo.hpp>
 
+/// 所有分片共享的接收计数，方便对比 SimpleAcceptor 与 ShardedAcceptor 的吞吐
+std::atomic<std::size_t> total{0};
+
+/// 系统不支持 SO_REUSEPORT 时只有第一个分片监听，服务按io索引顺序启动
+bool exclusive{false};
+
 class EchoServer : public bamboo::server::ServerIf {
  public:
   using bamboo::server::ServerIf::ServerIf;
@@ -9,18 +16,32 @@ class EchoServer : public bamboo::server::ServerIf {
 
  protected:
   bool PrepareStart() override {
-    auto acceptor = CreateAcceptor<bamboo::net::SimpleAcceptor>(ip_, port_);
+    bamboo::net::AcceptorPtr acceptor;
+    if (!sharded_) {
+      acceptor = CreateAcceptor<bamboo::net::SimpleAcceptor>(ip_, port_);
+    } else if (exclusive) {
+      return true;
+    } else {
+      acceptor = CreateAcceptor<bamboo::net::ShardedAcceptor>(ip_, port_);
+      if (acceptor && !acceptor->IsReusePort()) {
+        exclusive = true;
+        std::cout << "SO_REUSEPORT is not supported, fall back to a single acceptor" << std::endl;
+      }
+    }
+    if (!acceptor) return false;
     mgr_ = acceptor->CreateConnManager<bamboo::net::SimpleConnManager>();
     protocol_ = std::make_shared<bamboo::protocol::EchoProtocol>();
     mgr_->SetReadHandler([this](bamboo::net::SocketPtr so, const char* data, std::size_t size) -> std::size_t {
-      total_ += size;
+      total.fetch_add(size, std::memory_order_relaxed);
       return protocol_->ReceiveData(so, data, size);
     });
 
-    GetScheduler().Heartbeat([this] {
-      std::cout << "receive data:" << total_ / 1024.0 / 1024.0 << " m/10s" << std::endl;
-      total_ = 0;
-    }, 10000);
+    if (GetIoIndex() == 0) {
+      GetScheduler().Heartbeat([this] {
+        std::cout << (sharded_ ? "[sharded acceptor] " : "[simple acceptor] ")
+                  << "receive data:" << total.exchange(0) / 1024.0 / 1024.0 << " m/10s" << std::endl;
+      }, 10000);
+    }
 
     return true;
   }
@@ -34,14 +55,15 @@ class EchoServer : public bamboo::server::ServerIf {
     if (map.count("port")) {
       port_ = map["port"].as<uint16_t>();
     }
+    sharded_ = map.count("sharded") > 0;
   }
 
  private:
   bamboo::net::ConnManagerPtr mgr_;
   std::shared_ptr<bamboo::protocol::EchoProtocol> protocol_;
-  std::size_t total_{0};
   std::string ip_;
   uint16_t port_{0};
+  bool sharded_{false};
 };
 
 int main(int argc, char* argv[]) {
@@ -51,7 +73,12 @@ int main(int argc, char* argv[]) {
     desc.add_options()
         ("help,h", "print all help manuals")
         ("ip,i", boost::program_options::value<std::string>()->required(), "server listen ip")
-        ("port,p", boost::program_options::value<uint16_t>()->required(), "server listen port");
+        ("port,p", boost::program_options::value<uint16_t>()->required(), "server listen port")
+        ("sharded,s", "listen with one SO_REUSEPORT acceptor per io instead of a single SimpleAcceptor")
+        ("io-cpus", boost::program_options::value<std::string>(), "cpu list of every io separated by ';', e.g. \"0;1;2-3\"")
+        ("pin", "pin every io to its own cpu, leave the rest for workers")
+        ("numa", "use local numa memory and prefill buffer pools on pinned io threads")
+        ("drain", boost::program_options::value<uint32_t>()->default_value(5000), "milliseconds to drain connections on SIGINT/SIGTERM");
 
     boost::program_options::store(boost::program_options::parse_command_line(argc, argv, desc), vm);
     if (vm.count("help")) {
@@ -64,10 +91,38 @@ int main(int argc, char* argv[]) {
     return EXIT_FAILURE;
   }
 
-  bamboo::env::Init();
+  bamboo::aio::Topology topology;
+  if (vm.count("io-cpus")) {
+    topology = bamboo::aio::Topology::Parse(vm["io-cpus"].as<std::string>(), "");
+  } else if (vm.count("pin")) {
+    topology = bamboo::aio::Topology::Pinned(0);
+  }
+  if (vm.count("numa")) {
+    topology.numaLocal = true;
+    topology.prefillBytes = 1024 * 1024;
+  }
+
+  // 两种方式使用相同的线程模式，对比时只有监听方式不同
+  bamboo::env::Init(bamboo::env::ThreadMode::MULTIPLE, topology);
+  if (vm.count("sharded")) {
+    bamboo::env::GetIo()->CreateShardedServer<EchoServer>("echo_server");
+  } else {
+    bamboo::env::GetIo()->CreateServer<EchoServer>("echo_server");
+  }
   auto aio = bamboo::env::GetIo();
-  aio->CreateServer<EchoServer>("echo_server");
   aio->Configure(vm);
+
+  // 第一次收到信号时排空链接，再次收到时立即关闭
+  std::chrono::milliseconds drain(vm["drain"].as<uint32_t>());
+  auto shutdown = [aio, drain](int) {
+    if (aio->IsDraining()) {
+      aio->Stop();
+    } else {
+      aio->Drain(drain);
+    }
+  };
+  aio->Signal(SIGINT, shutdown);
+  aio->Signal(SIGTERM, shutdown);
   aio->Start();
   bamboo::env::Close();
   return 0;
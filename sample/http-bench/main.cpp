@@ -0,0 +1,194 @@
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <deque>
+
+#include <bamboo/bamboo.hpp>
+
+/**
+ * http 流水线测试
+ *
+ * @brief 服务端使用 HttpProtocol 回复固定内容，客户端在每个 keep-alive 链接上保持固定数量的
+ *        流水线请求，收到一个回复就补发一个，统计吞吐和延迟分布。
+ *        使用 --server-only 时只启动服务端，可以用 wrk 等工具压测
+ */
+
+namespace {
+
+const std::string BODY = "hello world";
+const std::string REQUEST = "GET /hello HTTP/1.1\r\nHost: bench\r\n\r\n";
+const std::string RESPONSE = "HTTP/1.1 200 OK\r\nContent-Type: text/plain\r\nContent-Length: 11\r\n\r\nhello world";
+
+}
+
+class HttpServer : public bamboo::server::ServerIf {
+ public:
+  HttpServer(boost::asio::io_context& io, std::string name, std::size_t index, uint16_t port)
+      : ServerIf(io, std::move(name), index), port_(port) {}
+  virtual ~HttpServer() {}
+
+  void Configure(boost::program_options::variables_map&) override {}
+
+ protected:
+  bool PrepareStart() override {
+    auto acceptor = CreateAcceptor<bamboo::net::SimpleAcceptor>("0.0.0.0", port_);
+    if (!acceptor) return false;
+    auto http = acceptor->CreateConnManager<bamboo::net::SimpleConnManager>()
+        ->CreateProtocol<bamboo::protocol::HttpProtocol>();
+    http->Handle("/hello", [](bamboo::net::SocketPtr, const bamboo::protocol::HttpRequest&,
+                              bamboo::protocol::HttpResponsePtr response) {
+      response->AddHeader("Content-Type", "text/plain");
+      response->Send(BODY);
+    });
+    return true;
+  }
+
+  bool FinishStart() override { return true; }
+  void StopHandle() override {}
+
+ private:
+  uint16_t port_;
+};
+
+class HttpClient : public bamboo::server::ServerIf {
+ public:
+  HttpClient(boost::asio::io_context& io, std::string name, std::size_t index, uint16_t port,
+             std::size_t connections, std::size_t pipeline, std::size_t seconds)
+      : ServerIf(io, std::move(name), index), port_(port), connections_(connections), pipeline_(pipeline),
+        seconds_(seconds) {}
+  virtual ~HttpClient() {}
+
+  void Configure(boost::program_options::variables_map&) override {}
+
+ protected:
+  bool PrepareStart() override {
+    connector_ = CreateConnector<bamboo::net::SimpleConnector>();
+    auto manager = connector_->CreateConnManager<bamboo::net::SimpleConnManager>();
+    manager->SetReadHandler([this](bamboo::net::SocketPtr so, const char* data, std::size_t size) {
+      return OnData(so, data, size);
+    });
+    return true;
+  }
+
+  bool FinishStart() override {
+    for (std::size_t i = 0; i < connections_; ++i) {
+      connector_->AsyncConnect("127.0.0.1", port_, [this](const boost::system::error_code& ec,
+                                                          bamboo::net::SocketPtr so) {
+        if (!so) {
+          std::cout << "connect fail:" << ec.message() << std::endl;
+          return;
+        }
+        auto& sent = sent_[so->GetId()];
+        std::string batch;
+        for (std::size_t i = 0; i < pipeline_; ++i) {
+          batch.append(REQUEST);
+          sent.push_back(std::chrono::steady_clock::now());
+        }
+        so->WriteData(batch.data(), batch.size());
+      }, 1000);
+    }
+    // 预热一秒后开始计数
+    GetScheduler().Timeout([this]() {
+      begin_ = done_;
+      latency_.clear();
+      start_ = std::chrono::steady_clock::now();
+    }, 1000);
+    GetScheduler().Timeout([this]() { Report(); }, 1000 + seconds_ * 1000);
+    return true;
+  }
+
+  void StopHandle() override {}
+
+ private:
+  std::size_t OnData(bamboo::net::SocketPtr so, const char* data, std::size_t size) {
+    if (size >= RESPONSE.size() && std::string(data, RESPONSE.size()) != RESPONSE) {
+      std::cout << "unexpected response" << std::endl;
+      so->Close();
+      return size;
+    }
+    std::size_t count = size / RESPONSE.size();
+    auto now = std::chrono::steady_clock::now();
+    auto& sent = sent_[so->GetId()];
+    for (std::size_t i = 0; i < count && !sent.empty(); ++i) {
+      latency_.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(now - sent.front()).count());
+      sent.pop_front();
+    }
+    done_ += count;
+
+    if (!stopped_ && count > 0) {
+      std::string batch;
+      batch.reserve(REQUEST.size() * count);
+      for (std::size_t i = 0; i < count; ++i) {
+        batch.append(REQUEST);
+        sent.push_back(now);
+      }
+      so->WriteData(batch.data(), batch.size());
+    }
+    return count * RESPONSE.size();
+  }
+
+  void Report() {
+    stopped_ = true;
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_).count();
+    std::sort(latency_.begin(), latency_.end());
+    auto at = [this](double percent) -> double {
+      if (latency_.empty()) return 0;
+      return latency_[static_cast<std::size_t>(percent * (latency_.size() - 1))] / 1000.0;
+    };
+    std::cout << "connections:" << connections_ << " pipeline:" << pipeline_
+              << " -> " << static_cast<uint64_t>((done_ - begin_) / elapsed) << " req/s"
+              << " p50:" << at(0.5) << "us p99:" << at(0.99) << "us" << std::endl;
+    auto aio = bamboo::env::GetIo();
+    boost::asio::post(aio->GetMasterIo(), [aio]() { aio->Stop(); });
+  }
+
+  uint16_t port_;
+  std::size_t connections_;
+  std::size_t pipeline_;
+  std::size_t seconds_;
+  std::shared_ptr<bamboo::net::SimpleConnector> connector_;
+  std::unordered_map<uint64_t, std::deque<std::chrono::steady_clock::time_point>> sent_;
+  std::vector<int64_t> latency_;
+  uint64_t done_{0};
+  uint64_t begin_{0};
+  bool stopped_{false};
+  std::chrono::steady_clock::time_point start_;
+};
+
+int main(int argc, char* argv[]) {
+  uint16_t port;
+  std::size_t connections, pipeline, seconds;
+  boost::program_options::variables_map vm;
+  try {
+    boost::program_options::options_description desc("http bench option");
+    desc.add_options()
+        ("help,h", "print all help manuals")
+        ("port,p", boost::program_options::value<uint16_t>(&port)->default_value(19800), "server listen port")
+        ("connections,c", boost::program_options::value<std::size_t>(&connections)->default_value(4), "client connections")
+        ("pipeline,n", boost::program_options::value<std::size_t>(&pipeline)->default_value(16), "requests in flight per connection")
+        ("seconds", boost::program_options::value<std::size_t>(&seconds)->default_value(5), "run seconds")
+        ("server-only", "only start server");
+
+    boost::program_options::store(boost::program_options::parse_command_line(argc, argv, desc), vm);
+    if (vm.count("help")) {
+      std::cout << desc << std::endl;
+      return EXIT_SUCCESS;
+    }
+    boost::program_options::notify(vm);
+  } catch (std::exception& e) {
+    std::cout << e.what() << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  bamboo::aio::Topology topology;
+  topology.ioSize = 2;
+  bamboo::env::Init(bamboo::env::ThreadMode::MULTIPLE, topology);
+  auto aio = bamboo::env::GetIo();
+  aio->CreateServerWithIndex<HttpServer>(0, "http-server", port);
+  if (!vm.count("server-only")) {
+    aio->CreateServerWithIndex<HttpClient>(1, "http-client", port, connections, pipeline, seconds);
+  }
+  aio->Start();
+  bamboo::env::Close();
+  return 0;
+}
@@ -0,0 +1,115 @@
+#include <iostream>
+#include <atomic>
+
+#include <bamboo/bamboo.hpp>
+
+/**
+ * 每个io上一个服务，组成一个环，令牌沿着环转发指定的跳数。
+ * 先用邮箱转发，再用 boost::asio::post 转发，对比两者的吞吐
+ */
+struct Token {
+  uint64_t hops{0};
+};
+
+class RingServer;
+std::vector<std::shared_ptr<RingServer>> ring;
+std::atomic<std::size_t> finished{0};
+std::size_t tokens = 0;
+uint64_t hops = 0;
+bool viaMailbox = true;
+std::chrono::steady_clock::time_point start;
+
+void Launch();
+
+class RingServer : public bamboo::server::ServerIf {
+ public:
+  using bamboo::server::ServerIf::ServerIf;
+  virtual ~RingServer() {}
+
+  void SetNext(const std::shared_ptr<RingServer>& next) { next_ = next; }
+
+  void OnMessage(Token token) {
+    if (token.hops == 0) {
+      if (finished.fetch_add(1) + 1 == tokens) Report();
+      return;
+    }
+    token.hops -= 1;
+    Forward(token);
+  }
+
+  void Forward(const Token& token) {
+    auto next = next_.lock();
+    if (!next) return;
+    if (viaMailbox) {
+      if (!bamboo::env::GetIo()->Send(next, token)) std::cout << "mailbox full" << std::endl;
+    } else {
+      boost::asio::post(next->GetIo(), [next, token]() { next->OnMessage(token); });
+    }
+  }
+
+ protected:
+  bool PrepareStart() override { return true; }
+  bool FinishStart() override { return true; }
+  void StopHandle() override {}
+  void Configure(boost::program_options::variables_map& map) override {}
+
+ private:
+  void Report() {
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::cout << (viaMailbox ? "mailbox" : "asio post") << ": " << tokens * hops << " messages in " << ms
+              << " ms, " << static_cast<std::size_t>(tokens * hops / ms * 1000) << " msg/s" << std::endl;
+
+    if (viaMailbox) {
+      viaMailbox = false;
+      Launch();
+    } else {
+      bamboo::env::GetIo()->Stop();
+    }
+  }
+
+  std::weak_ptr<RingServer> next_;
+};
+
+void Launch() {
+  finished = 0;
+  start = std::chrono::steady_clock::now();
+  for (std::size_t i = 0; i < tokens; ++i) {
+    Token token;
+    token.hops = hops;
+    ring[i % ring.size()]->Forward(token);
+  }
+}
+
+int main(int argc, char* argv[]) {
+  boost::program_options::variables_map vm;
+  try {
+    boost::program_options::options_description desc("mailbox ring option");
+    desc.add_options()
+        ("help,h", "print all help manuals")
+        ("token,t", boost::program_options::value<std::size_t>(&tokens)->default_value(64), "tokens in flight")
+        ("hop,n", boost::program_options::value<uint64_t>(&hops)->default_value(100000), "hops of every token");
+
+    boost::program_options::store(boost::program_options::parse_command_line(argc, argv, desc), vm);
+    if (vm.count("help")) {
+      std::cout << desc << std::endl;
+      return EXIT_SUCCESS;
+    }
+    boost::program_options::notify(vm);
+  } catch (std::exception& e) {
+    std::cout << e.what() << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  bamboo::env::Init(bamboo::env::ThreadMode::MULTIPLE);
+  auto aio = bamboo::env::GetIo();
+  ring = aio->CreateShardedServer<RingServer>("ring");
+  for (std::size_t i = 0; i < ring.size(); ++i) {
+    ring[i]->SetNext(ring[(i + 1) % ring.size()]);
+  }
+
+  Launch();
+  aio->Start();
+  ring.clear();
+  bamboo::env::Close();
+  return 0;
+}
@@ -0,0 +1,185 @@
+#include <iostream>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <thread>
+
+#include <bamboo/bamboo.hpp>
+
+/**
+ * 消息发送的内存申请测试
+ *
+ * @brief 替换全局的 operator new 统计申请次数，分别用 Build 和 SerializeTo 两种方式
+ *        通过同一个socket发送相同的消息，预热后统计平均每条消息的内存申请次数和耗时
+ */
+
+namespace {
+std::atomic<uint64_t> allocations{0};
+}
+
+void* operator new(std::size_t size) {
+  allocations.fetch_add(1, std::memory_order_relaxed);
+  void* ptr = std::malloc(size == 0 ? 1 : size);
+  if (ptr == nullptr) throw std::bad_alloc();
+  return ptr;
+}
+
+void operator delete(void* ptr) noexcept {
+  std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept {
+  std::free(ptr);
+}
+
+/// 固定头部加内容的消息，两种发送方式编码出的数据相同
+class Message : public bamboo::protocol::MessageIf {
+ public:
+  Message(uint32_t type, std::string body, bool direct) : type_(type), body_(std::move(body)), direct_(direct) {}
+
+  std::unique_ptr<std::string> Build() override {
+    std::unique_ptr<std::string> buffer(new std::string(HEAD + body_.size(), '\0'));
+    Encode(&(*buffer)[0]);
+    return buffer;
+  }
+
+  std::size_t EncodedSize() const override { return direct_ ? HEAD + body_.size() : 0; }
+
+  void SerializeTo(char* out) const override { Encode(out); }
+
+ private:
+  static const std::size_t HEAD = 8;
+
+  void Encode(char* out) const {
+    uint32_t size = static_cast<uint32_t>(body_.size());
+    std::memcpy(out, &type_, 4);
+    std::memcpy(out + 4, &size, 4);
+    std::memcpy(out + HEAD, body_.data(), body_.size());
+  }
+
+  uint32_t type_;
+  std::string body_;
+  bool direct_;
+};
+
+/**
+ * 在io的回调中发送消息，和真实服务一样从io线程发起写操作，asio 才会复用回调的内存。
+ * 每批消息都超过发送队列的高水位，回落到0时在写完成的回调中直接发送下一批，测试本身不额外投递回调
+ */
+class Bench {
+ public:
+  Bench(bamboo::net::SocketPtr so, std::size_t count, std::size_t size, std::size_t batch)
+      : so_(std::move(so)), count_(count), batch_(batch),
+        build_(1, std::string(size, 'x'), false), direct_(1, std::string(size, 'x'), true) {
+    so_->SetWriteWatermark(batch_ * (size + 8), 0);
+    so_->SetWatermarkHandler([this](bool high) {
+      if (!high) Next();
+    });
+  }
+
+  void Start() {
+    phase_ = BUILD_WARMUP;
+    Begin();
+  }
+
+ private:
+  /// 每种方式先预热再计数，预热让缓冲池、asio 的回调内存都进入稳定状态
+  enum Phase { BUILD_WARMUP, BUILD, DIRECT_WARMUP, DIRECT, DONE };
+
+  void Begin() {
+    bool warmup = phase_ == BUILD_WARMUP || phase_ == DIRECT_WARMUP;
+    remaining_ = warmup ? std::min<std::size_t>(count_ / 10 + batch_, 100000) : count_;
+    before_ = allocations.load();
+    begin_ = std::chrono::steady_clock::now();
+    Next();
+  }
+
+  void Next() {
+    if (remaining_ == 0) {
+      Finish();
+      return;
+    }
+    Message& message = phase_ < DIRECT_WARMUP ? build_ : direct_;
+    for (std::size_t i = 0; i < batch_ && remaining_ > 0; ++i, --remaining_) so_->WriteData(&message);
+  }
+
+  void Finish() {
+    if (phase_ == BUILD || phase_ == DIRECT) {
+      double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin_).count();
+      uint64_t used = allocations.load() - before_;
+      std::cout << (phase_ == BUILD ? "Build" : "SerializeTo") << " messages:" << count_ << " allocations:" << used
+                << " per message:" << static_cast<double>(used) / count_
+                << " -> " << static_cast<uint64_t>(count_ / elapsed) << " messages/s" << std::endl;
+    }
+    phase_ = static_cast<Phase>(phase_ + 1);
+    if (phase_ == DONE) {
+      so_->Close();
+      return;
+    }
+    Begin();
+  }
+
+  bamboo::net::SocketPtr so_;
+  std::size_t count_;
+  std::size_t batch_;
+  Message build_;
+  Message direct_;
+  Phase phase_{BUILD_WARMUP};
+  std::size_t remaining_{0};
+  uint64_t before_{0};
+  std::chrono::steady_clock::time_point begin_;
+};
+
+int main(int argc, char* argv[]) {
+  std::size_t count, size, batch;
+  boost::program_options::variables_map vm;
+  try {
+    boost::program_options::options_description desc("message allocation benchmark option");
+    desc.add_options()
+        ("help,h", "print all help manuals")
+        ("count,n", boost::program_options::value<std::size_t>(&count)->default_value(1000000), "messages per mode")
+        ("size", boost::program_options::value<std::size_t>(&size)->default_value(120), "message body size")
+        ("batch", boost::program_options::value<std::size_t>(&batch)->default_value(16), "messages per io poll");
+
+    boost::program_options::store(boost::program_options::parse_command_line(argc, argv, desc), vm);
+    if (vm.count("help")) {
+      std::cout << desc << std::endl;
+      return EXIT_SUCCESS;
+    }
+    boost::program_options::notify(vm);
+  } catch (std::exception& e) {
+    std::cout << e.what() << std::endl;
+    return EXIT_FAILURE;
+  }
+  if (batch == 0) batch = 1;
+
+  boost::asio::io_context io;
+  boost::asio::ip::tcp::acceptor acceptor(io, {boost::asio::ip::make_address("127.0.0.1"), 0});
+  boost::asio::ip::tcp::socket client(io);
+  client.connect(acceptor.local_endpoint());
+  boost::asio::ip::tcp::socket accepted(io);
+  acceptor.accept(accepted);
+
+  auto mgr = std::make_shared<bamboo::net::SimpleConnManager>();
+  auto so = mgr->OnConnect(std::move(accepted));
+
+  // 另一个线程把数据全部读走，读取不申请内存
+  std::atomic<uint64_t> received{0};
+  std::thread reader([&client, &received]() {
+    std::unique_ptr<char[]> data(new char[1024 * 256]);
+    boost::system::error_code ec;
+    while (!ec) {
+      received += client.read_some(boost::asio::buffer(data.get(), 1024 * 256), ec);
+    }
+  });
+
+  Bench bench(so, count, size, batch);
+  boost::asio::post(io, [&bench]() { bench.Start(); });
+  io.run();
+
+  client.shutdown(boost::asio::ip::tcp::socket::shutdown_both);
+  reader.join();
+  return 0;
+}
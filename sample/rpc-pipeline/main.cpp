@@ -0,0 +1,155 @@
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+
+#include <bamboo/bamboo.hpp>
+
+/**
+ * rpc 流水线测试
+ *
+ * @brief 服务端注册 echo 方法，客户端通过少量链接的连接池保持固定数量的在途调用，
+ *        每个调用返回后立即发起下一个，对比不同在途数量下的吞吐。
+ *        在途数量远大于链接数时，依靠请求id在同一个链接上复用，不需要每个并发请求一个链接
+ */
+
+using Status = bamboo::protocol::RpcProtocol::Status;
+
+class RpcServer : public bamboo::server::ServerIf {
+ public:
+  RpcServer(boost::asio::io_context& io, std::string name, std::size_t index, uint16_t port)
+      : ServerIf(io, std::move(name), index), port_(port) {}
+  virtual ~RpcServer() {}
+
+  void Configure(boost::program_options::variables_map&) override {}
+
+ protected:
+  bool PrepareStart() override {
+    auto acceptor = CreateAcceptor<bamboo::net::SimpleAcceptor>("127.0.0.1", port_);
+    if (!acceptor) return false;
+    auto protocol = acceptor->CreateConnManager<bamboo::net::SimpleConnManager>()
+        ->CreateProtocol<bamboo::protocol::RpcProtocol>(GetScheduler());
+    protocol->Register("echo", [](bamboo::net::SocketPtr, const bamboo::protocol::RpcProtocol::Request& request,
+                                  bamboo::protocol::RpcProtocol::Reply reply) {
+      reply(Status::OK, request.data, request.size);
+    });
+    return true;
+  }
+
+  bool FinishStart() override { return true; }
+  void StopHandle() override {}
+
+ private:
+  uint16_t port_;
+};
+
+class RpcClient : public bamboo::server::ServerIf {
+ public:
+  RpcClient(boost::asio::io_context& io, std::string name, std::size_t index, uint16_t port,
+            std::size_t connections, std::size_t inflight, std::size_t size, std::size_t seconds)
+      : ServerIf(io, std::move(name), index), port_(port), connections_(connections), inflight_(inflight),
+        payload_(size, 'x'), seconds_(seconds) {}
+  virtual ~RpcClient() {}
+
+  void Configure(boost::program_options::variables_map&) override {}
+
+ protected:
+  bool PrepareStart() override {
+    auto connector = CreateConnector<bamboo::net::SimpleConnector>();
+    protocol_ = connector->CreateConnManager<bamboo::net::SimpleConnManager>()
+        ->CreateProtocol<bamboo::protocol::RpcProtocol>(GetScheduler());
+    pool_ = std::make_shared<bamboo::net::ConnectionPool>(connector, "127.0.0.1", port_, connections_);
+    return true;
+  }
+
+  bool FinishStart() override {
+    pool_->Start();
+    // 等链接建立后开始，预热一秒后开始计数
+    GetScheduler().Timeout([this]() {
+      for (std::size_t i = 0; i < inflight_; ++i) Next();
+    }, 200);
+    GetScheduler().Timeout([this]() {
+      begin_ = done_;
+      start_ = std::chrono::steady_clock::now();
+    }, 1200);
+    GetScheduler().Timeout([this]() { Report(); }, 1200 + seconds_ * 1000);
+    return true;
+  }
+
+  void StopHandle() override {
+    if (pool_) pool_->Stop();
+  }
+
+ private:
+  void Next() {
+    if (stopped_) return;
+    bool sent = protocol_->Call(pool_, "echo", payload_.data(), payload_.size(),
+                                [this](Status status, const char*, std::size_t) {
+                                  if (status == Status::OK) {
+                                    ++done_;
+                                  } else {
+                                    ++failed_;
+                                  }
+                                  Next();
+                                }, 1000);
+    if (!sent) GetScheduler().Timeout([this]() { Next(); }, 10);
+  }
+
+  void Report() {
+    stopped_ = true;
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_).count();
+    std::cout << "connections:" << connections_ << " inflight:" << inflight_ << " size:" << payload_.size()
+              << " -> " << static_cast<uint64_t>((done_ - begin_) / elapsed) << " calls/s"
+              << " failed:" << failed_ << std::endl;
+    auto aio = bamboo::env::GetIo();
+    boost::asio::post(aio->GetMasterIo(), [aio]() { aio->Stop(); });
+  }
+
+  uint16_t port_;
+  std::size_t connections_;
+  std::size_t inflight_;
+  std::string payload_;
+  std::size_t seconds_;
+  std::shared_ptr<bamboo::protocol::RpcProtocol> protocol_;
+  bamboo::net::ConnectionPoolPtr pool_;
+  uint64_t done_{0};
+  uint64_t begin_{0};
+  uint64_t failed_{0};
+  bool stopped_{false};
+  std::chrono::steady_clock::time_point start_;
+};
+
+int main(int argc, char* argv[]) {
+  uint16_t port;
+  std::size_t connections, inflight, size, seconds;
+  boost::program_options::variables_map vm;
+  try {
+    boost::program_options::options_description desc("rpc pipeline option");
+    desc.add_options()
+        ("help,h", "print all help manuals")
+        ("port,p", boost::program_options::value<uint16_t>(&port)->default_value(19700), "server listen port")
+        ("connections,c", boost::program_options::value<std::size_t>(&connections)->default_value(1), "client connections")
+        ("inflight,n", boost::program_options::value<std::size_t>(&inflight)->default_value(64), "calls in flight")
+        ("size", boost::program_options::value<std::size_t>(&size)->default_value(64), "payload size")
+        ("seconds", boost::program_options::value<std::size_t>(&seconds)->default_value(5), "run seconds");
+
+    boost::program_options::store(boost::program_options::parse_command_line(argc, argv, desc), vm);
+    if (vm.count("help")) {
+      std::cout << desc << std::endl;
+      return EXIT_SUCCESS;
+    }
+    boost::program_options::notify(vm);
+  } catch (std::exception& e) {
+    std::cout << e.what() << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  bamboo::aio::Topology topology;
+  topology.ioSize = 2;
+  bamboo::env::Init(bamboo::env::ThreadMode::MULTIPLE, topology);
+  auto aio = bamboo::env::GetIo();
+  aio->CreateServerWithIndex<RpcServer>(0, "rpc-server", port);
+  aio->CreateServerWithIndex<RpcClient>(1, "rpc-client", port, connections, inflight, size, seconds);
+  aio->Start();
+  bamboo::env::Close();
+  return 0;
+}
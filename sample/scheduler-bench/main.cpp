@@ -0,0 +1,76 @@
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include <bamboo/bamboo.hpp>
+
+using Clock = std::chrono::steady_clock;
+
+double Millisecond(Clock::time_point start) {
+  return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+/**
+ * 分别测试插入、取消一半、剩余全部触发的耗时
+ */
+void Bench(const char* name, bamboo::schedule::Scheduler::Engine engine, std::size_t count, std::time_t range) {
+  boost::asio::io_context io;
+  bamboo::schedule::Scheduler scheduler(io, engine);
+  std::mt19937 random(1);
+  std::vector<bamboo::schedule::Scheduler::ID> ids;
+  ids.reserve(count);
+  std::size_t fired = 0;
+
+  auto start = Clock::now();
+  for (std::size_t i = 0; i < count; ++i) {
+    ids.push_back(scheduler.Timeout([&fired]() { ++fired; }, 1 + random() % range));
+  }
+  double insert = Millisecond(start);
+
+  start = Clock::now();
+  for (std::size_t i = 0; i < count; i += 2) {
+    scheduler.Cancel(ids[i]);
+  }
+  double cancel = Millisecond(start);
+
+  start = Clock::now();
+  io.run();
+  double run = Millisecond(start);
+
+  std::cout << name << ": " << count << " timers, insert " << insert << " ms ("
+            << insert * 1000000 / count << " ns/op), cancel " << cancel << " ms ("
+            << cancel * 2000000 / count << " ns/op), fired " << fired << " in " << run << " ms" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+  std::size_t count;
+  std::time_t range;
+  std::string engine;
+  boost::program_options::variables_map vm;
+  try {
+    boost::program_options::options_description desc("scheduler benchmark option");
+    desc.add_options()
+        ("help,h", "print all help manuals")
+        ("count,n", boost::program_options::value<std::size_t>(&count)->default_value(1000000), "timer count")
+        ("range,r", boost::program_options::value<std::time_t>(&range)->default_value(2000), "max timeout millisecond")
+        ("engine,e", boost::program_options::value<std::string>(&engine)->default_value("all"), "timer, wheel or all");
+
+    boost::program_options::store(boost::program_options::parse_command_line(argc, argv, desc), vm);
+    if (vm.count("help")) {
+      std::cout << desc << std::endl;
+      return EXIT_SUCCESS;
+    }
+    boost::program_options::notify(vm);
+  } catch (std::exception& e) {
+    std::cout << e.what() << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  if (engine == "all" || engine == "timer") {
+    Bench("timer", bamboo::schedule::Scheduler::Engine::TIMER, count, range);
+  }
+  if (engine == "all" || engine == "wheel") {
+    Bench("wheel", bamboo::schedule::Scheduler::Engine::WHEEL, count, range);
+  }
+  return 0;
+}
@@ -0,0 +1,211 @@
+#include <iostream>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include <bamboo/bamboo.hpp>
+
+/**
+ * 负载不均衡的回显测试
+ *
+ * @brief 启动多个回显服务，每个服务监听一个端口，大部分客户端链接都连到少数几个热点服务上。
+ *        热点服务的索引间隔为线程数，多线程模式下按顺序分配io时它们都落在第0个io上，
+ *        只能用到一个线程；共享模式下每个热点服务有自己的 strand，可以同时在不同线程上运行。
+ *        同一个服务的回调始终串行，只有一个热点服务时两种模式的上限相同
+ */
+
+/// 模拟每次处理消耗的cpu时间
+void Spin(std::chrono::microseconds work) {
+  if (work.count() == 0) return;
+  auto end = std::chrono::steady_clock::now() + work;
+  while (std::chrono::steady_clock::now() < end) {}
+}
+
+class SkewServer : public bamboo::server::ServerIf {
+ public:
+  SkewServer(boost::asio::io_context& io, std::string name, std::size_t index,
+             uint16_t port, std::chrono::microseconds work) : ServerIf(io, std::move(name), index),
+                                                              port_(port),
+                                                              work_(work) {}
+  virtual ~SkewServer() {}
+
+  void Configure(boost::program_options::variables_map&) override {}
+
+ protected:
+  bool PrepareStart() override {
+    auto acceptor = CreateAcceptor<bamboo::net::SimpleAcceptor>("127.0.0.1", port_);
+    if (!acceptor) return false;
+    auto mgr = acceptor->CreateConnManager<bamboo::net::SimpleConnManager>();
+    auto protocol = std::make_shared<bamboo::protocol::EchoProtocol>();
+    auto work = work_;
+    mgr->SetReadHandler([protocol, work](bamboo::net::SocketPtr so, const char* data, std::size_t size) -> std::size_t {
+      Spin(work);
+      return protocol->ReceiveData(so, data, size);
+    });
+    return true;
+  }
+
+  bool FinishStart() override { return true; }
+  void StopHandle() override {}
+
+ private:
+  uint16_t port_;
+  std::chrono::microseconds work_;
+};
+
+/// 发送固定长度的数据，收到完整回显后再发送下一次
+class Client : public std::enable_shared_from_this<Client> {
+ public:
+  Client(boost::asio::io_context& io, std::size_t size, std::atomic<uint64_t>& rounds) : socket_(io),
+                                                                                        data_(size, 'x'),
+                                                                                        reply_(size),
+                                                                                        rounds_(rounds) {}
+
+  bool Connect(uint16_t port) {
+    boost::system::error_code ec;
+    socket_.connect(boost::asio::ip::tcp::endpoint(boost::asio::ip::make_address("127.0.0.1"), port), ec);
+    if (ec) return false;
+    socket_.set_option(boost::asio::ip::tcp::no_delay(true), ec);
+    return true;
+  }
+
+  void Round() {
+    auto self = shared_from_this();
+    boost::asio::async_write(socket_, boost::asio::buffer(data_), [this, self](const boost::system::error_code& ec,
+                                                                               std::size_t) {
+      if (ec) return;
+      boost::asio::async_read(socket_, boost::asio::buffer(reply_), [this, self](const boost::system::error_code& ec,
+                                                                                 std::size_t) {
+        if (ec) return;
+        rounds_.fetch_add(1, std::memory_order_relaxed);
+        Round();
+      });
+    });
+  }
+
+  void Close() {
+    boost::system::error_code ec;
+    socket_.close(ec);
+  }
+
+ private:
+  boost::asio::ip::tcp::socket socket_;
+  std::string data_;
+  std::vector<char> reply_;
+  std::atomic<uint64_t>& rounds_;
+};
+
+int main(int argc, char* argv[]) {
+  std::string mode;
+  uint16_t port;
+  std::size_t servers, hotServers, clients, size, seconds, threads, clientThreads;
+  double hot;
+  long work;
+  boost::program_options::variables_map vm;
+  try {
+    boost::program_options::options_description desc("skewed echo benchmark option");
+    desc.add_options()
+        ("help,h", "print all help manuals")
+        ("mode,m", boost::program_options::value<std::string>(&mode)->default_value("shared"), "multiple or shared")
+        ("port,p", boost::program_options::value<uint16_t>(&port)->default_value(19200), "first server port")
+        ("servers,s", boost::program_options::value<std::size_t>(&servers)->default_value(8), "server count")
+        ("hot-servers", boost::program_options::value<std::size_t>(&hotServers)->default_value(2), "hot server count")
+        ("clients,c", boost::program_options::value<std::size_t>(&clients)->default_value(64), "client connections")
+        ("hot", boost::program_options::value<double>(&hot)->default_value(0.8), "share of clients on the hot servers")
+        ("size", boost::program_options::value<std::size_t>(&size)->default_value(256), "message size")
+        ("work,w", boost::program_options::value<long>(&work)->default_value(20), "cpu microseconds per message")
+        ("threads,t", boost::program_options::value<std::size_t>(&threads)->default_value(0), "io threads, 0 for cpu count")
+        ("client-threads", boost::program_options::value<std::size_t>(&clientThreads)->default_value(2), "client threads")
+        ("seconds", boost::program_options::value<std::size_t>(&seconds)->default_value(5), "run seconds");
+
+    boost::program_options::store(boost::program_options::parse_command_line(argc, argv, desc), vm);
+    if (vm.count("help")) {
+      std::cout << desc << std::endl;
+      return EXIT_SUCCESS;
+    }
+    boost::program_options::notify(vm);
+  } catch (std::exception& e) {
+    std::cout << e.what() << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  if (servers == 0 || clients == 0) return EXIT_FAILURE;
+  if (threads == 0) threads = std::max(std::thread::hardware_concurrency(), 2u);
+
+  // 热点服务在多线程模式下都分配到同一个io
+  std::vector<std::size_t> hotList, coldList;
+  for (std::size_t i = 0; i < servers; ++i) {
+    if (i % threads == 0 && hotList.size() < std::max<std::size_t>(hotServers, 1)) {
+      hotList.push_back(i);
+    } else {
+      coldList.push_back(i);
+    }
+  }
+  if (coldList.empty()) coldList = hotList;
+
+  bamboo::aio::Topology topology;
+  if (mode == "shared") {
+    topology.threadSize = threads;
+    bamboo::env::Init(bamboo::env::ThreadMode::SHARED, topology);
+  } else {
+    topology.ioSize = threads;
+    bamboo::env::Init(bamboo::env::ThreadMode::MULTIPLE, topology);
+  }
+  auto aio = bamboo::env::GetIo();
+  for (std::size_t i = 0; i < servers; ++i) {
+    aio->CreateServer<SkewServer>("skew-echo", static_cast<uint16_t>(port + i), std::chrono::microseconds(work));
+  }
+
+  boost::asio::io_context clientIo;
+  std::atomic<uint64_t> rounds{0};
+  std::vector<std::shared_ptr<Client>> list;
+  std::vector<std::thread> clientPool;
+
+  std::thread load([&]() {
+    // 等待服务开始监听
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    std::size_t hotClients = static_cast<std::size_t>(clients * hot);
+    for (std::size_t i = 0; i < clients; ++i) {
+      std::size_t server = i < hotClients ? hotList[i % hotList.size()] : coldList[i % coldList.size()];
+      auto client = std::make_shared<Client>(clientIo, size, rounds);
+      if (!client->Connect(static_cast<uint16_t>(port + server))) {
+        std::cout << "connect to server " << server << " fail" << std::endl;
+        continue;
+      }
+      list.push_back(client);
+    }
+    for (auto& client : list) client->Round();
+
+    auto guard = boost::asio::make_work_guard(clientIo);
+    for (std::size_t i = 0; i < clientThreads; ++i) {
+      clientPool.emplace_back([&clientIo]() { clientIo.run(); });
+    }
+
+    // 预热一秒后开始计数
+    std::this_thread::sleep_for(std::chrono::seconds(1));
+    uint64_t begin = rounds.load();
+    auto start = std::chrono::steady_clock::now();
+    std::this_thread::sleep_for(std::chrono::seconds(seconds));
+    uint64_t done = rounds.load() - begin;
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << mode << " threads:" << threads << " servers:" << servers << " hot servers:" << hotList.size()
+              << " clients:" << list.size()
+              << " hot:" << hot << " work:" << work << "us"
+              << " -> " << static_cast<uint64_t>(done / elapsed) << " round trips/s" << std::endl;
+
+    boost::asio::post(clientIo, [&list]() {
+      for (auto& client : list) client->Close();
+    });
+    guard.reset();
+    clientIo.stop();
+    for (auto& thread : clientPool) thread.join();
+    boost::asio::post(aio->GetMasterIo(), [aio]() { aio->Stop(); });
+  });
+
+  aio->Start();
+  load.join();
+  bamboo::env::Close();
+  return 0;
+}
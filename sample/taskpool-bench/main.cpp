@@ -0,0 +1,141 @@
+#include <iostream>
+#include <list>
+
+#include <bamboo/bamboo.hpp>
+
+using Clock = std::chrono::steady_clock;
+
+/**
+ * 旧版本的任务池，作为对比：一个全局队列，并且在持有锁的时候执行任务
+ */
+class LegacyPool final {
+ public:
+  LegacyPool(std::size_t size) {
+    for (std::size_t i = 0; i < size; ++i) {
+      threads_.emplace_back(&LegacyPool::TaskMain, this);
+    }
+  }
+
+  ~LegacyPool() {
+    isRunning_ = false;
+    cond_.notify_all();
+    for (auto& thread : threads_) {
+      thread.join();
+    }
+  }
+
+  void Add(std::function<void()>&& handle) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    list_.push_back(std::move(handle));
+    cond_.notify_one();
+  }
+
+ private:
+  void TaskMain() {
+    while (isRunning_.load()) {
+      std::unique_lock<std::mutex> lock(mutex_);
+      if (list_.empty()) {
+        cond_.wait_for(lock, std::chrono::milliseconds(10));
+      } else {
+        std::function<void()> h = std::move(list_.front());
+        list_.pop_front();
+        h();
+        std::this_thread::yield();
+      }
+    }
+  }
+
+  std::list<std::function<void()>> list_;
+  std::mutex mutex_;
+  std::condition_variable cond_;
+  std::vector<std::thread> threads_;
+  std::atomic_bool isRunning_{true};
+};
+
+/// 模拟很小的任务
+void Work(std::atomic<std::size_t>& done, std::size_t spin) {
+  volatile std::size_t sum = 0;
+  for (std::size_t i = 0; i < spin; ++i) sum = sum + i;
+  done.fetch_add(1, std::memory_order_relaxed);
+}
+
+void WaitDone(std::atomic<std::size_t>& done, std::size_t count) {
+  while (done.load() < count) {
+    std::this_thread::sleep_for(std::chrono::microseconds(100));
+  }
+}
+
+void Report(const char* name, std::size_t count, Clock::time_point start) {
+  double ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+  std::cout << name << ": " << count << " tasks in " << ms << " ms, "
+            << static_cast<std::size_t>(count / ms * 1000) << " tasks/s" << std::endl;
+}
+
+/**
+ * 外部线程提交全部任务
+ */
+template <typename POOL>
+void BenchExternal(const char* name, std::size_t threads, std::size_t count, std::size_t spin) {
+  std::atomic<std::size_t> done{0};
+  POOL pool(threads);
+  auto start = Clock::now();
+  for (std::size_t i = 0; i < count; ++i) {
+    pool.Add([&done, spin]() { Work(done, spin); });
+  }
+  WaitDone(done, count);
+  Report(name, count, start);
+}
+
+/**
+ * 每个种子任务在工作线程中继续提交子任务
+ */
+template <typename POOL>
+void BenchSpawn(const char* name, std::size_t threads, std::size_t count, std::size_t spin) {
+  std::atomic<std::size_t> done{0};
+  POOL pool(threads);
+  std::size_t seeds = threads * 4;
+  std::size_t children = count / seeds;
+  auto start = Clock::now();
+  for (std::size_t i = 0; i < seeds; ++i) {
+    pool.Add([&pool, &done, children, spin]() {
+      for (std::size_t j = 0; j < children; ++j) {
+        pool.Add([&done, spin]() { Work(done, spin); });
+      }
+    });
+  }
+  WaitDone(done, seeds * children);
+  Report(name, seeds * children, start);
+}
+
+int main(int argc, char* argv[]) {
+  std::size_t threads;
+  std::size_t count;
+  std::size_t spin;
+  boost::program_options::variables_map vm;
+  try {
+    boost::program_options::options_description desc("task pool benchmark option");
+    desc.add_options()
+        ("help,h", "print all help manuals")
+        ("thread,t", boost::program_options::value<std::size_t>(&threads)->default_value(std::thread::hardware_concurrency()), "worker thread count")
+        ("count,n", boost::program_options::value<std::size_t>(&count)->default_value(1000000), "task count")
+        ("spin,s", boost::program_options::value<std::size_t>(&spin)->default_value(50), "loop count of every task");
+
+    boost::program_options::store(boost::program_options::parse_command_line(argc, argv, desc), vm);
+    if (vm.count("help")) {
+      std::cout << desc << std::endl;
+      return EXIT_SUCCESS;
+    }
+    boost::program_options::notify(vm);
+  } catch (std::exception& e) {
+    std::cout << e.what() << std::endl;
+    return EXIT_FAILURE;
+  }
+  threads = std::max<std::size_t>(threads, 1);
+
+  BenchExternal<LegacyPool>("legacy external", threads, count, spin);
+  BenchExternal<bamboo::concurrency::TaskPool>("taskpool external", threads, count, spin);
+  // 旧版本在持有锁的时候执行任务，任务里再提交任务会死锁，没有办法对比
+  std::cout << "legacy spawn: skipped, Add inside a task deadlocks" << std::endl;
+  BenchSpawn<bamboo::concurrency::TaskPool>("taskpool spawn", threads, count, spin);
+  return 0;
+}
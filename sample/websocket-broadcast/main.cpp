@@ -0,0 +1,213 @@
+#include <iostream>
+#include <chrono>
+#include <vector>
+
+#include <bamboo/bamboo.hpp>
+
+/**
+ * websocket 广播测试
+ *
+ * @brief 先测试掩码异或的吞吐，和逐字节处理对比；
+ *        然后同一个进程里启动服务端和多个客户端，服务端分批给所有客户端发送同一条消息，
+ *        分别使用逐个链接 Send 和 Broadcast，每批等所有客户端收完后再发下一批，
+ *        对比服务端编码发送的耗时和整体吞吐。--deflate 时客户端协商 permessage-deflate
+ */
+
+using Opcode = bamboo::protocol::WebSocketProtocol::Opcode;
+
+void UnmaskBench(std::size_t size, std::size_t rounds) {
+  const char key[4] = {'\x12', '\x34', '\x56', '\x78'};
+  std::string src(size, 'x');
+  std::string dst(size, '\0');
+
+  auto begin = std::chrono::steady_clock::now();
+  for (std::size_t r = 0; r < rounds; ++r) {
+    bamboo::protocol::WebSocketProtocol::Unmask(&dst[0], src.data(), size, key, r);
+  }
+  double vector = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+  begin = std::chrono::steady_clock::now();
+  for (std::size_t r = 0; r < rounds; ++r) {
+    // 防止编译器把逐字节的循环向量化
+    volatile char* out = &dst[0];
+    for (std::size_t i = 0; i < size; ++i) out[i] = src[i] ^ key[(r + i) & 3];
+  }
+  double bytewise = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+  double total = static_cast<double>(size) * rounds / 1024 / 1024 / 1024;
+  std::cout << "unmask " << size << " bytes: Unmask " << total / vector << " GB/s, bytewise "
+            << total / bytewise << " GB/s" << std::endl;
+}
+
+class BroadcastBench : public bamboo::server::ServerIf {
+ public:
+  BroadcastBench(boost::asio::io_context& io, std::string name, std::size_t index, uint16_t port,
+                 std::size_t clients, std::size_t size, std::size_t batch, std::size_t batches, bool deflate)
+      : ServerIf(io, std::move(name), index), port_(port), clients_(clients), batch_(batch), batches_(batches),
+        deflate_(deflate) {
+    // 重复的 json 内容，压缩比接近真实的推送消息
+    while (message_.size() < size) message_.append("{\"symbol\":\"bamboo\",\"price\":" + std::to_string(message_.size()) + "},");
+    message_.resize(size);
+  }
+  virtual ~BroadcastBench() {}
+
+  void Configure(boost::program_options::variables_map&) override {}
+
+ protected:
+  bool PrepareStart() override {
+    auto acceptor = CreateAcceptor<bamboo::net::SimpleAcceptor>("127.0.0.1", port_);
+    if (!acceptor) return false;
+    serverMgr_ = acceptor->CreateConnManager<bamboo::net::SimpleConnManager>();
+    ws_ = serverMgr_->CreateProtocol<bamboo::protocol::WebSocketProtocol>();
+    ws_->SetAcceptHandler([this](bamboo::net::SocketPtr so, const bamboo::protocol::HttpRequest&) {
+      sockets_.push_back(so);
+      return true;
+    });
+
+    connector_ = CreateConnector<bamboo::net::SimpleConnector>();
+    auto manager = connector_->CreateConnManager<bamboo::net::SimpleConnManager>();
+    manager->SetReadHandler([this](bamboo::net::SocketPtr so, const char* data, std::size_t size) {
+      return OnClientData(so, data, size);
+    });
+    return true;
+  }
+
+  bool FinishStart() override {
+    std::string request = "GET /bench HTTP/1.1\r\nHost: bench\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n"
+                          "Sec-WebSocket-Key: dGhlIHNhbXBsZSBub25jZQ==\r\nSec-WebSocket-Version: 13\r\n";
+    if (deflate_) request.append("Sec-WebSocket-Extensions: permessage-deflate\r\n");
+    request.append("\r\n");
+    for (std::size_t i = 0; i < clients_; ++i) {
+      connector_->AsyncConnect("127.0.0.1", port_, [request](const boost::system::error_code& ec,
+                                                             bamboo::net::SocketPtr so) {
+        if (!so) {
+          std::cout << "connect fail:" << ec.message() << std::endl;
+          return;
+        }
+        so->WriteData(request.data(), request.size());
+      }, 1000);
+    }
+    return true;
+  }
+
+  void StopHandle() override {}
+
+ private:
+  std::size_t OnClientData(bamboo::net::SocketPtr so, const char* data, std::size_t size) {
+    auto it = received_.find(so->GetId());
+    if (it == received_.end()) {
+      // 还没有收到握手回复
+      std::string head(data, size);
+      auto end = head.find("\r\n\r\n");
+      if (end == std::string::npos) return 0;
+      received_[so->GetId()] = 0;
+      if (received_.size() == clients_) {
+        frameSize_ = ws_->Encode(Opcode::TEXT, message_.data(), message_.size(), deflate_)->size();
+        std::cout << "clients:" << clients_ << " message:" << message_.size() << " frame:" << frameSize_
+                  << (deflate_ ? " deflate" : "") << std::endl;
+        StartRound(false);
+      }
+      return end + 4;
+    }
+    it->second += size;
+    if (it->second == frameSize_ * batch_ && ++finished_ == clients_) NextBatch();
+    return size;
+  }
+
+  void StartRound(bool broadcast) {
+    broadcast_ = broadcast;
+    batch_index_ = 0;
+    sendTime_ = 0;
+    begin_ = std::chrono::steady_clock::now();
+    SendBatch();
+  }
+
+  void SendBatch() {
+    finished_ = 0;
+    for (auto& it : received_) it.second = 0;
+
+    auto begin = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < batch_; ++i) {
+      if (broadcast_) {
+        ws_->Broadcast(*serverMgr_, Opcode::TEXT, message_.data(), message_.size());
+      } else {
+        for (auto& so : sockets_) ws_->Send(so, Opcode::TEXT, message_.data(), message_.size());
+      }
+    }
+    sendTime_ += std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+  }
+
+  void NextBatch() {
+    if (++batch_index_ < batches_) {
+      SendBatch();
+      return;
+    }
+
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin_).count();
+    double messages = static_cast<double>(batch_) * batches_;
+    std::cout << (broadcast_ ? "Broadcast" : "Send loop") << ": " << static_cast<uint64_t>(messages / elapsed)
+              << " msg/s, " << static_cast<uint64_t>(messages * clients_ / elapsed) << " deliveries/s, send "
+              << sendTime_ * 1e6 / messages << "us/msg" << std::endl;
+    if (!broadcast_) {
+      StartRound(true);
+      return;
+    }
+    auto aio = bamboo::env::GetIo();
+    boost::asio::post(aio->GetMasterIo(), [aio]() { aio->Stop(); });
+  }
+
+  uint16_t port_;
+  std::size_t clients_;
+  std::size_t batch_;
+  std::size_t batches_;
+  bool deflate_;
+  std::string message_;
+  std::shared_ptr<bamboo::net::SimpleConnManager> serverMgr_;
+  std::shared_ptr<bamboo::protocol::WebSocketProtocol> ws_;
+  std::shared_ptr<bamboo::net::SimpleConnector> connector_;
+  std::vector<bamboo::net::SocketPtr> sockets_;
+  std::unordered_map<uint64_t, std::size_t> received_;
+  std::size_t finished_{0};
+  std::size_t frameSize_{0};
+  std::size_t batch_index_{0};
+  bool broadcast_{false};
+  double sendTime_{0};
+  std::chrono::steady_clock::time_point begin_;
+};
+
+int main(int argc, char* argv[]) {
+  uint16_t port;
+  std::size_t clients, size, batch, batches;
+  boost::program_options::variables_map vm;
+  try {
+    boost::program_options::options_description desc("websocket broadcast option");
+    desc.add_options()
+        ("help,h", "print all help manuals")
+        ("port,p", boost::program_options::value<uint16_t>(&port)->default_value(19900), "server listen port")
+        ("clients,c", boost::program_options::value<std::size_t>(&clients)->default_value(200), "client connections")
+        ("size", boost::program_options::value<std::size_t>(&size)->default_value(1024), "message size")
+        ("batch", boost::program_options::value<std::size_t>(&batch)->default_value(50), "messages per batch")
+        ("batches", boost::program_options::value<std::size_t>(&batches)->default_value(40), "batch count")
+        ("deflate", "negotiate permessage-deflate");
+
+    boost::program_options::store(boost::program_options::parse_command_line(argc, argv, desc), vm);
+    if (vm.count("help")) {
+      std::cout << desc << std::endl;
+      return EXIT_SUCCESS;
+    }
+    boost::program_options::notify(vm);
+  } catch (std::exception& e) {
+    std::cout << e.what() << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  for (std::size_t n : {125, 1024, 65536}) UnmaskBench(n, 1024 * 1024 * 256 / n);
+
+  bamboo::env::Init();
+  auto aio = bamboo::env::GetIo();
+  aio->CreateServer<BroadcastBench>("websocket-broadcast", port, clients, size, batch, batches,
+                                    vm.count("deflate") > 0);
+  aio->Start();
+  bamboo::env::Close();
+  return 0;
+}
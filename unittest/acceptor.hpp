@@ -0,0 +1,85 @@
+#pragma once
+
+#include <gtest/gtest.h>
+
+#include <bamboo/aio/aio.hpp>
+#include <bamboo/net/shardedacceptor.hpp>
+#include <bamboo/net/simpleacceptor.hpp>
+#include <bamboo/net/simpleconnmanager.hpp>
+#include <bamboo/server/simpleserver.hpp>
+
+namespace {
+
+/// 模拟系统不支持 SO_REUSEPORT
+class NoReusePortAcceptor : public bamboo::net::ShardedAcceptor {
+ public:
+  using bamboo::net::ShardedAcceptor::ShardedAcceptor;
+
+ protected:
+  bool EnableReusePort(boost::asio::ip::tcp::acceptor&) override { return false; }
+};
+
+}
+
+TEST(ShardedAcceptor, ReusePort) {
+  bamboo::aio::Aio aio;
+  auto& io = aio.GetMasterIo();
+
+  // 同一个端口上三个分片，端口由第一个分片向系统申请
+  std::vector<std::shared_ptr<bamboo::net::SimpleConnManager>> managers;
+  uint16_t port = 0;
+  for (int i = 0; i < 3; ++i) {
+    auto server = aio.CreateServer<bamboo::server::SimpleServer>("shard").first;
+    auto acceptor = server->CreateAcceptor<bamboo::net::ShardedAcceptor>("127.0.0.1", port);
+    ASSERT_TRUE(acceptor != nullptr);
+    ASSERT_TRUE(acceptor->IsReusePort());
+    port = acceptor->GetLocalEndpoint().port();
+    managers.push_back(acceptor->CreateConnManager<bamboo::net::SimpleConnManager>());
+    acceptor->Start();
+  }
+
+  // 内核按四元组分配，足够多的链接会落到每一个分片上
+  const std::size_t count = 64;
+  std::vector<std::unique_ptr<boost::asio::ip::tcp::socket>> clients;
+  boost::asio::ip::tcp::endpoint endpoint(boost::asio::ip::make_address("127.0.0.1"), port);
+  for (std::size_t i = 0; i < count; ++i) {
+    clients.emplace_back(new boost::asio::ip::tcp::socket(io));
+    clients.back()->connect(endpoint);
+  }
+  std::size_t accepted = 0;
+  for (int i = 0; i < 1000 && accepted < count; ++i) {
+    io.run_one_for(std::chrono::milliseconds(10));
+    accepted = 0;
+    for (auto& manager : managers) accepted += manager->GetSocketSize();
+  }
+  ASSERT_EQ(accepted, count);
+  for (auto& manager : managers) ASSERT_GT(manager->GetSocketSize(), 0);
+}
+
+TEST(ShardedAcceptor, Fallback) {
+  bamboo::aio::Aio aio;
+  auto& io = aio.GetMasterIo();
+
+  // 不支持时第一个分片按普通方式监听，之后的分片绑定失败
+  auto server = aio.CreateServer<bamboo::server::SimpleServer>("shard").first;
+  auto first = server->CreateAcceptor<NoReusePortAcceptor>("127.0.0.1", 0);
+  ASSERT_TRUE(first != nullptr);
+  ASSERT_FALSE(first->IsReusePort());
+  uint16_t port = first->GetLocalEndpoint().port();
+  ASSERT_NE(port, 0);
+  auto manager = first->CreateConnManager<bamboo::net::SimpleConnManager>();
+  first->Start();
+
+  auto other = aio.CreateServer<bamboo::server::SimpleServer>("shard").first;
+  ASSERT_TRUE(other->CreateAcceptor<NoReusePortAcceptor>("127.0.0.1", port) == nullptr);
+
+  boost::asio::ip::tcp::socket client(io);
+  client.connect(boost::asio::ip::tcp::endpoint(boost::asio::ip::make_address("127.0.0.1"), port));
+  for (int i = 0; i < 100 && manager->GetSocketSize() == 0; ++i) io.run_one_for(std::chrono::milliseconds(10));
+  ASSERT_EQ(manager->GetSocketSize(), 1);
+
+  // 普通的监听助手不开启
+  auto simple = aio.CreateServer<bamboo::server::SimpleServer>("simple").first->CreateAcceptor<bamboo::net::SimpleAcceptor>("127.0.0.1", 0);
+  ASSERT_TRUE(simple != nullptr);
+  ASSERT_FALSE(simple->IsReusePort());
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <gtest/gtest.h>
+
+#include <sched.h>
+#include <algorithm>
+
+#include <bamboo/utility/affinity.hpp>
+#include <bamboo/aio/topology.hpp>
+
+TEST(Affinity, ParseCpuList) {
+  ASSERT_EQ(bamboo::utility::ParseCpuList("0-3,8,10-11"), std::vector<int>({0, 1, 2, 3, 8, 10, 11}));
+  ASSERT_EQ(bamboo::utility::ParseCpuList(""), std::vector<int>());
+  ASSERT_EQ(bamboo::utility::ParseCpuList("x,2,3-1"), std::vector<int>({2}));
+}
+
+TEST(Affinity, BindCpus) {
+  ASSERT_TRUE(bamboo::utility::BindCpus({}));
+  // 容器或者 taskset 下 cpu 0 不一定可用，从进程允许的集合里选一个
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  ASSERT_EQ(::sched_getaffinity(0, sizeof(set), &set), 0);
+  int cpu = 0;
+  while (cpu < CPU_SETSIZE && !CPU_ISSET(cpu, &set)) ++cpu;
+  ASSERT_LT(cpu, CPU_SETSIZE);
+
+  std::thread thread([cpu]() {
+    ASSERT_TRUE(bamboo::utility::BindCpus({cpu}));
+    ASSERT_EQ(::sched_getcpu(), cpu);
+  });
+  thread.join();
+}
+
+TEST(Topology, Parse) {
+  auto topology = bamboo::aio::Topology::Parse("0;1;2-3", "4-5");
+  ASSERT_EQ(topology.ioSize, 3);
+  ASSERT_EQ(topology.ioCpus[2], std::vector<int>({2, 3}));
+  ASSERT_EQ(topology.workerCpus, std::vector<int>({4, 5}));
+
+  auto allowed = bamboo::utility::AllowedCpus();
+  ASSERT_EQ(allowed.size(), bamboo::utility::CpuCount());
+  auto pinned = bamboo::aio::Topology::Pinned(1);
+  ASSERT_EQ(pinned.ioSize, 1);
+  ASSERT_EQ(pinned.ioCpus[0], std::vector<int>({allowed[0]}));
+  ASSERT_EQ(pinned.workerCpus, std::vector<int>(allowed.begin() + 1, allowed.end()));
+  ASSERT_EQ(bamboo::aio::Topology::Pinned(0).ioSize, allowed.size());
+}
+
+TEST(Topology, PinnedWrap) {
+  auto allowed = bamboo::utility::AllowedCpus();
+  int cpus = static_cast<int>(allowed.size());
+  // 从最后一个允许的cpu开始，第二个io绕回到第一个允许的cpu
+  auto pinned = bamboo::aio::Topology::Pinned(2, cpus - 1);
+  ASSERT_EQ(pinned.ioCpus[0], std::vector<int>({allowed.back()}));
+  ASSERT_EQ(pinned.ioCpus[1], std::vector<int>({allowed.front()}));
+  for (auto& io : pinned.ioCpus) {
+    ASSERT_EQ(std::count(pinned.workerCpus.begin(), pinned.workerCpus.end(), io.front()), 0);
+  }
+  for (int cpu : pinned.workerCpus) {
+    ASSERT_EQ(std::count(allowed.begin(), allowed.end(), cpu), 1);
+  }
+  ASSERT_EQ(pinned.workerCpus.size(), static_cast<std::size_t>(std::max(cpus - 2, 0)));
+}
+
+TEST(Topology, PinnedAffinity) {
+  // 进程只允许使用一部分cpu时，io和工作线程都不会用到集合以外的cpu
+  auto allowed = bamboo::utility::AllowedCpus();
+  cpu_set_t saved;
+  ASSERT_EQ(::sched_getaffinity(0, sizeof(saved), &saved), 0);
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  CPU_SET(allowed.back(), &set);
+  ASSERT_EQ(::sched_setaffinity(0, sizeof(set), &set), 0);
+
+  auto pinned = bamboo::aio::Topology::Pinned(0);
+  ASSERT_EQ(::sched_setaffinity(0, sizeof(saved), &saved), 0);
+  ASSERT_EQ(pinned.ioSize, 1);
+  ASSERT_EQ(pinned.ioCpus[0], std::vector<int>({allowed.back()}));
+  ASSERT_TRUE(pinned.workerCpus.empty());
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <gtest/gtest.h>
+
+#include <boost/asio/executor_work_guard.hpp>
+
+#include <bamboo/concurrency/asyncrun.hpp>
+
+TEST(AsyncRun, CallbackOnIo) {
+  boost::asio::io_context io;
+  auto work = boost::asio::make_work_guard(io);
+  auto ioThread = std::this_thread::get_id();
+  int sum = 0;
+  int done = 0;
+  {
+    bamboo::concurrency::AsyncRun async(io, 2);
+    for (int i = 1; i <= 100; ++i) {
+      ASSERT_TRUE(async.Run(std::function<int()>([i]() { return i; }), std::function<void(int)>([&](int v) {
+        ASSERT_EQ(std::this_thread::get_id(), ioThread);
+        sum += v;
+        if (++done == 100) work.reset();
+      })));
+    }
+    io.run();
+
+    auto stats = async.GetStats();
+    ASSERT_EQ(stats.submitted, 100);
+    ASSERT_EQ(stats.completed, 100);
+    ASSERT_EQ(stats.pending, 0);
+    ASSERT_GE(stats.totalTime, stats.runTime);
+  }
+  ASSERT_EQ(sum, 5050);
+}
+
+TEST(AsyncRun, MaxPending) {
+  boost::asio::io_context io;
+  auto work = boost::asio::make_work_guard(io);
+  bamboo::concurrency::AsyncRun async(io, 1, 2);
+  int done = 0;
+  auto call = []() { return 1; };
+  auto cb = [&](int) {
+    if (++done == 2) work.reset();
+  };
+  ASSERT_TRUE(async.Run(std::function<int()>(call), std::function<void(int)>(cb)));
+  ASSERT_TRUE(async.Run(std::function<int()>(call), std::function<void(int)>(cb)));
+  // 回调还没有在io上执行，任务仍然算作未完成
+  ASSERT_FALSE(async.Run(std::function<int()>(call), std::function<void(int)>(cb)));
+  ASSERT_EQ(async.GetStats().rejected, 1);
+
+  io.run();
+  ASSERT_EQ(async.GetStats().pending, 0);
+  ASSERT_TRUE(async.Run(std::function<int()>(call), std::function<void(int)>(cb)));
+}
+
+TEST(AsyncRun, Exception) {
+  boost::asio::io_context io;
+  auto work = boost::asio::make_work_guard(io);
+  bamboo::concurrency::AsyncRun async(io, 1, 1);
+
+  // 任务抛出任意类型的异常都算失败，不执行回调
+  bool called = false;
+  ASSERT_TRUE(async.Run(std::function<int()>([]() -> int { throw 1; }),
+                        std::function<void(int)>([&](int) { called = true; })));
+  while (async.GetStats().pending > 0) std::this_thread::yield();
+  ASSERT_FALSE(called);
+  ASSERT_EQ(async.GetStats().failed, 1);
+
+  // 回调抛出异常时任务仍然完成
+  ASSERT_TRUE(async.Run(std::function<int()>([]() { return 1; }),
+                        std::function<void(int)>([&](int) {
+                          work.reset();
+                          throw std::runtime_error("callback");
+                        })));
+  ASSERT_THROW(io.run(), std::runtime_error);
+  auto stats = async.GetStats();
+  ASSERT_EQ(stats.completed, 1);
+  ASSERT_EQ(stats.pending, 0);
+}
@@ -4,6 +4,8 @@
 
 #include <bamboo/buffer/dynamicbuffer.hpp>
 #include <bamboo/buffer/fixedbuffer.hpp>
+#include <bamboo/buffer/pooledbuffer.hpp>
+#include <bamboo/buffer/bufferpool.hpp>
 #include <bamboo/utility/singleton.hpp>
 
 TEST(dynamicBuffer, Init) {
@@ -29,6 +31,88 @@ TEST(FixedBuffer, Write) {
   ASSERT_EQ(buffer.Free(), buffer.Capacity() - nihao.length());
 }
 
+TEST(FixedBuffer, PartialReadNeverFills) {
+  bamboo::buffer::FixedBuffer<20> buffer;
+  std::string frame = "12345";
+  buffer.Write(frame.data(), 3);
+  for (int i = 0; i < 100; ++i) {
+    ASSERT_EQ(buffer.Write(frame.data(), frame.length()), frame.length());
+    buffer.Skip(frame.length());
+  }
+  ASSERT_EQ(buffer.Size(), 3);
+}
+
+TEST(FixedBuffer, Prepare) {
+  bamboo::buffer::FixedBuffer<20> buffer;
+  std::string data(16, 'a');
+  buffer.Write(data.data(), data.length());
+  buffer.Skip(10);
+  ASSERT_EQ(buffer.Free(), 4);
+  char* head = buffer.Data();
+
+  ASSERT_EQ(buffer.Prepare(4), 4);
+  ASSERT_EQ(buffer.Data(), head);
+
+  ASSERT_EQ(buffer.Prepare(8), 14);
+  ASSERT_EQ(buffer.Size(), 6);
+  ASSERT_EQ(std::string(buffer.Data(), buffer.Size()), "aaaaaa");
+}
+
+TEST(dynamicBuffer, PrepareCompact) {
+  bamboo::buffer::DynamicBuffer buffer;
+  std::string data(100, 'a');
+  buffer.Write(data.data(), data.length());
+  buffer.Skip(90);
+  ASSERT_EQ(buffer.Prepare(100), 118);
+  ASSERT_EQ(buffer.Capacity(), 128);
+}
+
+TEST(PooledBuffer, Init) {
+  bamboo::buffer::PooledBuffer buffer;
+  ASSERT_EQ(buffer.Capacity(), 0);
+  ASSERT_EQ(buffer.Size(), 0);
+}
+
+TEST(PooledBuffer, ReleaseWhenEmpty) {
+  auto& pool = bamboo::buffer::BufferPool::Local();
+  std::size_t cached = pool.CachedBytes();
+
+  bamboo::buffer::PooledBuffer buffer;
+  std::string nihao = "nihao";
+  buffer.Write(nihao.data(), nihao.length());
+  ASSERT_EQ(buffer.Size(), nihao.length());
+  ASSERT_EQ(buffer.Capacity(), bamboo::buffer::BufferPool::MIN_BLOCK);
+
+  buffer.Skip(2);
+  ASSERT_EQ(std::string(buffer.Data(), buffer.Size()), "hao");
+  buffer.Skip(3);
+  ASSERT_EQ(buffer.Capacity(), 0);
+  ASSERT_EQ(pool.CachedBytes(), cached + bamboo::buffer::BufferPool::MIN_BLOCK);
+}
+
+TEST(PooledBuffer, Grow) {
+  bamboo::buffer::PooledBuffer buffer;
+  std::string data(3000, 'a');
+  buffer.Write(data.data(), data.length());
+  buffer.Write(data.data(), data.length());
+  ASSERT_EQ(buffer.Size(), data.length() * 2);
+  ASSERT_EQ(buffer.Capacity(), 1024 * 8);
+}
+
+TEST(BufferPool, SizeClass) {
+  bamboo::buffer::BufferPool pool;
+  std::size_t size = 1500;
+  char* block = pool.Allocate(size);
+  ASSERT_EQ(size, 2048);
+  pool.Free(block, size);
+  ASSERT_EQ(pool.CachedBytes(), 2048);
+
+  std::size_t again = 2000;
+  ASSERT_EQ(pool.Allocate(again), block);
+  ASSERT_EQ(pool.CachedBytes(), 0);
+  pool.Free(block, again);
+}
+
 TEST(Singleton, int) {
   ASSERT_EQ(bamboo::utility::Singleton<int>::Instance(), bamboo::utility::Singleton<int>::Instance());
 }
\ No newline at end of file
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <gtest/gtest.h>
+
+#include <thread>
+
+#include <boost/asio/executor_work_guard.hpp>
+
+#include <bamboo/concurrency/channel.hpp>
+
+TEST(Channel, Bounded) {
+  bamboo::concurrency::Channel<int> channel(3);
+  ASSERT_EQ(channel.Capacity(), 4);
+  for (int i = 0; i < 4; ++i) {
+    ASSERT_TRUE(channel.TryPush(i));
+  }
+  ASSERT_FALSE(channel.TryPush(4));
+  ASSERT_EQ(channel.Size(), 4);
+
+  int value = -1;
+  for (int i = 0; i < 4; ++i) {
+    ASSERT_TRUE(channel.TryPop(value));
+    ASSERT_EQ(value, i);
+  }
+  ASSERT_FALSE(channel.TryPop(value));
+  ASSERT_TRUE(channel.Empty());
+}
+
+TEST(Channel, Timeout) {
+  bamboo::concurrency::Channel<int> channel(2);
+  int value = 0;
+  ASSERT_FALSE(channel.PopFor(value, std::chrono::milliseconds(10)));
+  ASSERT_TRUE(channel.PushFor(1, std::chrono::milliseconds(10)));
+  ASSERT_TRUE(channel.PushFor(2, std::chrono::milliseconds(10)));
+  ASSERT_FALSE(channel.PushFor(3, std::chrono::milliseconds(10)));
+  ASSERT_TRUE(channel.PopFor(value, std::chrono::milliseconds(10)));
+  ASSERT_EQ(value, 1);
+}
+
+TEST(Channel, Batch) {
+  bamboo::concurrency::Channel<int> channel(8);
+  std::vector<int> input{1, 2, 3, 4, 5, 6, 7, 8, 9, 10};
+  ASSERT_EQ(channel.TryPushBatch(input.begin(), input.end()), 8);
+
+  std::vector<int> output;
+  ASSERT_EQ(channel.TryPopBatch(output, 5), 5);
+  ASSERT_EQ(channel.PopBatch(output, 5), 3);
+  ASSERT_EQ(output, std::vector<int>({1, 2, 3, 4, 5, 6, 7, 8}));
+}
+
+TEST(Channel, MultiThread) {
+  bamboo::concurrency::Channel<uint64_t> channel(64);
+  const uint64_t count = 20000;
+  std::atomic<uint64_t> sum{0};
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 2; ++i) {
+    threads.emplace_back([&channel]() {
+      for (uint64_t v = 1; v <= count; ++v) channel.Push(v);
+    });
+    threads.emplace_back([&channel, &sum]() {
+      for (uint64_t n = 0; n < count; ++n) {
+        uint64_t v;
+        channel.Pop(v);
+        sum.fetch_add(v);
+      }
+    });
+  }
+  for (auto& thread : threads) thread.join();
+  ASSERT_EQ(sum.load(), count * (count + 1));
+  ASSERT_TRUE(channel.Empty());
+}
+
+TEST(Channel, AsyncPop) {
+  boost::asio::io_context io;
+  auto work = boost::asio::make_work_guard(io);
+  bamboo::concurrency::Channel<int> channel(16);
+  int received = 0;
+  std::function<void(int)> receive;
+  receive = [&](int v) {
+    ASSERT_EQ(v, received);
+    if (++received == 100) {
+      work.reset();
+      return;
+    }
+    channel.AsyncPop(io, std::function<void(int)>(receive));
+  };
+  channel.AsyncPop(io, std::function<void(int)>(receive));
+
+  std::thread producer([&channel]() {
+    for (int i = 0; i < 100; ++i) channel.Push(i);
+  });
+  io.run();
+  producer.join();
+  ASSERT_EQ(received, 100);
+}
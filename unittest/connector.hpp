@@ -0,0 +1,196 @@
+#pragma once
+
+#include <gtest/gtest.h>
+
+#include <bamboo/aio/aio.hpp>
+#include <bamboo/net/connectionpool.hpp>
+#include <bamboo/net/simpleacceptor.hpp>
+#include <bamboo/net/simpleconnector.hpp>
+#include <bamboo/net/simpleconnmanager.hpp>
+#include <bamboo/server/simpleserver.hpp>
+
+namespace {
+
+/// 一个服务上同时有监听助手和连接助手，连接到自己
+struct ConnectorEnv {
+  bamboo::aio::Aio aio;
+  std::shared_ptr<bamboo::server::SimpleServer> server = aio.CreateServer<bamboo::server::SimpleServer>("connector").first;
+  std::shared_ptr<bamboo::net::SimpleConnector> connector = server->CreateConnector<bamboo::net::SimpleConnector>();
+  std::shared_ptr<bamboo::net::SimpleConnManager> clientMgr =
+      connector->CreateConnManager<bamboo::net::SimpleConnManager>();
+  bamboo::net::AcceptorPtr acceptor;
+  std::shared_ptr<bamboo::net::SimpleConnManager> serverMgr;
+  uint16_t port{0};
+
+  void Listen() {
+    acceptor = server->CreateAcceptor<bamboo::net::SimpleAcceptor>("127.0.0.1", 0);
+    serverMgr = acceptor->CreateConnManager<bamboo::net::SimpleConnManager>();
+    acceptor->Start();
+    port = acceptor->GetLocalEndpoint().port();
+  }
+
+  template<typename PRED>
+  bool RunUntil(PRED pred) {
+    for (int i = 0; i < 500 && !pred(); ++i) aio.GetMasterIo().run_one_for(std::chrono::milliseconds(10));
+    return pred();
+  }
+};
+
+}
+
+TEST(Connector, ReconnectDelay) {
+  bamboo::net::ConnectorIf::ReconnectPolicy policy;
+  policy.jitter = 0;
+  ASSERT_EQ(policy.Delay(0, 1), 100);
+  ASSERT_EQ(policy.Delay(1, 1), 200);
+  ASSERT_EQ(policy.Delay(3, 1), 800);
+  // 到上限后不再增长，失败次数很大时也不会溢出
+  ASSERT_EQ(policy.Delay(9, 0), 30000);
+  ASSERT_EQ(policy.Delay(100000, 0), 30000);
+
+  // 抖动在 ±jitter 的比例内
+  policy.jitter = 0.2;
+  ASSERT_EQ(policy.Delay(2, 0), 400);
+  ASSERT_EQ(policy.Delay(2, 1), 480);
+  ASSERT_EQ(policy.Delay(2, -1), 320);
+  ASSERT_EQ(policy.Delay(2, 5), 480);
+  ASSERT_EQ(policy.Delay(20, -1), 24000);
+}
+
+TEST(Connector, AsyncConnectTimeout) {
+  ConnectorEnv env;
+  // 全连接队列满时内核丢弃新的 SYN，连接一直没有结果
+  auto& io = env.aio.GetMasterIo();
+  boost::asio::ip::tcp::acceptor full(io, boost::asio::ip::tcp::endpoint(boost::asio::ip::make_address("127.0.0.1"), 0));
+  full.listen(0);
+  auto endpoint = full.local_endpoint();
+  std::vector<std::unique_ptr<boost::asio::ip::tcp::socket>> fillers;
+  for (int i = 0; i < 4; ++i) {
+    fillers.emplace_back(new boost::asio::ip::tcp::socket(io));
+    fillers.back()->async_connect(endpoint, [](const boost::system::error_code&) {});
+  }
+
+  boost::system::error_code result;
+  bool done = false;
+  auto begin = std::chrono::steady_clock::now();
+  env.connector->AsyncConnect("127.0.0.1", endpoint.port(), [&](const boost::system::error_code& ec,
+                                                                 bamboo::net::SocketPtr so) {
+    ASSERT_TRUE(so == nullptr);
+    result = ec;
+    done = true;
+  }, 50);
+  ASSERT_TRUE(env.RunUntil([&]() { return done; }));
+  ASSERT_EQ(result, boost::asio::error::timed_out);
+  ASSERT_GE(std::chrono::steady_clock::now() - begin, std::chrono::milliseconds(50));
+  ASSERT_EQ(env.clientMgr->GetSocketSize(), 0);
+}
+
+TEST(Connector, ConnectionPool) {
+  ConnectorEnv env;
+  env.Listen();
+
+  bamboo::net::ConnectorIf::ReconnectPolicy policy;
+  policy.initialDelay = 1;
+  policy.jitter = 0;
+  auto pool = std::make_shared<bamboo::net::ConnectionPool>(env.connector, "127.0.0.1", env.port, 2, policy);
+  ASSERT_TRUE(pool->Select() == nullptr);
+  pool->Start();
+  ASSERT_TRUE(env.RunUntil([&]() { return pool->GetAliveSize() == 2 && env.serverMgr->GetSocketSize() == 2; }));
+
+  // 总是选择在途请求最少的链接
+  auto first = pool->Select();
+  pool->Begin(first);
+  auto second = pool->Select();
+  ASSERT_NE(first, second);
+  pool->Begin(second);
+  pool->Begin(second);
+  ASSERT_EQ(pool->Select(), first);
+  pool->End(second);
+  pool->End(second);
+  pool->End(second);
+  ASSERT_EQ(pool->Select(), second);
+  // 不属于连接池的链接不影响计数
+  pool->Begin(nullptr);
+  pool->End(nullptr);
+
+  // 断开后跳过，并自动重连
+  first->Close();
+  ASSERT_EQ(pool->GetAliveSize(), 1);
+  ASSERT_EQ(pool->Select(), second);
+  ASSERT_TRUE(env.RunUntil([&]() { return pool->GetAliveSize() == 2; }));
+  ASSERT_NE(pool->Select(), first);
+
+  // 停止后链接断开也不再重连
+  pool->Stop();
+  auto alive = pool->Select();
+  alive->Close();
+  env.aio.GetMasterIo().run_for(std::chrono::milliseconds(50));
+  ASSERT_EQ(pool->GetAliveSize(), 1);
+  ASSERT_EQ(env.clientMgr->GetSocketSize(), 1);
+}
+
+TEST(Connector, StopPendingConnect) {
+  ConnectorEnv env;
+  // 全连接队列满时连接一直没有结果，停止时还在进行中
+  auto& io = env.aio.GetMasterIo();
+  boost::asio::ip::tcp::acceptor full(io, boost::asio::ip::tcp::endpoint(boost::asio::ip::make_address("127.0.0.1"), 0));
+  full.listen(0);
+  auto endpoint = full.local_endpoint();
+  std::vector<std::unique_ptr<boost::asio::ip::tcp::socket>> fillers;
+  for (int i = 0; i < 4; ++i) {
+    fillers.emplace_back(new boost::asio::ip::tcp::socket(io));
+    fillers.back()->async_connect(endpoint, [](const boost::system::error_code&) {});
+  }
+
+  // 停止时回调收到 operation_aborted，超时计时器也一起取消
+  boost::system::error_code result;
+  int calls = 0;
+  env.connector->AsyncConnect("127.0.0.1", endpoint.port(), [&](const boost::system::error_code& ec,
+                                                                 bamboo::net::SocketPtr so) {
+    ASSERT_TRUE(so == nullptr);
+    result = ec;
+    ++calls;
+  }, 50);
+  io.run_for(std::chrono::milliseconds(10));
+  ASSERT_EQ(calls, 0);
+  env.connector->Stop();
+  ASSERT_EQ(calls, 1);
+  ASSERT_EQ(result, boost::asio::error::operation_aborted);
+  io.run_for(std::chrono::milliseconds(100));
+  ASSERT_EQ(calls, 1);
+  ASSERT_EQ(env.server->GetScheduler().Size(), 0);
+}
+
+TEST(Connector, DestroyPendingConnect) {
+  // 不经过 Aio 创建服务，服务和连接助手析构时不会先调用 Stop
+  struct LocalServer : public bamboo::server::SimpleServer {
+    explicit LocalServer(boost::asio::io_context& io) : SimpleServer(io, "local", 0) {}
+  };
+  boost::asio::io_context io;
+  boost::asio::ip::tcp::acceptor full(io, boost::asio::ip::tcp::endpoint(boost::asio::ip::make_address("127.0.0.1"), 0));
+  full.listen(0);
+  auto endpoint = full.local_endpoint();
+  std::vector<std::unique_ptr<boost::asio::ip::tcp::socket>> fillers;
+  for (int i = 0; i < 4; ++i) {
+    fillers.emplace_back(new boost::asio::ip::tcp::socket(io));
+    fillers.back()->async_connect(endpoint, [](const boost::system::error_code&) {});
+  }
+
+  auto server = std::make_shared<LocalServer>(io);
+  auto connector = server->CreateConnector<bamboo::net::SimpleConnector>();
+  connector->CreateConnManager<bamboo::net::SimpleConnManager>();
+  int calls = 0;
+  connector->AsyncConnect("127.0.0.1", endpoint.port(), [&](const boost::system::error_code&,
+                                                             bamboo::net::SocketPtr) {
+    ++calls;
+  }, 1000);
+  io.run_for(std::chrono::milliseconds(10));
+  ASSERT_EQ(calls, 0);
+
+  // 析构后取消的解析、连接和计时器的回调直接返回，不再访问连接助手
+  connector.reset();
+  server.reset();
+  io.restart();
+  io.run_for(std::chrono::milliseconds(50));
+  ASSERT_EQ(calls, 0);
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <gtest/gtest.h>
+
+#include "loopback.hpp"
+
+#include <bamboo/net/simpleconnmanager.hpp>
+
+TEST(ConnManager, Broadcast) {
+  boost::asio::io_context io;
+  auto mgr = std::make_shared<bamboo::net::SimpleConnManager>();
+  std::vector<boost::asio::ip::tcp::socket> clients;
+  std::vector<bamboo::net::SocketPtr> servers;
+  for (uint32_t i = 0; i < 4; ++i) {
+    auto sockets = unittest::Loopback(io);
+    clients.push_back(std::move(sockets.first));
+    servers.push_back(mgr->OnConnect(std::move(sockets.second)));
+    servers.back()->SetGroup(i % 2);
+  }
+
+  auto payload = std::make_shared<const std::string>("data");
+  ASSERT_EQ(mgr->Broadcast(nullptr), 0);
+  ASSERT_EQ(mgr->Broadcast(std::make_shared<const std::string>()), 0);
+  ASSERT_EQ(mgr->Broadcast(payload), 4);
+  ASSERT_EQ(mgr->Broadcast(1, payload), 2);
+  ASSERT_EQ(mgr->Broadcast(2, payload), 0);
+  // 过滤函数为空时发给所有链接
+  ASSERT_EQ(mgr->Broadcast(payload, nullptr), 4);
+  ASSERT_EQ(mgr->Broadcast(payload, [&servers](const bamboo::net::SocketPtr& so) { return so == servers[0]; }), 1);
+
+  // 已经关闭的链接不再计数
+  uint64_t closedId = servers[3]->GetId();
+  servers[3]->Close();
+  ASSERT_EQ(mgr->GetSocketSize(), 3);
+  // 底层句柄关闭但还没有从管理类移除的链接同样跳过
+  servers[2]->close();
+  ASSERT_EQ(mgr->GetSocketSize(), 3);
+  ASSERT_EQ(mgr->Broadcast(payload), 2);
+  ASSERT_EQ(mgr->Broadcast(0, payload), 1);
+
+  // 不存在、已经关闭的id被忽略，重复的id重复发送
+  ASSERT_EQ(mgr->Multicast({servers[0]->GetId(), closedId, servers[2]->GetId(), 12345, servers[1]->GetId(),
+                            servers[0]->GetId()}, payload), 3);
+  ASSERT_EQ(mgr->Multicast({}, payload), 0);
+  ASSERT_EQ(mgr->Multicast({servers[0]->GetId()}, nullptr), 0);
+
+  while (servers[0]->GetWriteQueueSize() > 0 || servers[1]->GetWriteQueueSize() > 0) io.run_one();
+
+  // 每个链接收到的次数和计数一致
+  const std::size_t times[] = {7, 5};
+  for (std::size_t i = 0; i < 2; ++i) {
+    std::string expect;
+    for (std::size_t n = 0; n < times[i]; ++n) expect += *payload;
+    std::string received(expect.size(), '\0');
+    boost::asio::read(clients[i], boost::asio::buffer(&received[0], received.size()));
+    ASSERT_EQ(received, expect);
+    ASSERT_EQ(clients[i].available(), 0);
+  }
+}
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <gtest/gtest.h>
+
+#include "loopback.hpp"
+
+#include <chrono>
+#include <thread>
+
+#include <bamboo/aio/aio.hpp>
+#include <bamboo/net/simpleacceptor.hpp>
+#include <bamboo/net/simpleconnmanager.hpp>
+#include <bamboo/protocol/echoprotocol.hpp>
+#include <bamboo/server/simpleserver.hpp>
+
+TEST(Drain, CloseAfterFlush) {
+  boost::asio::io_context io;
+  auto sockets = unittest::Loopback(io);
+  auto& client = sockets.first;
+
+  auto mgr = std::make_shared<bamboo::net::SimpleConnManager>();
+  auto so = mgr->OnConnect(std::move(sockets.second));
+
+  // 超过内核发送缓冲区，关闭时一定还有数据在队列里
+  const std::size_t size = 8 * 1024 * 1024;
+  so->WriteData(std::unique_ptr<std::string>(new std::string(size, 'x')));
+  so->CloseAfterFlush();
+  ASSERT_EQ(mgr->GetSocketSize(), 1);
+  so.reset();
+
+  std::size_t received = 0;
+  std::thread reader([&client, &received]() {
+    std::vector<char> data(64 * 1024);
+    boost::system::error_code ec;
+    while (!ec) {
+      received += client.read_some(boost::asio::buffer(data), ec);
+    }
+  });
+  io.run();
+  reader.join();
+
+  ASSERT_EQ(received, size);
+  ASSERT_EQ(mgr->GetSocketSize(), 0);
+}
+
+TEST(Drain, WaitConnections) {
+  bamboo::aio::Topology topology;
+  bamboo::aio::Aio aio(topology);
+  auto server = aio.CreateServer<bamboo::server::SimpleServer>("drain").first;
+  auto acceptor = server->CreateAcceptor<bamboo::net::SimpleAcceptor>("127.0.0.1", 0);
+  ASSERT_TRUE(acceptor != nullptr);
+  const uint16_t port = acceptor->GetLocalEndpoint().port();
+  acceptor->CreateConnManager<bamboo::net::SimpleConnManager>()->CreateProtocol<bamboo::protocol::EchoProtocol>();
+
+  std::thread runner([&aio]() { aio.Start(); });
+
+  boost::asio::io_context io;
+  boost::asio::ip::tcp::endpoint endpoint(boost::asio::ip::make_address("127.0.0.1"), port);
+  boost::asio::ip::tcp::socket client(io);
+  boost::system::error_code ec;
+  for (int i = 0; i < 100; ++i) {
+    client.connect(endpoint, ec);
+    if (!ec) break;
+    client.close();
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  ASSERT_FALSE(ec);
+
+  std::string reply(1, '\0');
+  boost::asio::write(client, boost::asio::buffer(std::string("a")));
+  boost::asio::read(client, boost::asio::buffer(&reply[0], 1));
+  ASSERT_EQ(reply, "a");
+
+  auto begin = std::chrono::steady_clock::now();
+  boost::asio::post(aio.GetMasterIo(), [&aio]() { aio.Drain(std::chrono::seconds(10)); });
+
+  // 排空期间不再接入新链接
+  bool refused = false;
+  for (int i = 0; i < 100 && !refused; ++i) {
+    boost::asio::ip::tcp::socket other(io);
+    other.connect(endpoint, ec);
+    refused = ec == boost::asio::error::connection_refused;
+    if (!refused) std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  ASSERT_TRUE(refused);
+
+  // 已有的链接继续处理，关闭后不用等到超时
+  boost::asio::write(client, boost::asio::buffer(std::string("b")));
+  boost::asio::read(client, boost::asio::buffer(&reply[0], 1));
+  ASSERT_EQ(reply, "b");
+  client.close();
+
+  runner.join();
+  ASSERT_LT(std::chrono::steady_clock::now() - begin, std::chrono::seconds(5));
+}
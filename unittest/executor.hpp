@@ -0,0 +1,88 @@
+#pragma once
+
+#include <gtest/gtest.h>
+
+#include <thread>
+
+#include <bamboo/aio/aio.hpp>
+#include <bamboo/concurrency/executor.hpp>
+#include <bamboo/schedule/scheduler.hpp>
+#include <bamboo/server/simpleserver.hpp>
+
+TEST(Executor, StrandSerialize) {
+  boost::asio::io_context io;
+  auto executor = bamboo::concurrency::Executor::Strand(io);
+  ASSERT_TRUE(executor.HasStrand());
+
+  const int count = 10000;
+  int value = 0;
+  std::atomic<int> inside{0};
+  std::atomic<bool> overlap{false};
+  for (int i = 0; i < count; ++i) {
+    boost::asio::post(executor, [&]() {
+      if (inside.fetch_add(1) != 0) overlap = true;
+      ++value;
+      inside.fetch_sub(1);
+    });
+  }
+
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 4; ++i) {
+    threads.emplace_back([&io]() { io.run(); });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  ASSERT_FALSE(overlap.load());
+  ASSERT_EQ(value, count);
+}
+
+TEST(Executor, Plain) {
+  boost::asio::io_context io;
+  bamboo::concurrency::Executor executor(io);
+  ASSERT_TRUE(static_cast<bool>(executor));
+  ASSERT_FALSE(executor.HasStrand());
+  ASSERT_FALSE(static_cast<bool>(bamboo::concurrency::Executor()));
+
+  int value = 0;
+  boost::asio::post(executor, [&value]() { ++value; });
+  io.run();
+  ASSERT_EQ(value, 1);
+}
+
+TEST(Executor, SchedulerOnStrand) {
+  boost::asio::io_context io;
+  auto executor = bamboo::concurrency::Executor::Strand(io);
+  bool inStrand = false;
+  int fired = 0;
+  for (auto engine : {bamboo::schedule::Scheduler::Engine::TIMER, bamboo::schedule::Scheduler::Engine::WHEEL}) {
+    bamboo::schedule::Scheduler scheduler(io, engine);
+    scheduler.SetExecutor(executor);
+    scheduler.Timeout([&]() {
+      inStrand = executor.running_in_this_thread();
+      ++fired;
+    }, 1);
+    io.restart();
+    io.run();
+    ASSERT_TRUE(inStrand);
+  }
+  ASSERT_EQ(fired, 2);
+}
+
+TEST(Executor, ServerOnWheel) {
+  bamboo::aio::Topology topology;
+  topology.schedulerEngine = bamboo::schedule::Scheduler::Engine::WHEEL;
+  bamboo::aio::Aio aio(topology);
+  auto server = aio.CreateServer<bamboo::server::SimpleServer>("wheel").first;
+  ASSERT_TRUE(server != nullptr);
+  auto& scheduler = server->GetScheduler();
+  ASSERT_EQ(scheduler.GetEngine(), bamboo::schedule::Scheduler::Engine::WHEEL);
+
+  int beats = 0;
+  scheduler.Heartbeat([&]() {
+    if (++beats == 3) aio.Stop();
+  }, 1);
+  aio.Start();
+  ASSERT_EQ(beats, 3);
+}
@@ -0,0 +1,138 @@
+#pragma once
+
+#include <gtest/gtest.h>
+
+#include "loopback.hpp"
+
+#include <bamboo/protocol/httpprotocol.hpp>
+#include <bamboo/net/simpleconnmanager.hpp>
+
+namespace {
+
+/// 服务端使用 http 协议，客户端直接读写原始数据
+struct HttpPair {
+  boost::asio::io_context io;
+  std::shared_ptr<bamboo::net::SimpleConnManager> manager = std::make_shared<bamboo::net::SimpleConnManager>();
+  std::shared_ptr<bamboo::protocol::HttpProtocol> http;
+  bamboo::net::SocketPtr serverSocket;
+  std::pair<boost::asio::ip::tcp::socket, boost::asio::ip::tcp::socket> sockets = unittest::Loopback(io);
+  boost::asio::ip::tcp::socket& client = sockets.first;
+
+  HttpPair() {
+    http = manager->CreateProtocol<bamboo::protocol::HttpProtocol>();
+    serverSocket = manager->OnConnect(std::move(sockets.second));
+  }
+
+  void Write(const std::string& data) {
+    boost::asio::write(client, boost::asio::buffer(data));
+  }
+
+  /// 运行io直到收到包含 until 的数据，或者对端关闭
+  std::string Read(const std::string& until) {
+    std::string received;
+    bool done = false;
+    std::function<void()> read;
+    auto buffer = std::make_shared<std::array<char, 4096>>();
+    read = [&]() {
+      client.async_read_some(boost::asio::buffer(*buffer), [&, buffer](const boost::system::error_code& ec, std::size_t size) {
+        received.append(buffer->data(), size);
+        if (ec || received.find(until) != std::string::npos) {
+          done = true;
+          return;
+        }
+        read();
+      });
+    };
+    read();
+    while (!done) io.run_one();
+    return received;
+  }
+};
+
+}
+
+TEST(Http, Pipeline) {
+  HttpPair pair;
+  pair.http->Handle("/echo", [](bamboo::net::SocketPtr, const bamboo::protocol::HttpRequest& request,
+                               bamboo::protocol::HttpResponsePtr response) {
+    ASSERT_EQ(request.Get("host"), "test");
+    response->Send(request.query.to_string() + ":" + request.body.to_string());
+  });
+
+  // 三个请求一次发送，最后一个分两次到达
+  pair.Write("GET /echo?a=1 HTTP/1.1\r\nHost: test\r\n\r\n"
+             "POST /echo?b=2 HTTP/1.1\r\nHost:test\r\nContent-Length: 5\r\n\r\nhello"
+             "GET /missing HTTP/1.1\r\nHo");
+  std::string received = pair.Read("hello");
+  ASSERT_EQ(received, "HTTP/1.1 200 OK\r\nContent-Length: 4\r\n\r\na=1:"
+                      "HTTP/1.1 200 OK\r\nContent-Length: 9\r\n\r\nb=2:hello");
+
+  pair.Write("st: test\r\n\r\n");
+  ASSERT_EQ(pair.Read("\r\n\r\n"), "HTTP/1.1 404 Not Found\r\nContent-Length: 0\r\n\r\n");
+  ASSERT_TRUE(pair.serverSocket->is_open());
+}
+
+TEST(Http, AsyncOrder) {
+  HttpPair pair;
+  std::vector<bamboo::protocol::HttpResponsePtr> delayed;
+  pair.http->SetDefaultHandler([&delayed](bamboo::net::SocketPtr, const bamboo::protocol::HttpRequest& request,
+                                          bamboo::protocol::HttpResponsePtr response) {
+    if (request.path == "/slow") {
+      delayed.push_back(response);
+    } else if (request.path == "/chunk") {
+      response->AddHeader("X-Test", "1");
+      response->WriteChunk("abc", 3);
+      response->WriteChunk("0123456789abcdef", 16);
+      response->End();
+    } else {
+      response->Send(request.path.to_string());
+    }
+  });
+
+  // 慢请求排在最前面，后面的回复要等它完成后按顺序发送
+  pair.Write("GET /slow HTTP/1.1\r\n\r\nGET /chunk HTTP/1.1\r\n\r\nHEAD /fast HTTP/1.1\r\n\r\n");
+  while (delayed.empty()) pair.io.run_one();
+  pair.io.poll();
+
+  delayed[0]->Send("slow");
+  std::string received = pair.Read("Content-Length: 5\r\n\r\n");
+  ASSERT_EQ(received, "HTTP/1.1 200 OK\r\nContent-Length: 4\r\n\r\nslow"
+                      "HTTP/1.1 200 OK\r\nX-Test: 1\r\nTransfer-Encoding: chunked\r\n\r\n"
+                      "3\r\nabc\r\n10\r\n0123456789abcdef\r\n0\r\n\r\n"
+                      "HTTP/1.1 200 OK\r\nContent-Length: 5\r\n\r\n");
+}
+
+TEST(Http, Close) {
+  HttpPair pair;
+  pair.http->Handle("/", [](bamboo::net::SocketPtr, const bamboo::protocol::HttpRequest& request,
+                           bamboo::protocol::HttpResponsePtr response) {
+    response->Send("ok");
+  });
+
+  // HTTP/1.0 默认回复后关闭，后面的请求不再处理
+  pair.Write("GET / HTTP/1.0\r\n\r\nGET / HTTP/1.0\r\n\r\n");
+  ASSERT_EQ(pair.Read("never"), "HTTP/1.1 200 OK\r\nContent-Length: 2\r\nConnection: close\r\n\r\nok");
+  ASSERT_FALSE(pair.serverSocket->is_open());
+
+  // 格式错误时回复 400 并关闭
+  HttpPair bad;
+  bad.Write("GET /\r\n\r\n");
+  ASSERT_EQ(bad.Read("never"), "HTTP/1.1 400 Bad Request\r\nContent-Length: 0\r\nConnection: close\r\n\r\n");
+
+  // 请求内容超过上限
+  HttpPair large;
+  large.http->SetMaxBody(16);
+  large.Write("POST / HTTP/1.1\r\nContent-Length: 17\r\n\r\n");
+  ASSERT_EQ(large.Read("never"), "HTTP/1.1 413 Payload Too Large\r\nContent-Length: 0\r\nConnection: close\r\n\r\n");
+
+  // 不一致的 Content-Length 无法确定请求边界
+  HttpPair conflict;
+  conflict.Write("POST / HTTP/1.1\r\nContent-Length: 1\r\nContent-Length: 2\r\n\r\nab");
+  ASSERT_EQ(conflict.Read("never"), "HTTP/1.1 400 Bad Request\r\nContent-Length: 0\r\nConnection: close\r\n\r\n");
+
+  // 重复但相同的值可以接受
+  bamboo::protocol::HttpRequest request;
+  std::string same("POST / HTTP/1.1\r\nContent-Length: 2\r\ncontent-length: 2\r\n\r\nab");
+  ASSERT_EQ(bamboo::protocol::HttpProtocol::Parse(same.data(), same.size(), request, 16), same.size());
+  ASSERT_EQ(request.body, "ab");
+}
@@ -0,0 +1,297 @@
+#pragma once
+
+#include <gtest/gtest.h>
+
+#include "loopback.hpp"
+
+#include <bamboo/aio/ioload.hpp>
+#include <bamboo/aio/multiaio.hpp>
+#include <bamboo/aio/topology.hpp>
+#include <bamboo/concurrency/executor.hpp>
+#include <bamboo/net/simpleconnmanager.hpp>
+
+TEST(IoLoad, Score) {
+  boost::asio::io_context io;
+  auto& load = bamboo::aio::IoLoad::Of(io);
+  ASSERT_EQ(&load, &bamboo::aio::IoLoad::Of(io));
+  ASSERT_EQ(load.Score(), 0);
+
+  load.AddServer(1);
+  load.AddConnection(3);
+  ASSERT_EQ(load.Score(), bamboo::aio::IoLoad::SERVER_COST + 3 * bamboo::aio::IoLoad::CONNECTION_COST);
+}
+
+TEST(IoLoad, MoveSocket) {
+  boost::asio::io_context first, second;
+  auto sockets = unittest::Loopback(first);
+  auto& client = sockets.first;
+
+  // 第一个管理类不处理数据，数据留在读缓冲区里
+  std::string seen;
+  auto from = std::make_shared<bamboo::net::SimpleConnManager>();
+  from->SetReadHandler([&](bamboo::net::SocketPtr so, const char* data, std::size_t size) -> std::size_t {
+    seen.assign(data, size);
+    first.stop();
+    return 0;
+  });
+  auto so = from->OnConnect(std::move(sockets.second));
+  ASSERT_EQ(bamboo::aio::IoLoad::Of(first).Connections(), 1);
+
+  boost::asio::write(client, boost::asio::buffer(std::string("hello")));
+  first.run();
+  ASSERT_EQ(seen, "hello");
+
+  std::string unread;
+  int fd = -1;
+  ASSERT_TRUE(so->Release([&](bamboo::net::SocketIf::native_handle_type released, std::string& rest) {
+    fd = released;
+    unread = rest;
+  }));
+  ASSERT_GE(fd, 0);
+  ASSERT_EQ(unread, "hello");
+  ASSERT_EQ(from->GetSocketSize(), 0);
+  ASSERT_FALSE(so->Release([](bamboo::net::SocketIf::native_handle_type, std::string&) {}));
+  so.reset();
+  // 被取消的读操作执行完后才释放原来的链接
+  first.restart();
+  first.poll();
+  ASSERT_EQ(bamboo::aio::IoLoad::Of(first).Connections(), 0);
+
+  std::string received;
+  auto to = std::make_shared<bamboo::net::SimpleConnManager>();
+  to->SetReadHandler([&](bamboo::net::SocketPtr so, const char* data, std::size_t size) -> std::size_t {
+    received.append(data, size);
+    if (received.size() >= 10) second.stop();
+    return size;
+  });
+  boost::asio::ip::tcp::socket moved(second);
+  moved.assign(boost::asio::ip::tcp::v4(), fd);
+  auto adopted = to->Adopt(std::move(moved), unread);
+  ASSERT_TRUE(adopted != nullptr);
+  ASSERT_EQ(received, "hello");
+  ASSERT_EQ(bamboo::aio::IoLoad::Of(second).Connections(), 1);
+
+  boost::asio::write(client, boost::asio::buffer(std::string("world")));
+  second.run();
+  ASSERT_EQ(received, "helloworld");
+}
+
+TEST(IoLoad, AioMoveSocket) {
+  bamboo::aio::Topology topology;
+  topology.ioSize = 2;
+  bamboo::aio::MultiAio aio(topology);
+  auto& from = aio.GetIo(0);
+  auto& to = aio.GetIo(1);
+  // 不启动线程，手动运行两个io
+  auto runUntil = [&](const std::function<bool()>& done) {
+    for (int i = 0; i < 1000 && !done(); ++i) {
+      from.poll();
+      to.run_one_for(std::chrono::milliseconds(1));
+    }
+  };
+
+  auto source = std::make_shared<bamboo::net::SimpleConnManager>();
+  source->SetReadHandler([](bamboo::net::SocketPtr, const char*, std::size_t) -> std::size_t { return 0; });
+  std::string received;
+  auto target = std::make_shared<bamboo::net::SimpleConnManager>();
+  target->SetReadHandler([&received](bamboo::net::SocketPtr, const char* data, std::size_t size) -> std::size_t {
+    received.append(data, size);
+    return size;
+  });
+  ASSERT_FALSE(aio.MoveSocket(nullptr, 1, target));
+
+  // 经过邮箱迁移，保留分组和未处理的数据
+  auto first = unittest::Loopback(from);
+  auto so = source->OnConnect(std::move(first.second));
+  so->SetGroup(7);
+  boost::asio::write(first.first, boost::asio::buffer(std::string("hello")));
+  runUntil([&]() { return so->available() == 0; });
+
+  bool moved = false;
+  bamboo::net::SocketPtr adopted;
+  ASSERT_FALSE(aio.MoveSocket(so, 2, target));
+  ASSERT_TRUE(aio.MoveSocket(so, 1, target, [&](bamboo::net::SocketPtr so) {
+    moved = true;
+    adopted = so;
+  }));
+  runUntil([&]() { return moved; });
+  ASSERT_TRUE(adopted != nullptr);
+  ASSERT_EQ(adopted->GetGroup(), 7);
+  ASSERT_EQ(&adopted->get_executor().context(), &to);
+  runUntil([&]() { return received == "hello"; });
+  ASSERT_EQ(received, "hello");
+  ASSERT_EQ(source->GetSocketSize(), 0);
+  ASSERT_EQ(target->GetSocketSize(), 1);
+
+  // 邮箱满时直接投递到目标io
+  auto second = unittest::Loopback(from);
+  so = source->OnConnect(std::move(second.second));
+  std::size_t queued = 0;
+  while (aio.Post(1, []() {})) ++queued;
+  ASSERT_GT(queued, 0);
+  moved = false;
+  adopted.reset();
+  ASSERT_TRUE(aio.MoveSocket(so, 1, target, [&](bamboo::net::SocketPtr so) {
+    moved = true;
+    adopted = so;
+  }));
+  runUntil([&]() { return moved; });
+  ASSERT_TRUE(adopted != nullptr);
+  ASSERT_EQ(target->GetSocketSize(), 2);
+
+  // 目标io上重新创建socket失败时回调参数为空
+  auto third = unittest::Loopback(from);
+  so = source->OnConnect(std::move(third.second));
+  auto fd = so->native_handle();
+  moved = false;
+  adopted = so;
+  ASSERT_TRUE(aio.MoveSocket(so, 1, target, [&](bamboo::net::SocketPtr so) {
+    moved = true;
+    adopted = so;
+  }));
+  ::close(fd);
+  runUntil([&]() { return moved; });
+  ASSERT_TRUE(moved);
+  ASSERT_TRUE(adopted == nullptr);
+  ASSERT_EQ(target->GetSocketSize(), 2);
+}
+
+TEST(IoLoad, MoveInReadHandler) {
+  bamboo::aio::Topology topology;
+  topology.ioSize = 2;
+  bamboo::aio::MultiAio aio(topology);
+  auto& from = aio.GetIo(0);
+  auto& to = aio.GetIo(1);
+  auto runUntil = [&](const std::function<bool()>& done) {
+    for (int i = 0; i < 1000 && !done(); ++i) {
+      from.poll();
+      to.run_one_for(std::chrono::milliseconds(1));
+    }
+  };
+
+  std::string received;
+  auto target = std::make_shared<bamboo::net::SimpleConnManager>();
+  target->SetReadHandler([&received](bamboo::net::SocketPtr, const char* data, std::size_t size) -> std::size_t {
+    received.append(data, size);
+    return size;
+  });
+
+  // 每个请求4字节，处理完第一个请求后在读处理函数里迁移，剩下的请求交给目标io
+  std::string seen;
+  bool reply = false;
+  bool moved = false;
+  bamboo::net::SocketPtr adopted;
+  std::size_t calls = 0;
+  auto source = std::make_shared<bamboo::net::SimpleConnManager>();
+  source->SetReadHandler([&](bamboo::net::SocketPtr so, const char* data, std::size_t size) -> std::size_t {
+    ++calls;
+    if (size < 4) return 0;
+    seen.append(data, 4);
+    EXPECT_TRUE(aio.MoveSocket(so, 1, target, [&](bamboo::net::SocketPtr so) {
+      moved = true;
+      adopted = so;
+    }));
+    if (reply) so->WriteData("ok", 2);
+    return 4;
+  });
+
+  // 空闲的链接，数据在线程共享的临时内存里
+  auto idle = unittest::Loopback(from);
+  source->OnConnect(std::move(idle.second));
+  boost::asio::write(idle.first, boost::asio::buffer(std::string("req1req2")));
+  runUntil([&]() { return moved && received == "req2"; });
+  ASSERT_EQ(seen, "req1");
+  ASSERT_TRUE(adopted != nullptr);
+  ASSERT_EQ(received, "req2");
+  ASSERT_EQ(source->GetSocketSize(), 0);
+  boost::asio::write(idle.first, boost::asio::buffer(std::string("req3")));
+  runUntil([&]() { return received == "req2req3"; });
+  ASSERT_EQ(received, "req2req3");
+
+  // 不完整的请求先留在私有的读缓冲区里
+  seen.clear();
+  received.clear();
+  moved = false;
+  auto buffered = unittest::Loopback(from);
+  source->OnConnect(std::move(buffered.second));
+  boost::asio::write(buffered.first, boost::asio::buffer(std::string("re")));
+  calls = 0;
+  runUntil([&]() { return calls > 0; });
+  ASSERT_EQ(calls, 1);
+  boost::asio::write(buffered.first, boost::asio::buffer(std::string("q1req2")));
+  runUntil([&]() { return moved && received == "req2"; });
+  ASSERT_EQ(seen, "req1");
+  ASSERT_EQ(received, "req2");
+  ASSERT_EQ(target->GetSocketSize(), 2);
+
+  // 处理函数返回前又发送了数据，迁移失败，链接留在原来的io上继续工作
+  seen.clear();
+  moved = false;
+  reply = true;
+  auto busy = unittest::Loopback(from);
+  source->OnConnect(std::move(busy.second));
+  boost::asio::write(busy.first, boost::asio::buffer(std::string("req1")));
+  runUntil([&]() { return moved; });
+  ASSERT_TRUE(moved);
+  ASSERT_TRUE(adopted == nullptr);
+  ASSERT_EQ(seen, "req1");
+  ASSERT_EQ(source->GetSocketSize(), 1);
+  std::string ok(2, '\0');
+  boost::asio::read(busy.first, boost::asio::buffer(&ok[0], ok.size()));
+  ASSERT_EQ(ok, "ok");
+}
+
+TEST(IoLoad, HandlerStats) {
+  boost::asio::io_context io;
+  auto& load = bamboo::aio::IoLoad::Of(io);
+  load.SetSlowThreshold(1000);
+
+  bamboo::concurrency::Executor executor(io);
+  boost::asio::post(executor, []() {});
+  boost::asio::post(executor, []() { std::this_thread::sleep_for(std::chrono::milliseconds(2)); });
+  ASSERT_EQ(load.GetStats().queued, 2);
+  io.run();
+
+  auto stats = load.GetStats();
+  ASSERT_EQ(stats.handlers, 2);
+  ASSERT_EQ(stats.queued, 0);
+  ASSERT_GE(stats.handlerTime, 2000000);
+  uint64_t total = 0;
+  for (auto count : stats.histogram) total += count;
+  ASSERT_EQ(total, 2);
+
+  // 只有睡眠的回调超过阈值，名字里带有定义它的函数
+  ASSERT_EQ(stats.slow.size(), 1);
+  ASSERT_EQ(stats.slow[0].count, 1);
+  ASSERT_NE(stats.slow[0].site.find("HandlerStats"), std::string::npos);
+
+  load.ResetStats();
+  ASSERT_EQ(load.GetStats().handlers, 0);
+  ASSERT_TRUE(load.GetStats().slow.empty());
+}
+
+TEST(IoLoad, BusyPollRun) {
+  boost::asio::io_context io;
+  bamboo::aio::Topology topology;
+  topology.pollBudget = {0, 200};
+
+  // 忙轮询时回调照常执行，io停止后返回
+  int count = 0;
+  boost::asio::steady_timer timer(io, std::chrono::milliseconds(5));
+  timer.async_wait([&](const boost::system::error_code&) {
+    ++count;
+    boost::asio::post(io, [&]() {
+      ++count;
+      io.stop();
+    });
+  });
+  topology.Run(io, 1);
+  ASSERT_EQ(count, 2);
+  ASSERT_TRUE(io.stopped());
+
+  // 没有配置的io阻塞运行
+  io.restart();
+  boost::asio::post(io, [&]() { ++count; });
+  topology.Run(io, 5);
+  ASSERT_EQ(count, 3);
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <utility>
+
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/tcp.hpp>
+
+namespace unittest {
+
+/**
+ * 在本地回环上建立一对互相连接的socket
+ * @param clientIo 主动连接的一端所在的io
+ * @param serverIo 接受的一端所在的io
+ * @return first 为主动连接的一端，second 为接受的一端
+ */
+inline std::pair<boost::asio::ip::tcp::socket, boost::asio::ip::tcp::socket> Loopback(
+    boost::asio::io_context& clientIo, boost::asio::io_context& serverIo) {
+  boost::asio::ip::tcp::acceptor acceptor(serverIo, {boost::asio::ip::make_address("127.0.0.1"), 0});
+  boost::asio::ip::tcp::socket client(clientIo);
+  client.connect(acceptor.local_endpoint());
+  boost::asio::ip::tcp::socket accepted(serverIo);
+  acceptor.accept(accepted);
+  return std::make_pair(std::move(client), std::move(accepted));
+}
+
+/// 两端在同一个io上
+inline std::pair<boost::asio::ip::tcp::socket, boost::asio::ip::tcp::socket> Loopback(boost::asio::io_context& io) {
+  return Loopback(io, io);
+}
+
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <gtest/gtest.h>
+
+#include <thread>
+
+#include <bamboo/aio/mailbox.hpp>
+
+TEST(Mailbox, CrossIo) {
+  boost::asio::io_context first, second;
+  std::vector<boost::asio::io_context*> ios{&first, &second};
+  {
+    bamboo::aio::Mailbox mailbox(ios, 16);
+    std::thread::id secondThread;
+    std::vector<int> received;
+
+    // 非io线程发送
+    ASSERT_TRUE(mailbox.Post(0, [&]() {
+      ASSERT_EQ(mailbox.Current(), 0);
+      for (int i = 0; i < 10; ++i) {
+        ASSERT_TRUE(mailbox.Post(1, [&, i]() {
+          ASSERT_EQ(std::this_thread::get_id(), secondThread);
+          received.push_back(i);
+          if (i == 9) second.stop();
+        }));
+      }
+    }));
+    ASSERT_FALSE(mailbox.Post(2, []() {}));
+
+    std::thread thread([&]() {
+      mailbox.Bind(1);
+      secondThread = std::this_thread::get_id();
+      second.run();
+    });
+    mailbox.Bind(0);
+    first.run_one();
+    thread.join();
+
+    ASSERT_EQ(received, std::vector<int>({0, 1, 2, 3, 4, 5, 6, 7, 8, 9}));
+  }
+}
+
+TEST(Mailbox, Full) {
+  boost::asio::io_context io;
+  std::vector<boost::asio::io_context*> ios{&io};
+  bamboo::aio::Mailbox mailbox(ios, 4);
+  int count = 0;
+  for (int i = 0; i < 4; ++i) {
+    ASSERT_TRUE(mailbox.Post(0, [&count]() { ++count; }));
+  }
+  ASSERT_FALSE(mailbox.Post(0, [&count]() { ++count; }));
+  io.run_one();
+  ASSERT_EQ(count, 4);
+}
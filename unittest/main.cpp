@@ -1,6 +1,25 @@
 #include <gtest/gtest.h>
 
 #include "buffer.hpp"
+#include "acceptor.hpp"
+#include "socket.hpp"
+#include "connmanager.hpp"
+#include "connector.hpp"
+#include "slotmap.hpp"
+#include "timingwheel.hpp"
+#include "asyncrun.hpp"
+#include "taskpool.hpp"
+#include "channel.hpp"
+#include "mailbox.hpp"
+#include "affinity.hpp"
+#include "executor.hpp"
+#include "ioload.hpp"
+#include "drain.hpp"
+#include "protocol.hpp"
+#include "rpc.hpp"
+#include "message.hpp"
+#include "http.hpp"
+#include "websocket.hpp"
 
 int main(int argc, char* argv[]) {
   testing::InitGoogleTest(&argc, argv);
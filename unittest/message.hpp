@@ -0,0 +1,81 @@
+#pragma once
+
+#include <gtest/gtest.h>
+
+#include "loopback.hpp"
+
+#include <cstring>
+
+#include <bamboo/buffer/slabpool.hpp>
+#include <bamboo/net/simpleconnmanager.hpp>
+#include <bamboo/protocol/messageif.hpp>
+#include <bamboo/utility/ringqueue.hpp>
+
+namespace {
+
+class TextMessage : public bamboo::protocol::MessageIf {
+ public:
+  explicit TextMessage(std::string text) : text_(std::move(text)) {}
+  std::size_t EncodedSize() const override { return text_.size(); }
+  void SerializeTo(char* out) const override { std::memcpy(out, text_.data(), text_.size()); }
+
+ private:
+  std::string text_;
+};
+
+}
+
+TEST(Message, RingQueue) {
+  bamboo::utility::RingQueue<std::unique_ptr<int>> queue;
+  for (int round = 0; round < 3; ++round) {
+    for (int i = 0; i < 40; ++i) queue.push_back(std::unique_ptr<int>(new int(i)));
+    ASSERT_EQ(queue.size(), 40);
+    ASSERT_EQ(*queue[39], 39);
+    for (int i = 0; i < 30; ++i) {
+      ASSERT_EQ(*queue.front(), i);
+      queue.pop_front();
+    }
+    ASSERT_EQ(*queue.back(), 39);
+    queue.clear();
+    ASSERT_TRUE(queue.empty());
+  }
+}
+
+TEST(Message, SlabPool) {
+  bamboo::buffer::SlabPool pool;
+  std::shared_ptr<const void> first, second;
+  char* a = pool.Reserve(10, first);
+  char* b = pool.Reserve(10, second);
+  ASSERT_EQ(first, second);
+  ASSERT_EQ(b - a, 16);
+  ASSERT_EQ(pool.Reserve(bamboo::buffer::SlabPool::MAX_MESSAGE + 1, second), nullptr);
+
+  // 写满后换一块新的，旧的内存板释放后重新使用
+  std::shared_ptr<const void> holder;
+  for (std::size_t i = 0; i < bamboo::buffer::SlabPool::SLAB_SIZE / 1024; ++i) pool.Reserve(1024, holder);
+  ASSERT_NE(holder, first);
+  ASSERT_EQ(pool.SlabCount(), 2);
+  first.reset();
+  second.reset();
+  holder.reset();
+  for (std::size_t i = 0; i < bamboo::buffer::SlabPool::SLAB_SIZE / 1024 * 4; ++i) pool.Reserve(1024, holder);
+  ASSERT_EQ(pool.SlabCount(), 2);
+}
+
+TEST(Message, SerializeTo) {
+  boost::asio::io_context io;
+  auto sockets = unittest::Loopback(io);
+  auto& client = sockets.first;
+  auto mgr = std::make_shared<bamboo::net::SimpleConnManager>();
+  auto so = mgr->OnConnect(std::move(sockets.second));
+
+  TextMessage hello("hello "), world("world");
+  ASSERT_EQ(*hello.Build(), "hello ");
+  so->WriteData(&hello);
+  so->WriteData(&world);
+  while (so->GetWriteQueueSize() > 0) io.run_one();
+
+  std::string reply(11, '\0');
+  boost::asio::read(client, boost::asio::buffer(&reply[0], reply.size()));
+  ASSERT_EQ(reply, "hello world");
+}
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <gtest/gtest.h>
+
+#include "loopback.hpp"
+
+#include <bamboo/protocol/lengthfieldprotocol.hpp>
+#include <bamboo/net/simpleconnmanager.hpp>
+
+namespace {
+
+/// 收集收到的帧，记录每次回调的帧数
+struct FrameCollector {
+  std::vector<std::string> frames;
+  std::vector<std::size_t> batches;
+
+  bamboo::protocol::LengthFieldProtocol::FrameHandler Handler() {
+    return [this](bamboo::net::SocketPtr, const std::vector<bamboo::protocol::LengthFieldProtocol::Frame>& list) {
+      batches.push_back(list.size());
+      for (auto& frame : list) frames.emplace_back(frame.data, frame.size);
+    };
+  }
+};
+
+}
+
+TEST(LengthFieldProtocol, FixedBatch) {
+  bamboo::protocol::LengthFieldProtocol protocol;
+  FrameCollector collector;
+  protocol.SetFrameHandler(collector.Handler());
+
+  std::string data = *protocol.Encode("hello", 5) + *protocol.Encode("", 0) + *protocol.Encode("world!", 6);
+  ASSERT_EQ(data.substr(0, 4), std::string("\0\0\0\5", 4));
+
+  // 最后一帧只到一半，留给下次处理
+  std::string partial = *protocol.Encode("tail", 4);
+  data += partial.substr(0, 6);
+
+  ASSERT_EQ(protocol.ReceiveData(nullptr, data.data(), data.size()), data.size() - 6);
+  ASSERT_EQ(collector.batches, std::vector<std::size_t>({3}));
+  ASSERT_EQ(collector.frames, std::vector<std::string>({"hello", "", "world!"}));
+
+  // 帧直接指向输入的数据
+  protocol.SetFrameHandler([&data](bamboo::net::SocketPtr,
+                                   const std::vector<bamboo::protocol::LengthFieldProtocol::Frame>& list) {
+    ASSERT_EQ(list.size(), 1);
+    ASSERT_EQ(list[0].data, data.data() + 4);
+  });
+  data = partial;
+  ASSERT_EQ(protocol.ReceiveData(nullptr, data.data(), data.size()), data.size());
+}
+
+TEST(LengthFieldProtocol, Options) {
+  bamboo::protocol::LengthFieldProtocol::Option option;
+  option.fieldSize = 2;
+  option.order = bamboo::protocol::LengthFieldProtocol::ByteOrder::LITTLE;
+  option.includeHeader = true;
+  bamboo::protocol::LengthFieldProtocol little(option);
+  ASSERT_EQ(*little.Encode("abc", 3), std::string("\5\0abc", 5));
+
+  FrameCollector collector;
+  little.SetFrameHandler(collector.Handler());
+  std::string data("\5\0abc", 5);
+  ASSERT_EQ(little.ReceiveData(nullptr, data.data(), data.size()), 5);
+  ASSERT_EQ(collector.frames, std::vector<std::string>({"abc"}));
+}
+
+TEST(LengthFieldProtocol, Varint) {
+  bamboo::protocol::LengthFieldProtocol::Option option;
+  option.type = bamboo::protocol::LengthFieldProtocol::LengthType::VARINT;
+  bamboo::protocol::LengthFieldProtocol protocol(option);
+
+  std::string big(300, 'x');
+  auto encoded = protocol.Encode(big.data(), big.size());
+  ASSERT_EQ(encoded->substr(0, 2), std::string("\xac\x02", 2));
+
+  FrameCollector collector;
+  protocol.SetFrameHandler(collector.Handler());
+  // 长度头不完整时不消耗数据
+  ASSERT_EQ(protocol.ReceiveData(nullptr, encoded->data(), 1), 0);
+  ASSERT_EQ(protocol.ReceiveData(nullptr, encoded->data(), encoded->size()), encoded->size());
+  ASSERT_EQ(collector.frames, std::vector<std::string>({big}));
+
+  // 包含长度头时，长度头自身的字节数也算进长度
+  option.includeHeader = true;
+  bamboo::protocol::LengthFieldProtocol include(option);
+  std::string edge(127, 'y');
+  auto withHeader = include.Encode(edge.data(), edge.size());
+  ASSERT_EQ(withHeader->size(), 129);
+  ASSERT_EQ(withHeader->substr(0, 2), std::string("\x81\x01", 2));
+  include.SetFrameHandler(collector.Handler());
+  ASSERT_EQ(include.ReceiveData(nullptr, withHeader->data(), withHeader->size()), withHeader->size());
+  ASSERT_EQ(collector.frames.back(), edge);
+}
+
+TEST(LengthFieldProtocol, TooLarge) {
+  boost::asio::io_context io;
+  auto sockets = unittest::Loopback(io);
+  auto& client = sockets.first;
+  auto mgr = std::make_shared<bamboo::net::SimpleConnManager>();
+  auto so = mgr->OnConnect(std::move(sockets.second));
+
+  bamboo::protocol::LengthFieldProtocol::Option option;
+  option.maxFrame = 16;
+  bamboo::protocol::LengthFieldProtocol protocol(option);
+  FrameCollector collector;
+  protocol.SetFrameHandler(collector.Handler());
+
+  std::string data = *protocol.Encode("ok", 2) + std::string("\0\0\0\21", 4);
+  ASSERT_EQ(protocol.ReceiveData(so, data.data(), data.size()), data.size());
+  ASSERT_TRUE(collector.frames.empty());
+  ASSERT_EQ(mgr->GetSocketSize(), 0);
+}
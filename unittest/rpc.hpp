@@ -0,0 +1,122 @@
+#pragma once
+
+#include <gtest/gtest.h>
+
+#include "loopback.hpp"
+
+#include <bamboo/protocol/rpcprotocol.hpp>
+#include <bamboo/net/simpleconnmanager.hpp>
+
+namespace {
+
+/// 一对互相连接的链接，两端各有一个 rpc 协议
+struct RpcPair {
+  boost::asio::io_context io;
+  bamboo::schedule::Scheduler scheduler{io};
+  std::shared_ptr<bamboo::net::SimpleConnManager> serverMgr = std::make_shared<bamboo::net::SimpleConnManager>();
+  std::shared_ptr<bamboo::net::SimpleConnManager> clientMgr = std::make_shared<bamboo::net::SimpleConnManager>();
+  std::shared_ptr<bamboo::protocol::RpcProtocol> server;
+  std::shared_ptr<bamboo::protocol::RpcProtocol> client;
+  bamboo::net::SocketPtr serverSocket;
+  bamboo::net::SocketPtr clientSocket;
+
+  RpcPair() {
+    server = serverMgr->CreateProtocol<bamboo::protocol::RpcProtocol>(scheduler);
+    client = clientMgr->CreateProtocol<bamboo::protocol::RpcProtocol>(scheduler);
+
+    auto sockets = unittest::Loopback(io);
+    serverSocket = serverMgr->OnConnect(std::move(sockets.second));
+    clientSocket = clientMgr->OnConnect(std::move(sockets.first));
+  }
+};
+
+}
+
+TEST(Rpc, Pipeline) {
+  RpcPair pair;
+  using Status = bamboo::protocol::RpcProtocol::Status;
+
+  // 第一个请求延迟回复，后面的请求先返回
+  bamboo::protocol::RpcProtocol::Reply delayed;
+  pair.server->Register("echo", [&delayed](bamboo::net::SocketPtr, const bamboo::protocol::RpcProtocol::Request& request,
+                                           bamboo::protocol::RpcProtocol::Reply reply) {
+    if (std::string(request.data, request.size) == "slow") {
+      delayed = reply;
+      return;
+    }
+    reply(Status::OK, request.data, request.size);
+  });
+
+  std::vector<std::string> results;
+  auto collect = [&results](Status status, const char* data, std::size_t size) {
+    results.push_back(std::to_string(static_cast<int>(status)) + ":" + std::string(data, size));
+  };
+  ASSERT_TRUE(pair.client->Call(pair.clientSocket, "echo", "slow", 4, collect));
+  for (int i = 0; i < 10; ++i) {
+    std::string data = std::to_string(i);
+    ASSERT_TRUE(pair.client->Call(pair.clientSocket, "echo", data.data(), data.size(), collect));
+  }
+  ASSERT_TRUE(pair.client->Call(pair.clientSocket, "missing", "", 0, collect));
+  ASSERT_EQ(pair.client->GetPendingSize(), 12);
+
+  while (results.size() < 11) pair.io.run_one();
+  ASSERT_EQ(results.front(), "0:0");
+  ASSERT_EQ(results[9], "0:9");
+  ASSERT_EQ(results[10], "1:");
+
+  delayed(Status::OK, "done", 4);
+  // 只有第一次回复有效
+  delayed(Status::FAILED, "again", 5);
+  while (results.size() < 12) pair.io.run_one();
+  ASSERT_EQ(results.back(), "0:done");
+  ASSERT_EQ(pair.client->GetPendingSize(), 0);
+}
+
+TEST(Rpc, TimeoutAndClose) {
+  RpcPair pair;
+  using Status = bamboo::protocol::RpcProtocol::Status;
+
+  std::vector<bamboo::protocol::RpcProtocol::Reply> replies;
+  pair.server->Register("hold", [&replies](bamboo::net::SocketPtr, const bamboo::protocol::RpcProtocol::Request& request,
+                                           bamboo::protocol::RpcProtocol::Reply reply) {
+    replies.push_back(reply);
+  });
+
+  std::vector<Status> results;
+  auto collect = [&results](Status status, const char*, std::size_t) { results.push_back(status); };
+  ASSERT_TRUE(pair.client->Call(pair.clientSocket, "hold", "", 0, collect, 20));
+  ASSERT_TRUE(pair.client->Call(pair.clientSocket, "hold", "", 0, collect));
+
+  while (results.empty()) pair.io.run_one();
+  ASSERT_EQ(results, std::vector<Status>({Status::TIMEOUT}));
+  ASSERT_EQ(replies.size(), 2);
+  // 超时后的回复不会再回调
+  replies[0](Status::OK, "late", 4);
+
+  pair.clientSocket->Close();
+  ASSERT_EQ(results, std::vector<Status>({Status::TIMEOUT, Status::CLOSED}));
+  ASSERT_EQ(pair.client->GetPendingSize(), 0);
+  ASSERT_FALSE(pair.client->Call(pair.clientSocket, "hold", "", 0, collect));
+}
+
+TEST(Rpc, ResponseFromOtherSocket) {
+  RpcPair pair;
+  using Status = bamboo::protocol::RpcProtocol::Status;
+
+  auto sockets = unittest::Loopback(pair.io);
+  auto other = pair.clientMgr->OnConnect(std::move(sockets.first));
+
+  std::vector<Status> results;
+  auto collect = [&results](Status status, const char*, std::size_t) { results.push_back(status); };
+  ASSERT_TRUE(pair.client->Call(pair.clientSocket, "hold", "", 0, collect));
+
+  // 伪造编号为 1 的回复
+  std::string response("\0\0\0\12\2\0\0\0\0\0\0\0\1\0", 14);
+  ASSERT_EQ(pair.client->ReceiveData(other, response.data(), response.size()), response.size());
+  ASSERT_TRUE(results.empty());
+  ASSERT_EQ(pair.client->GetPendingSize(), 1);
+
+  ASSERT_EQ(pair.client->ReceiveData(pair.clientSocket, response.data(), response.size()), response.size());
+  ASSERT_EQ(results, std::vector<Status>({Status::OK}));
+  ASSERT_EQ(pair.client->GetPendingSize(), 0);
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <gtest/gtest.h>
+
+#include <bamboo/utility/slotmap.hpp>
+
+TEST(SlotMap, InsertFind) {
+  bamboo::utility::SlotMap<int> map;
+  auto a = map.Insert(1);
+  auto b = map.Insert(2);
+  ASSERT_NE(a, 0);
+  ASSERT_NE(a, b);
+  ASSERT_EQ(map.Size(), 2);
+  ASSERT_EQ(*map.Find(a), 1);
+  ASSERT_EQ(*map.Find(b), 2);
+  ASSERT_EQ(map.Find(0), nullptr);
+}
+
+TEST(SlotMap, StaleId) {
+  bamboo::utility::SlotMap<int> map;
+  auto a = map.Insert(1);
+  ASSERT_TRUE(map.Erase(a));
+  ASSERT_FALSE(map.Erase(a));
+  ASSERT_EQ(map.Find(a), nullptr);
+
+  auto b = map.Insert(2);
+  ASSERT_NE(a, b);
+  ASSERT_EQ(static_cast<uint32_t>(a), static_cast<uint32_t>(b));
+  ASSERT_EQ(map.Find(a), nullptr);
+  ASSERT_EQ(*map.Find(b), 2);
+}
+
+TEST(SlotMap, DenseErase) {
+  bamboo::utility::SlotMap<int> map;
+  auto a = map.Insert(1);
+  auto b = map.Insert(2);
+  auto c = map.Insert(3);
+  map.Erase(a);
+  ASSERT_EQ(map.Size(), 2);
+  ASSERT_EQ(*map.Find(b), 2);
+  ASSERT_EQ(*map.Find(c), 3);
+
+  int sum = 0;
+  for (auto v : map) sum += v;
+  ASSERT_EQ(sum, 5);
+}
@@ -0,0 +1,148 @@
+#pragma once
+
+#include <gtest/gtest.h>
+
+#include "loopback.hpp"
+
+#include <set>
+#include <thread>
+
+#include <bamboo/net/simpleconnmanager.hpp>
+
+namespace {
+
+/// 第 index 块数据的内容，每块都不一样，错位或者重复都能发现
+std::string WriteItem(std::size_t index, std::size_t size) {
+  std::string item(size, '\0');
+  for (std::size_t i = 0; i < size; ++i) item[i] = static_cast<char>((index * 31 + i) % 251);
+  return item;
+}
+
+}
+
+TEST(Socket, GatherBatch) {
+  boost::asio::io_context io;
+  auto sockets = unittest::Loopback(io);
+  auto& client = sockets.first;
+  auto mgr = std::make_shared<bamboo::net::SimpleConnManager>();
+  auto so = mgr->OnConnect(std::move(sockets.second));
+
+  // 第一块立即开始发送，之后的每次 writev 最多合并 64 块
+  const std::size_t count = 200;
+  std::string expect;
+  for (std::size_t i = 0; i < count; ++i) {
+    auto item = WriteItem(i, 4);
+    so->WriteData(item.data(), item.size());
+    expect += item;
+  }
+  ASSERT_EQ(so->GetWriteQueueSize(), count * 4);
+
+  // 记录每次写完成后的剩余字节数
+  std::vector<std::size_t> queued;
+  while (so->GetWriteQueueSize() > 0) {
+    io.run_one();
+    if (queued.empty() || queued.back() != so->GetWriteQueueSize()) queued.push_back(so->GetWriteQueueSize());
+  }
+  ASSERT_EQ(queued, std::vector<std::size_t>({796, 540, 284, 28, 0}));
+
+  std::string received(expect.size(), '\0');
+  boost::asio::read(client, boost::asio::buffer(&received[0], received.size()));
+  ASSERT_EQ(received, expect);
+}
+
+TEST(Socket, GatherPartial) {
+  boost::asio::io_context io;
+  auto sockets = unittest::Loopback(io);
+  auto& client = sockets.first;
+  // 缓冲区很小，每次 writev 只能写出一部分，经常停在某一块的中间
+  sockets.second.set_option(boost::asio::socket_base::send_buffer_size(16 * 1024));
+  auto mgr = std::make_shared<bamboo::net::SimpleConnManager>();
+  auto so = mgr->OnConnect(std::move(sockets.second));
+
+  std::string expect;
+  std::vector<std::size_t> sizes;
+  for (std::size_t i = 0; i < 100; ++i) {
+    auto item = WriteItem(i, 10000 + i * 37);
+    so->WriteData(item.data(), item.size());
+    expect += item;
+    sizes.push_back(item.size());
+  }
+  // 剩余字节数正好落在块边界上的所有取值
+  std::set<std::size_t> boundaries;
+  std::size_t left = expect.size();
+  for (auto size : sizes) {
+    boundaries.insert(left);
+    left -= size;
+  }
+
+  std::string received;
+  std::thread reader([&client, &received, &expect]() {
+    std::vector<char> data(4096);
+    boost::system::error_code ec;
+    while (!ec && received.size() < expect.size()) {
+      std::size_t rd = client.read_some(boost::asio::buffer(data), ec);
+      received.append(data.data(), rd);
+    }
+  });
+  std::size_t middle = 0;
+  while (so->GetWriteQueueSize() > 0) {
+    io.run_one();
+    if (so->GetWriteQueueSize() > 0 && boundaries.count(so->GetWriteQueueSize()) == 0) ++middle;
+  }
+  reader.join();
+
+  ASSERT_GT(middle, 0);
+  ASSERT_EQ(received.size(), expect.size());
+  ASSERT_TRUE(received == expect);
+}
+
+TEST(Socket, WatermarkPauseRead) {
+  boost::asio::io_context io;
+  auto sockets = unittest::Loopback(io);
+  auto& client = sockets.first;
+  auto mgr = std::make_shared<bamboo::net::SimpleConnManager>();
+  std::string received;
+  mgr->SetReadHandler([&received](bamboo::net::SocketPtr, const char* data, std::size_t size) -> std::size_t {
+    received.append(data, size);
+    return size;
+  });
+  auto so = mgr->OnConnect(std::move(sockets.second));
+
+  std::vector<bool> transitions;
+  so->SetWriteWatermark(1024 * 1024, 64 * 1024, true);
+  so->SetWatermarkHandler([&transitions](bool high) { transitions.push_back(high); });
+
+  // 对端不读，发送队列超过高水位
+  const std::size_t size = 8 * 1024 * 1024;
+  so->WriteData(std::unique_ptr<std::string>(new std::string(size, 'x')));
+  ASSERT_EQ(transitions, std::vector<bool>({true}));
+  io.run_for(std::chrono::milliseconds(20));
+  ASSERT_GT(so->GetWriteQueueSize(), 1024 * 1024);
+
+  // 超过高水位前已经发起的读取仍然完成，之后暂停读取
+  boost::asio::write(client, boost::asio::buffer(std::string("a")));
+  for (int i = 0; i < 100 && received.empty(); ++i) io.run_one_for(std::chrono::milliseconds(10));
+  ASSERT_EQ(received, "a");
+  boost::asio::write(client, boost::asio::buffer(std::string("b")));
+  io.run_for(std::chrono::milliseconds(50));
+  ASSERT_EQ(received, "a");
+
+  // 对端慢慢读完，回落到低水位后恢复读取
+  std::size_t drained = 0;
+  std::thread reader([&client, &drained, size]() {
+    std::vector<char> data(16 * 1024);
+    boost::system::error_code ec;
+    while (!ec && drained < size) {
+      drained += client.read_some(boost::asio::buffer(data), ec);
+      std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }
+  });
+  for (int i = 0; i < 1000 && (received != "ab" || so->GetWriteQueueSize() > 0); ++i) {
+    io.run_one_for(std::chrono::milliseconds(10));
+  }
+  reader.join();
+  ASSERT_EQ(drained, size);
+  ASSERT_EQ(transitions, std::vector<bool>({true, false}));
+  ASSERT_EQ(received, "ab");
+  ASSERT_EQ(so->GetWriteQueueSize(), 0);
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <gtest/gtest.h>
+
+#include <bamboo/concurrency/taskpool.hpp>
+
+TEST(TaskPool, RunAll) {
+  std::atomic<int> count{0};
+  {
+    bamboo::concurrency::TaskPool pool(4);
+    for (int i = 0; i < 10000; ++i) {
+      pool.Add([&count]() { count.fetch_add(1); });
+    }
+  }
+  // 析构时执行完所有任务
+  ASSERT_EQ(count.load(), 10000);
+}
+
+TEST(TaskPool, AddInTask) {
+  std::atomic<int> count{0};
+  {
+    bamboo::concurrency::TaskPool pool(3);
+    for (int i = 0; i < 10; ++i) {
+      pool.Add([&pool, &count]() {
+        for (int j = 0; j < 100; ++j) {
+          pool.Add([&count]() { count.fetch_add(1); });
+        }
+      });
+    }
+  }
+  ASSERT_EQ(count.load(), 1000);
+}
+
+TEST(TaskPool, Parallel) {
+  bamboo::concurrency::TaskPool pool(2);
+  std::mutex mutex;
+  std::condition_variable cond;
+  int arrived = 0;
+  // 两个任务互相等待，只有同时执行才能完成
+  for (int i = 0; i < 2; ++i) {
+    pool.Add([&]() {
+      std::unique_lock<std::mutex> lock(mutex);
+      arrived += 1;
+      cond.notify_all();
+      cond.wait(lock, [&]() { return arrived == 2; });
+    });
+  }
+  std::unique_lock<std::mutex> lock(mutex);
+  ASSERT_TRUE(cond.wait_for(lock, std::chrono::seconds(5), [&]() { return arrived == 2; }));
+}
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <gtest/gtest.h>
+
+#include <random>
+#include <vector>
+
+#include <bamboo/schedule/timingwheel.hpp>
+
+TEST(TimingWheel, FireInOrder) {
+  bamboo::schedule::TimingWheel wheel;
+  std::vector<int> fired;
+  wheel.Add([&fired]() { fired.push_back(3); }, 3);
+  wheel.Add([&fired]() { fired.push_back(1); }, 1);
+  wheel.Add([&fired]() { fired.push_back(2); }, 2);
+  ASSERT_EQ(wheel.Size(), 3);
+  ASSERT_EQ(wheel.NextTick(), 1);
+
+  ASSERT_EQ(wheel.Advance(2), 2);
+  ASSERT_EQ(wheel.Advance(1), 1);
+  ASSERT_EQ(fired, std::vector<int>({1, 2, 3}));
+  ASSERT_EQ(wheel.Size(), 0);
+  ASSERT_EQ(wheel.NextTick(), 0);
+}
+
+TEST(TimingWheel, Cascade) {
+  bamboo::schedule::TimingWheel wheel;
+  std::mt19937 random(7);
+  std::vector<uint64_t> expires;
+  std::vector<uint64_t> fired;
+  for (int i = 0; i < 1000; ++i) {
+    uint64_t delay = 1 + random() % 200000;
+    expires.push_back(delay);
+    wheel.Add([&fired, &wheel, delay]() {
+      ASSERT_EQ(wheel.Now(), delay);
+      fired.push_back(delay);
+    }, delay);
+  }
+
+  wheel.Advance(200000);
+  ASSERT_EQ(fired.size(), expires.size());
+  ASSERT_EQ(wheel.Size(), 0);
+}
+
+TEST(TimingWheel, Cancel) {
+  bamboo::schedule::TimingWheel wheel;
+  int count = 0;
+  auto a = wheel.Add([&count]() { ++count; }, 10);
+  auto b = wheel.Add([&count]() { ++count; }, 1000);
+  ASSERT_TRUE(wheel.Cancel(a));
+  ASSERT_FALSE(wheel.Cancel(a));
+  ASSERT_TRUE(wheel.Cancel(b));
+  ASSERT_EQ(wheel.Size(), 0);
+
+  // 复用节点后旧的Id不能取消新的定时器
+  auto c = wheel.Add([&count]() { ++count; }, 10);
+  ASSERT_NE(a, c);
+  ASSERT_FALSE(wheel.Cancel(a));
+  wheel.Advance(2000);
+  ASSERT_EQ(count, 1);
+}
+
+TEST(TimingWheel, CycleCancelInHandler) {
+  bamboo::schedule::TimingWheel wheel;
+  int count = 0;
+  bamboo::schedule::TimingWheel::ID id = 0;
+  id = wheel.Add([&]() {
+    if (++count == 3) {
+      ASSERT_TRUE(wheel.Cancel(id));
+    }
+  }, 5, 5);
+
+  ASSERT_EQ(wheel.Advance(100), 3);
+  ASSERT_EQ(count, 3);
+  ASSERT_EQ(wheel.Size(), 0);
+}
+
+TEST(TimingWheel, CancelOtherInHandler) {
+  bamboo::schedule::TimingWheel wheel;
+  int count = 0;
+  bamboo::schedule::TimingWheel::ID a = 0, b = 0;
+  // 同一个槽位上的两个定时器互相取消，只有先执行的一个会触发
+  a = wheel.Add([&]() { ++count; wheel.Cancel(b); }, 5);
+  b = wheel.Add([&]() { ++count; wheel.Cancel(a); }, 5);
+  wheel.Add([&]() { ++count; }, 5);
+
+  ASSERT_EQ(wheel.Advance(5), 2);
+  ASSERT_EQ(count, 2);
+  ASSERT_EQ(wheel.Size(), 0);
+}
+
+TEST(TimingWheel, AddInHandler) {
+  bamboo::schedule::TimingWheel wheel;
+  std::vector<uint64_t> fired;
+  // 回调中插入大量定时器，节点池扩容后回调仍然有效
+  wheel.Add([&]() {
+    for (int i = 0; i < 1000; ++i) {
+      wheel.Add([&]() { fired.push_back(wheel.Now()); }, 300);
+    }
+  }, 1);
+
+  wheel.Advance(301);
+  ASSERT_EQ(fired.size(), 1000);
+  ASSERT_EQ(fired.front(), 301);
+}
+
+TEST(TimingWheel, LongDelay) {
+  bamboo::schedule::TimingWheel wheel;
+  bool fired = false;
+  wheel.Add([&fired]() { fired = true; }, (1ull << 32) + 10);
+  wheel.Advance(1ull << 32);
+  ASSERT_FALSE(fired);
+  wheel.Advance(10);
+  ASSERT_TRUE(fired);
+}
@@ -0,0 +1,188 @@
+#pragma once
+
+#include <gtest/gtest.h>
+
+#include "loopback.hpp"
+
+#include <bamboo/protocol/websocketprotocol.hpp>
+#include <bamboo/net/simpleconnmanager.hpp>
+
+namespace {
+
+using Opcode = bamboo::protocol::WebSocketProtocol::Opcode;
+
+/// 服务端使用 websocket 协议，客户端直接读写原始数据
+struct WsServer {
+  boost::asio::io_context io;
+  std::shared_ptr<bamboo::net::SimpleConnManager> manager = std::make_shared<bamboo::net::SimpleConnManager>();
+  std::shared_ptr<bamboo::protocol::WebSocketProtocol> ws;
+
+  WsServer() {
+    ws = manager->CreateProtocol<bamboo::protocol::WebSocketProtocol>();
+  }
+
+  std::unique_ptr<boost::asio::ip::tcp::socket> Connect(bamboo::net::SocketPtr* server = nullptr) {
+    auto sockets = unittest::Loopback(io);
+    std::unique_ptr<boost::asio::ip::tcp::socket> client(new boost::asio::ip::tcp::socket(std::move(sockets.first)));
+    auto so = manager->OnConnect(std::move(sockets.second));
+    if (server) *server = so;
+    return client;
+  }
+
+  /// 发送升级请求，返回握手回复
+  std::string Upgrade(boost::asio::ip::tcp::socket& client, const std::string& extra = "") {
+    boost::asio::write(client, boost::asio::buffer("GET /chat HTTP/1.1\r\nHost: test\r\nUpgrade: websocket\r\n"
+                                                   "Connection: keep-alive, Upgrade\r\n"
+                                                   "Sec-WebSocket-Key: dGhlIHNhbXBsZSBub25jZQ==\r\n"
+                                                   "Sec-WebSocket-Version: 13\r\n" + extra + "\r\n"));
+    return Read(client, 1, "\r\n\r\n");
+  }
+
+  /// 运行io直到收到至少 size 字节并且包含 until，或者对端关闭
+  std::string Read(boost::asio::ip::tcp::socket& client, std::size_t size, const std::string& until = "") {
+    std::string received;
+    bool done = false;
+    std::function<void()> read;
+    auto buffer = std::make_shared<std::array<char, 4096>>();
+    read = [&]() {
+      client.async_read_some(boost::asio::buffer(*buffer), [&, buffer](const boost::system::error_code& ec, std::size_t n) {
+        received.append(buffer->data(), n);
+        if (ec || (received.size() >= size && received.find(until) != std::string::npos)) {
+          done = true;
+          return;
+        }
+        read();
+      });
+    };
+    // 上一次读到对端关闭时io可能已经没有任务而停止
+    io.restart();
+    read();
+    while (!done) io.run_one();
+    return received;
+  }
+};
+
+/// 生成客户端发送的带掩码的帧
+std::string ClientFrame(uint8_t first, const std::string& payload) {
+  const char key[4] = {'\x12', '\x34', '\x56', '\x78'};
+  std::string frame(1, static_cast<char>(first));
+  if (payload.size() < 126) {
+    frame.push_back(static_cast<char>(0x80 | payload.size()));
+  } else {
+    frame.push_back(static_cast<char>(0x80 | 126));
+    frame.push_back(static_cast<char>(payload.size() >> 8));
+    frame.push_back(static_cast<char>(payload.size() & 0xff));
+  }
+  frame.append(key, 4);
+  std::string masked(payload.size(), '\0');
+  bamboo::protocol::WebSocketProtocol::Unmask(&masked[0], payload.data(), payload.size(), key);
+  return frame + masked;
+}
+
+}
+
+TEST(WebSocket, Unmask) {
+  ASSERT_EQ(bamboo::protocol::WebSocketProtocol::AcceptKey("dGhlIHNhbXBsZSBub25jZQ=="), "s3pPLMBiTxaQ9kYGzzhZRbK+xOo=");
+
+  const char key[4] = {'\x01', '\x7f', '\x80', '\xff'};
+  std::string source;
+  for (int i = 0; i < 300; ++i) source.push_back(static_cast<char>(i * 31));
+  for (std::size_t size : {0, 1, 3, 7, 8, 15, 16, 17, 63, 64, 65, 130, 300}) {
+    for (std::size_t offset = 0; offset < 4; ++offset) {
+      std::string out(size, '\0');
+      bamboo::protocol::WebSocketProtocol::Unmask(&out[0], source.data(), size, key, offset);
+      for (std::size_t i = 0; i < size; ++i) {
+        ASSERT_EQ(out[i], static_cast<char>(source[i] ^ key[(offset + i) % 4])) << size << ":" << offset << ":" << i;
+      }
+      // 原地处理两次还原
+      bamboo::protocol::WebSocketProtocol::Unmask(&out[0], out.data(), size, key, offset);
+      ASSERT_EQ(out, source.substr(0, size));
+    }
+  }
+}
+
+TEST(WebSocket, Message) {
+  WsServer server;
+  uint16_t closed = 0;
+  server.ws->SetMessageHandler([&server](bamboo::net::SocketPtr so, Opcode opcode, const char* data, std::size_t size) {
+    server.ws->Send(so, opcode, data, size);
+  });
+  server.ws->SetCloseHandler([&closed](bamboo::net::SocketPtr, uint16_t code) { closed = code; });
+
+  bamboo::net::SocketPtr so;
+  auto client = server.Connect(&so);
+  std::string handshake = server.Upgrade(*client);
+  ASSERT_EQ(handshake, "HTTP/1.1 101 Switching Protocols\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n"
+                       "Sec-WebSocket-Accept: s3pPLMBiTxaQ9kYGzzhZRbK+xOo=\r\n\r\n");
+  ASSERT_TRUE(server.ws->IsOpen(so));
+
+  // 分片的消息中间插入 ping，最后一帧分两次到达
+  std::string frames = ClientFrame(0x01, "hel") + ClientFrame(0x89, "p") + ClientFrame(0x80, "lo");
+  boost::asio::write(*client, boost::asio::buffer(frames.substr(0, frames.size() - 3)));
+  ASSERT_EQ(server.Read(*client, 3), std::string("\x8a\x01p", 3));
+  boost::asio::write(*client, boost::asio::buffer(frames.substr(frames.size() - 3)));
+  ASSERT_EQ(server.Read(*client, 7), std::string("\x81\x05hello", 7));
+
+  // 非法的 utf-8
+  boost::asio::write(*client, boost::asio::buffer(ClientFrame(0x81, "\xc0\xaf") + ClientFrame(0x81, "x")));
+  ASSERT_EQ(server.Read(*client, 100), std::string("\x88\x02\x03\xef", 4));
+  ASSERT_EQ(closed, 1007);
+  ASSERT_FALSE(server.ws->IsOpen(so));
+  ASSERT_EQ(server.ws->GetOpenSize(), 0);
+
+  // 客户端关闭
+  closed = 0;
+  client = server.Connect(&so);
+  server.Upgrade(*client);
+  boost::asio::write(*client, boost::asio::buffer(ClientFrame(0x88, std::string("\x03\xe8", 2))));
+  ASSERT_EQ(server.Read(*client, 100), std::string("\x88\x02\x03\xe8", 4));
+  ASSERT_EQ(closed, 1000);
+
+  // 版本不对时拒绝握手
+  client = server.Connect();
+  boost::asio::write(*client, boost::asio::buffer(std::string("GET / HTTP/1.1\r\nHost: test\r\nUpgrade: websocket\r\n"
+                                                              "Connection: Upgrade\r\nSec-WebSocket-Key: dGhlIHNhbXBsZSBub25jZQ==\r\n"
+                                                              "Sec-WebSocket-Version: 8\r\n\r\n")));
+  ASSERT_EQ(server.Read(*client, 1000).substr(0, 28), "HTTP/1.1 426 Upgrade Require");
+}
+
+TEST(WebSocket, DeflateBroadcast) {
+  WsServer server;
+  std::string received;
+  server.ws->SetMessageHandler([&received](bamboo::net::SocketPtr, Opcode, const char* data, std::size_t size) {
+    received.assign(data, size);
+  });
+
+  auto plain = server.Connect();
+  server.Upgrade(*plain);
+  auto deflate = server.Connect();
+  std::string handshake = server.Upgrade(*deflate, "Sec-WebSocket-Extensions: x-unknown, permessage-deflate; "
+                                                   "client_max_window_bits\r\n");
+  ASSERT_NE(handshake.find("Sec-WebSocket-Extensions: permessage-deflate; server_no_context_takeover\r\n"),
+            std::string::npos);
+  ASSERT_EQ(server.ws->GetOpenSize(), 2);
+
+  std::string text;
+  for (int i = 0; i < 100; ++i) text.append("bamboo websocket ");
+
+  // 客户端发送压缩的消息，压缩后的内容去掉服务端帧头再加上掩码
+  bamboo::protocol::WebSocketProtocol encoder;
+  auto compressed = encoder.Encode(Opcode::TEXT, text.data(), text.size(), true);
+  ASSERT_EQ(static_cast<uint8_t>((*compressed)[0]), 0xc1);
+  ASSERT_LT(compressed->size(), text.size() / 4);
+  std::size_t header = static_cast<uint8_t>((*compressed)[1]) < 126 ? 2 : 4;
+  boost::asio::write(*deflate, boost::asio::buffer(ClientFrame(0xc1, compressed->substr(header))));
+  while (received.empty()) server.io.run_one();
+  ASSERT_EQ(received, text);
+
+  // 广播时两种链接各自收到对应的帧
+  ASSERT_EQ(server.ws->Broadcast(*server.manager, Opcode::TEXT, text.data(), text.size()), 2);
+  ASSERT_EQ(server.Read(*deflate, compressed->size()), *compressed);
+  auto uncompressed = encoder.Encode(Opcode::TEXT, text.data(), text.size(), false);
+  ASSERT_EQ(server.Read(*plain, uncompressed->size()), *uncompressed);
+
+  // 过滤掉所有链接
+  std::size_t count = server.ws->Broadcast(*server.manager, Opcode::BINARY, "x", 1,
+                                           [](const bamboo::net::SocketPtr&) { return false; });
+  ASSERT_EQ(count, 0);
+}